@@ -0,0 +1,131 @@
+/* bench_builder.cpp
+ *
+ * CPU cost of building a command with the builder (cmd_buf.cpp) and with the
+ * memset + snprintf it replaced, in cycles (x86 TSC) of the host: the ratio is what
+ * matter, the cycles on an 8 bit MCU are a lot more for both.
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+#include "nxt_access.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CLOCK()   __rdtsc()
+#define BENCH_UNIT      "cycles"
+#else
+#include <chrono>
+#define BENCH_CLOCK()   (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>( \
+                            std::chrono::steady_clock::now().time_since_epoch()).count()
+#define BENCH_UNIT      "ns"
+#endif
+
+#define BENCH_LOOPS     1000000UL
+#define BENCH_RUNS      7
+
+typedef NxtHostAccess A;
+
+static NxtEmu emu;
+static NxtLcd lcd(&emu);
+static char   oldBuf[NXT_BUF_SIZE];
+static volatile uint8_t sink;
+
+
+// b[3].val=<v>, as setNumeric(3,v)
+static void numBuilder(uint32_t i){
+    A::cmdStart(lcd);
+    A::cmdObj(lcd,3);
+    A::cmdStr(lcd,".val=");
+    A::cmdInt(lcd,(int32_t)(i * 37) - 20000);
+    A::cmdEnd(lcd);
+    sink = A::sendBuf(lcd)[A::sendLen(lcd) - 4];
+}
+
+static void numSnprintf(uint32_t i){
+    memset(oldBuf,0,sizeof(oldBuf));
+    snprintf(oldBuf,sizeof(oldBuf),"b[%d].val=%ld%c%c%c",3,(long)((int32_t)(i * 37) - 20000),
+             0xFF,0xFF,0xFF);
+    sink = oldBuf[5];
+}
+
+// add 1,0,<v>, as addWavePoint()
+static void waveBuilder(uint32_t i){
+    A::cmdStart(lcd);
+    A::cmdStr(lcd,"add ");
+    A::cmdUint(lcd,1);
+    A::cmdChar(lcd,',');
+    A::cmdUint(lcd,0);
+    A::cmdChar(lcd,',');
+    A::cmdUint(lcd,i & 0xFF);
+    A::cmdEnd(lcd);
+    sink = A::sendBuf(lcd)[A::sendLen(lcd) - 4];
+}
+
+static void waveSnprintf(uint32_t i){
+    memset(oldBuf,0,sizeof(oldBuf));
+    snprintf(oldBuf,sizeof(oldBuf),"add %d,%d,%d%c%c%c",1,0,(int)(i & 0xFF),0xFF,0xFF,0xFF);
+    sink = oldBuf[5];
+}
+
+// line x,y,x1,y1,color, as drawLine()
+static void lineBuilder(uint32_t i){
+    A::cmdStart(lcd);
+    A::cmdStr(lcd,"line ");
+    A::cmdUint(lcd,i % 480);
+    A::cmdChar(lcd,',');
+    A::cmdUint(lcd,i % 272);
+    A::cmdChar(lcd,',');
+    A::cmdUint(lcd,479 - i % 480);
+    A::cmdChar(lcd,',');
+    A::cmdUint(lcd,271 - i % 272);
+    A::cmdChar(lcd,',');
+    A::cmdUint(lcd,i & 0xFFFF);
+    A::cmdEnd(lcd);
+    sink = A::sendBuf(lcd)[A::sendLen(lcd) - 4];
+}
+
+static void lineSnprintf(uint32_t i){
+    memset(oldBuf,0,sizeof(oldBuf));
+    snprintf(oldBuf,sizeof(oldBuf),"line %u,%u,%u,%u,%u%c%c%c",(unsigned)(i % 480),
+             (unsigned)(i % 272),(unsigned)(479 - i % 480),(unsigned)(271 - i % 272),
+             (unsigned)(i & 0xFFFF),0xFF,0xFF,0xFF);
+    sink = oldBuf[5];
+}
+
+
+/*
+ * perCmd() - best of BENCH_RUNS runs, per command
+ */
+static double perCmd(void (*fn)(uint32_t)){
+    uint64_t best = ~0ULL;
+    for(int r = 0; r < BENCH_RUNS; r++){
+        uint64_t start = BENCH_CLOCK();
+        for(uint32_t i = 0; i < BENCH_LOOPS; i++) fn(i);
+        uint64_t t = BENCH_CLOCK() - start;
+        if(t < best) best = t;
+    }
+    return (double)best / BENCH_LOOPS;
+}
+
+
+int main(void){
+    struct{
+        const char* name;
+        void        (*builder)(uint32_t);
+        void        (*old)(uint32_t);
+    }cases[] = {
+        {"setNumeric",   numBuilder,  numSnprintf},
+        {"addWavePoint", waveBuilder, waveSnprintf},
+        {"drawLine",     lineBuilder, lineSnprintf},
+    };
+    printf("command build cost, %s per command (best of %d x %lu)\n",BENCH_UNIT,BENCH_RUNS,BENCH_LOOPS);
+    printf("command        builder  snprintf  speedup\n");
+    for(size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++){
+        double b = perCmd(cases[i].builder);
+        double o = perCmd(cases[i].old);
+        printf("%-13s %8.1f %9.1f %7.1fx\n",cases[i].name,b,o,o / b);
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+/* bench_coro.cpp
+ *
+ * How many UI flows one core can drive with the coroutine front-end (nxt_coro.h)
+ * compared with the blocking API. Each flow read a value from the display and write
+ * back a result every BENCH_PERIOD ms; between library calls the sketch does some other
+ * work (BENCH_WORK us per loop() turn). For a growing number of flows we measure the
+ * updates/s each flow gets and the share of time left to the other work.
+ * Time is the virtual clock of the host build: serial link and emulated display.
+ * Built with -std=gnu++20, see CMakeLists.txt.
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#define NXT_CO_MAX      64
+#include <Arduino.h>
+#include "nxt_lcd.h"
+#include "nxt_coro.h"
+
+#define BENCH_RATE      115200
+#define BENCH_PERIOD    100         // ms, each flow update at 10 Hz
+#define BENCH_WORK      50          // us of other work for each loop() turn
+#define BENCH_TIME      5000        // ms of each run
+#define BENCH_SLOTS     4           // async request slots
+
+static uint32_t updates;
+static uint32_t work;
+
+
+static NxtCoTask flow(NxtCoSched& sched, uint8_t id, uint32_t end){
+    NxtLcd* lcd = sched.display();
+    int32_t v;
+    uint32_t next = millis();
+    while((int32_t)(millis() - end) < 0){
+        if(co_await nxtGetNumeric(sched,0,id,&v) == replyCmdOk){
+            lcd->setNumeric(0,id + 100,v + 1);
+            updates++;
+        }
+        next += BENCH_PERIOD;
+        int32_t left = next - millis();
+        if(left > 0) co_await nxtDelay(sched,left);
+    }
+}
+
+
+/*
+ * runCoro() / runBlock() - run "flows" flows for BENCH_TIME ms, return the updates/s of
+ * each flow and in "free" the share of time given to the other work
+ */
+static double runCoro(uint8_t flows, double* free){
+    hostReset();
+    NxtEmu emu(BENCH_RATE);
+    NxtLcd lcd(&emu);
+    lcd.init(BENCH_RATE,1,0,0);
+    nxtReq_t slots[BENCH_SLOTS];
+    lcd.setReqSlots(slots,BENCH_SLOTS);
+    NxtCoSched sched(&lcd);
+    updates = 0;
+    work = 0;
+    uint64_t start = hostNow();
+    uint32_t end = millis() + BENCH_TIME;
+    for(uint8_t i = 0; i < flows; i++) flow(sched,i + 1,end);
+    while(sched.pending() > 0){
+        sched.run();
+        hostAdvance(BENCH_WORK * 1000UL);
+        work++;
+    }
+    uint64_t ns = hostNow() - start;
+    (*free) = (double)work * BENCH_WORK * 1000 / ns;
+    return updates * 1e9 / ns / flows;
+}
+
+static double runBlock(uint8_t flows, double* free){
+    hostReset();
+    NxtEmu emu(BENCH_RATE);
+    NxtLcd lcd(&emu);
+    lcd.init(BENCH_RATE,1,0,0);
+    uint32_t next[256];
+    updates = 0;
+    work = 0;
+    uint64_t start = hostNow();
+    uint32_t end = millis() + BENCH_TIME;
+    for(uint8_t i = 0; i < flows; i++) next[i] = millis();
+    while((int32_t)(millis() - end) < 0){
+        for(uint8_t i = 0; i < flows; i++){
+            if((int32_t)(millis() - next[i]) < 0) continue;
+            int32_t v;
+            if(lcd.getNumeric(0,i + 1,&v,sizeof(v)) == replyCmdOk){
+                lcd.setNumeric(0,i + 101,v + 1);
+                updates++;
+            }
+            next[i] += BENCH_PERIOD;
+        }
+        hostAdvance(BENCH_WORK * 1000UL);
+        work++;
+    }
+    uint64_t ns = hostNow() - start;
+    (*free) = (double)work * BENCH_WORK * 1000 / ns;
+    return updates * 1e9 / ns / flows;
+}
+
+
+int main(void){
+    const uint8_t flows[] = {1, 4, 8, 16, 24, 32, 48, 64};
+    printf("UI flows at %d Hz, %d baud, %d us of other work per loop() turn\n",
+           1000 / BENCH_PERIOD,BENCH_RATE,BENCH_WORK);
+    printf("         blocking API        coroutines\n");
+    printf("flows  upd/s/flow  free    upd/s/flow  free\n");
+    for(size_t i = 0; i < sizeof(flows) / sizeof(flows[0]); i++){
+        double fb, fc;
+        double b = runBlock(flows[i],&fb);
+        double c = runCoro(flows[i],&fc);
+        printf("%5d %11.1f %4.0f%% %13.1f %4.0f%%\n",flows[i],b,fb * 100,c,fc * 100);
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+/* bench_dec.cpp
+ *
+ * CPU cost of the wave decimator (wave_dec.cpp), in cycles (x86 TSC) of the host for
+ * each sample, against a plain loop with branches and a division per sample. The
+ * display is not initialized, so the points are dropped by flush(): only the reduction
+ * is measured.
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CLOCK()   __rdtsc()
+#define BENCH_UNIT      "cycles"
+#else
+#include <chrono>
+#define BENCH_CLOCK()   (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>( \
+                            std::chrono::steady_clock::now().time_since_epoch()).count()
+#define BENCH_UNIT      "ns"
+#endif
+
+#define BENCH_BLOCK     1024
+#define BENCH_LOOPS     2000
+#define BENCH_RUNS      7
+#define BENCH_RATIO     64
+
+static NxtEmu emu;
+static NxtLcd lcd(&emu);
+static int16_t iSamples[BENCH_BLOCK];
+static float   fSamples[BENCH_BLOCK];
+static uint8_t points[4096];
+static volatile uint32_t sink;
+
+
+/*
+ * plainI16() - the reduction written the obvious way, min/max and average of each group
+ */
+static void plainI16(const int16_t* s, uint16_t n){
+    static uint32_t cnt, mn = 0xFFFFFFFFUL, mx, sum;
+    for(uint16_t i = 0; i < n; i++){
+        int32_t v = s[i];
+        if(v < 0) v = 0;
+        if(v > 4095) v = 4095;
+        uint32_t p = (uint32_t)v * 200 * 256 / 4095;
+        if(p < mn) mn = p;
+        if(p > mx) mx = p;
+        sum += p;
+        if(++cnt == BENCH_RATIO){
+            sink = mn + mx + sum / BENCH_RATIO;
+            cnt = 0;
+            mn = 0xFFFFFFFFUL;
+            mx = 0;
+            sum = 0;
+        }
+    }
+}
+
+
+/*
+ * best() - best of BENCH_RUNS runs of "fn", per sample
+ */
+template<typename F> static double best(F fn){
+    double res = 1e30;
+    for(int r = 0; r < BENCH_RUNS; r++){
+        uint64_t start = BENCH_CLOCK();
+        for(int l = 0; l < BENCH_LOOPS; l++) fn();
+        double t = (double)(BENCH_CLOCK() - start) / ((double)BENCH_LOOPS * BENCH_BLOCK);
+        if(t < res) res = t;
+    }
+    return res;
+}
+
+
+int main(void){
+    for(int i = 0; i < BENCH_BLOCK; i++){
+        iSamples[i] = (int16_t)(2048 + 1800 * sin(i * 0.05) + (i * 7919) % 200 - 100);
+        fSamples[i] = iSamples[i] / 4095.0f;
+    }
+    NxtWaveDec dec(lcd,1,0,points,sizeof(points));
+    printf("wave decimator cost, %s per sample, groups of %d (best of %d x %d samples)\n",
+           BENCH_UNIT,BENCH_RATIO,BENCH_RUNS,BENCH_LOOPS * BENCH_BLOCK);
+    printf("input   mode      NxtWaveDec   plain loop\n");
+    const char* modes[2] = {"average","min/max"};
+    double plain = best([](){plainI16(iSamples,BENCH_BLOCK);});
+    for(uint8_t m = NXT_DEC_AVG; m <= NXT_DEC_MINMAX; m++){
+        dec.setScale(0,4095,201);
+        dec.setDecimation(BENCH_RATIO,m);
+        printf("int16   %s %12.2f %12.2f\n",modes[m],best([&](){dec.add(iSamples,BENCH_BLOCK);}),plain);
+        dec.setScale(0,1,201);
+        dec.setDecimation(BENCH_RATIO,m);
+        printf("float   %s %12.2f\n",modes[m],best([&](){dec.add(fSamples,BENCH_BLOCK);}));
+    }
+    sink = dec.getSamples();
+    return 0;
+}
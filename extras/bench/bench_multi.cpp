@@ -0,0 +1,64 @@
+/* bench_multi.cpp
+ *
+ * Aggregate command throughput of NxtMulti with 1 to NXT_MULTI_MAX displays, each one on
+ * its own port, in pipeline mode. Time is the virtual clock of the host build (see
+ * extras/host/Arduino.h), so the numbers are those of the serial links and of the display
+ * emulator, not of the PC.
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+#define BENCH_RATE      115200
+#define BENCH_CMDS      2000        // commands sent to each display
+
+
+/*
+ * run() - send BENCH_CMDS commands to each of "ports" displays, round robin, and return
+ * the virtual time (ns) until the last reply
+ */
+static uint64_t run(uint8_t ports, uint8_t* errors){
+    hostReset();
+    NxtEmu* emu[NXT_MULTI_MAX];
+    NxtLcd* lcd[NXT_MULTI_MAX];
+    NxtMulti lcds;
+    for(uint8_t i = 0; i < ports; i++){
+        emu[i] = new NxtEmu(BENCH_RATE);
+        lcd[i] = new NxtLcd(emu[i]);
+        lcd[i]->init(BENCH_RATE,1,0,0);
+        lcds.add(lcd[i]);
+    }
+    lcds.setPipeline(1);
+    uint64_t start = hostNow();
+    for(uint16_t n = 0; n < BENCH_CMDS; n++){
+        for(uint8_t i = 0; i < ports; i++) lcds[i]->setObjAttr(0,3,"val",n);
+        lcds.poll();
+    }
+    (*errors) = (lcds.flush() != replyCmdOk);
+    uint64_t ns = hostNow() - start;
+    for(uint8_t i = 0; i < ports; i++){
+        if(emu[i]->num("0.3.val") != BENCH_CMDS - 1) (*errors) = 1;
+        delete lcd[i];
+        delete emu[i];
+    }
+    return ns;
+}
+
+
+int main(void){
+    printf("NxtMulti, %d commands per display at %d baud, pipeline mode\n",BENCH_CMDS,BENCH_RATE);
+    printf("ports   cmd/s    per port   scaling\n");
+    double one = 0;
+    for(uint8_t ports = 1; ports <= NXT_MULTI_MAX; ports++){
+        uint8_t errors;
+        uint64_t ns = run(ports,&errors);
+        double rate = (double)ports * BENCH_CMDS * 1e9 / ns;
+        if(ports == 1) one = rate;
+        printf("%5d %8.0f %10.0f %8.2fx%s\n",ports,rate,rate / ports,rate / one,
+               errors ? "  (errors)" : "");
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+/* bench_resolver.cpp
+ *
+ * Bytes on the wire and line time per command at 9600 baud, with the name resolver
+ * (resolver.cpp) off and on, for setNumeric() with a few component names. Time is the
+ * virtual clock of the host build (see extras/host/Arduino.h), so the numbers are those
+ * of the serial link and of the display emulator, not of the PC. Names are learned
+ * before the measure, so the lookups ("get <name>.id") are not counted.
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+#define BENCH_RATE      9600
+#define BENCH_CMDS      200         // commands sent for each case
+
+
+struct benchCase_t{
+    const char* page;               // NULL for <object_name> on current page
+    const char* obj;
+    uint8_t     pageId;
+    uint8_t     objId;
+};
+
+static const benchCase_t cases[] = {
+    {NULL,       "temperatureBox", 0, 5},
+    {NULL,       "n0",             0, 1},
+    {"mainPage", "humidityBox",    0, 6},
+    {"setup",    "speedSlider",    2, 12},
+};
+
+
+/*
+ * run() - send BENCH_CMDS setNumeric() for case "c", return the bytes received by the
+ * display and the virtual time (ns) until the last one is executed
+ */
+static void run(const benchCase_t* c, uint8_t resolver, uint32_t* bytes, uint64_t* ns,
+                uint8_t* errors){
+    hostReset();
+    NxtEmu emu(BENCH_RATE);
+    NxtLcd lcd(&emu);
+    nxtName_t names[8];
+    nxtNameLearn_t learn;
+    emu.addPage(0,"mainPage");
+    emu.addPage(2,"setup");
+    emu.addObj(c->pageId,c->objId,c->obj);
+    lcd.init(BENCH_RATE,1,0,0);
+    if(resolver){
+        lcd.setResolver(names,8,&learn);
+        lcd.addPageId("mainPage",0);
+        lcd.addPageId("setup",2);
+    }
+    if(c->page != NULL) lcd.setNumeric(c->page,c->obj,0);
+    else lcd.setNumeric(c->obj,0);
+    lcd.poll();
+    emu.settle();
+    uint32_t in = emu.bytesIn;
+    uint64_t start = hostNow();
+    for(uint16_t n = 1; n <= BENCH_CMDS; n++){
+        if(c->page != NULL) lcd.setNumeric(c->page,c->obj,n);
+        else lcd.setNumeric(c->obj,n);
+    }
+    emu.settle();
+    (*ns) = hostNow() - start;
+    (*bytes) = emu.bytesIn - in;
+    std::string key = std::to_string(c->pageId) + "." + std::to_string(c->objId) + ".val";
+    (*errors) = (emu.num(key) != BENCH_CMDS);
+}
+
+
+int main(void){
+    printf("setNumeric(), %d commands at %d baud, resolver off / on\n",BENCH_CMDS,BENCH_RATE);
+    printf("address                 bytes/cmd        ms/cmd        saved\n");
+    printf("                        off    on       off    on\n");
+    for(size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++){
+        uint32_t bytes[2];
+        uint64_t ns[2];
+        uint8_t errors[2];
+        for(uint8_t r = 0; r < 2; r++) run(&cases[i],r,&bytes[r],&ns[r],&errors[r]);
+        double b0 = (double)bytes[0] / BENCH_CMDS;
+        double b1 = (double)bytes[1] / BENCH_CMDS;
+        double m0 = ns[0] / 1e6 / BENCH_CMDS;
+        double m1 = ns[1] / 1e6 / BENCH_CMDS;
+        std::string addr = (cases[i].page != NULL) ? std::string(cases[i].page) + "." : "";
+        addr += cases[i].obj;
+        printf("%-22s %5.1f %5.1f %9.2f %5.2f %8.0f%%%s\n",addr.c_str(),b0,b1,m0,m1,
+               100.0 * (m0 - m1) / m0,(errors[0] || errors[1]) ? "  (errors)" : "");
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+/* bench_wave.cpp
+ *
+ * Wave samples per second on one channel, with addWavePoint() (one "add" command for
+ * each sample, plain and in pipeline mode) and addWaveBytes() (transparent data), at a
+ * few baudrates. Time is the virtual clock of the host build (see extras/host/Arduino.h):
+ * serial link and display emulator, not the PC.
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+#define BENCH_SAMPLES   20000
+#define BENCH_BLOCK     1000        // samples for each addWaveBytes() call
+#define BENCH_WAVE      1
+
+enum{benchPoint, benchPipe, benchBytes};
+
+
+/*
+ * run() - send BENCH_SAMPLES samples with "mode", return samples/s, or 0 on failure
+ * (commands lost, es. in the display buffer overflow)
+ */
+static double run(uint32_t rate, uint8_t mode){
+    hostReset();
+    NxtEmu emu(rate);
+    NxtLcd lcd(&emu);
+    lcd.init(rate,1,0,0);
+    if(mode == benchPipe) lcd.setPipeline(1);
+    static uint8_t block[BENCH_BLOCK];
+    uint64_t start = hostNow();
+    uint8_t res = replyCmdOk;
+    for(uint32_t n = 0; n < BENCH_SAMPLES && res == replyCmdOk; n += BENCH_BLOCK){
+        for(uint16_t i = 0; i < BENCH_BLOCK; i++) block[i] = (n + i) & 0xFF;
+        if(mode == benchBytes) res = lcd.addWaveBytes(BENCH_WAVE,0,block,BENCH_BLOCK);
+        else{
+            for(uint16_t i = 0; i < BENCH_BLOCK && res == replyCmdOk; i++){
+                res = lcd.addWavePoint(BENCH_WAVE,0,block[i]);
+            }
+        }
+    }
+    if(mode == benchPipe && res == replyCmdOk) res = lcd.pipeFlush();
+    emu.settle();
+    uint64_t ns = emu.idle() ? hostNow() - start : 0;
+    if(res != replyCmdOk || ns == 0) return 0;
+    if(emu.waves[BENCH_WAVE * 4].size() != BENCH_SAMPLES || emu.lost > 0) return 0;
+    return (double)BENCH_SAMPLES * 1e9 / ns;
+}
+
+
+static void print(double rate, int width){
+    if(rate > 0) printf(" %*.0f",width,rate);
+    else printf(" %*s",width,"fail");
+}
+
+
+int main(void){
+    const uint32_t rates[] = {38400, 115200, 921600};
+    printf("wave samples/s on one channel, %d samples\n",BENCH_SAMPLES);
+    printf("   baud  addWavePoint  pipeline  addWaveBytes  wire limit\n");
+    for(size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++){
+        printf("%7lu",(unsigned long)rates[i]);
+        print(run(rates[i],benchPoint),13);
+        print(run(rates[i],benchPipe),9);
+        print(run(rates[i],benchBytes),13);
+        print(rates[i] / 10.0,11);
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+/* Arduino.h
+ *
+ * Minimal Arduino core for building the library on a PC (see CMakeLists.txt in the
+ * library root). Only what the library uses is provided.
+ *
+ * Time is virtual: the clock (in ns) only moves when the library look at it, each call
+ * of millis(), micros() or yield() advance it by hostTick ns, delay() by the time asked.
+ * So a wait loop that would last 500 ms on a board run in a few ms on the PC, and the
+ * display emulator (nxt_emu.h) see exactly the same timing on every run.
+ *
+ * With NXT_HOST_EMU defined the emulator is declared here, so it can be used as
+ * NXT_SERIAL_TYPE (-DNXT_SERIAL_TYPE=NxtEmu).
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#ifndef __NXT_HOST_ARDUINO_H__
+#define __NXT_HOST_ARDUINO_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+// virtual clock, see host.cpp
+extern uint64_t hostNs;
+extern uint32_t hostTick;
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+
+uint64_t hostNow(void);                 // ns, without advancing the clock
+void     hostAdvance(uint64_t ns);
+void     hostReset(void);
+
+class __FlashStringHelper;
+#define F(s)                (reinterpret_cast<const __FlashStringHelper*>(s))
+
+#define PROGMEM
+#define PSTR(s)             (s)
+#define snprintf_P          snprintf
+#define strncmp_P           strncmp
+#define strlen_P            strlen
+#define strncpy_P           strncpy
+#define memcpy_P            memcpy
+#define pgm_read_byte(p)    (*(const uint8_t*)(p))
+#define pgm_read_word(p)    (*(const uint16_t*)(p))
+
+
+class Print{
+public:
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t* b, size_t s){
+        size_t n = 0;
+        while(s--) n += write(*b++);
+        return n;
+    };
+    virtual int    availableForWrite(void){return 0;};
+    virtual ~Print(){};
+};
+
+class Stream : public Print{
+public:
+    virtual int    available(void) = 0;
+    virtual int    read(void) = 0;
+    virtual int    peek(void) = 0;
+};
+
+#ifdef NXT_HOST_EMU
+#include "nxt_emu.h"
+#endif
+
+#endif // __NXT_HOST_ARDUINO_H__
@@ -0,0 +1,28 @@
+/* HardwareSerial.h
+ *
+ * Host stand-in for the core UART class, only used to build the library as it is
+ * built for a board (see the size targets in CMakeLists.txt): bytes written are
+ * discarded, nothing is ever received.
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#ifndef __NXT_HOST_HWSERIAL_H__
+#define __NXT_HOST_HWSERIAL_H__
+
+#include <Arduino.h>
+
+class HardwareSerial : public Stream{
+public:
+    void   begin(unsigned long baud){(void)baud;};
+    void   end(void){};
+    int    available(void){return 0;};
+    int    read(void){return -1;};
+    int    peek(void){return -1;};
+    size_t write(uint8_t b){(void)b;return 1;};
+    size_t write(const uint8_t* b, size_t s){(void)b;return s;};
+    int    availableForWrite(void){return 64;};
+};
+
+#endif // __NXT_HOST_HWSERIAL_H__
@@ -0,0 +1,26 @@
+/* SoftwareSerial.h
+ *
+ * Host stand-in for the SoftwareSerial library, see HardwareSerial.h
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#ifndef __NXT_HOST_SWSERIAL_H__
+#define __NXT_HOST_SWSERIAL_H__
+
+#include <Arduino.h>
+
+class SoftwareSerial : public Stream{
+public:
+    SoftwareSerial(uint8_t rx, uint8_t tx){(void)rx;(void)tx;};
+    void   begin(long baud){(void)baud;};
+    void   end(void){};
+    int    available(void){return 0;};
+    int    read(void){return -1;};
+    int    peek(void){return -1;};
+    size_t write(uint8_t b){(void)b;return 1;};
+    size_t write(const uint8_t* b, size_t s){(void)b;return s;};
+};
+
+#endif // __NXT_HOST_SWSERIAL_H__
@@ -0,0 +1,47 @@
+/* host.cpp
+ *
+ * Virtual clock of the host build, see Arduino.h
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include <Arduino.h>
+
+uint64_t hostNs = 0;
+uint32_t hostTick = 1000;       // 1 us for each look at the clock
+
+
+unsigned long millis(void){
+    hostNs += hostTick;
+    return (unsigned long)(hostNs / 1000000ULL);
+}
+
+unsigned long micros(void){
+    hostNs += hostTick;
+    return (unsigned long)(hostNs / 1000ULL);
+}
+
+void delay(unsigned long ms){
+    hostNs += (uint64_t)ms * 1000000ULL;
+}
+
+void delayMicroseconds(unsigned int us){
+    hostNs += (uint64_t)us * 1000ULL;
+}
+
+void yield(void){
+    hostNs += hostTick;
+}
+
+uint64_t hostNow(void){
+    return hostNs;
+}
+
+void hostAdvance(uint64_t ns){
+    hostNs += ns;
+}
+
+void hostReset(void){
+    hostNs = 0;
+}
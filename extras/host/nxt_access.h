@@ -0,0 +1,41 @@
+/* nxt_access.h
+ *
+ * NxtHostAccess - access to the NxtLcd internals for the host tests and benchmarks,
+ * that check pieces (es. the command builder) without going through the display.
+ * Only in the host build (NXT_HOST_EMU).
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#ifndef __NXT_ACCESS_H__
+#define __NXT_ACCESS_H__
+
+#include <string>
+#include "nxt_lcd.h"
+
+class NxtHostAccess{
+public:
+    /*
+     * command builder, see cmd_buf.cpp
+     */
+    static void     cmdStart(NxtLcd& lcd){lcd.cmdStart();};
+    static void     cmdStr(NxtLcd& lcd, const char* s){lcd.cmdStr(s);};
+    static void     cmdChar(NxtLcd& lcd, char c){lcd.cmdChar(c);};
+    static void     cmdUint(NxtLcd& lcd, uint32_t v){lcd.cmdUint(v);};
+    static void     cmdInt(NxtLcd& lcd, int32_t v){lcd.cmdInt(v);};
+    static void     cmdObj(NxtLcd& lcd, uint8_t obj){lcd.cmdObj(obj);};
+    static void     cmdObj(NxtLcd& lcd, uint8_t page, uint8_t obj){lcd.cmdObj(page,obj);};
+    static void     cmdEnd(NxtLcd& lcd){lcd.cmdEnd();};
+    static uint8_t  cmdOvfl(NxtLcd& lcd){return lcd.cmdOvfl;};
+    static uint16_t sendLen(NxtLcd& lcd){return lcd.sendLen;};
+    static uint8_t* sendBuf(NxtLcd& lcd){return lcd.sendBuf;};
+    // the command built so far, without the terminator
+    static std::string cmd(NxtLcd& lcd){
+        uint16_t len = lcd.sendLen;
+        while(len > 0 && lcd.sendBuf[len - 1] == 0xFF) len--;
+        return std::string((const char*)lcd.sendBuf,len);
+    };
+};
+
+#endif // __NXT_ACCESS_H__
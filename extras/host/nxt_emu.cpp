@@ -0,0 +1,627 @@
+/* nxt_emu.cpp
+ *
+ * NxtEmu - a Nextion display emulator for the host build
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * The emulator model the link and the panel with the timing of the real hardware,
+ * on the virtual clock of the host build (see Arduino.h):
+ * - each byte take 10 bit times on the wire, in both directions; write() return when
+ *   the bytes are in the host UART FIFO (txFifo bytes), blocking (moving the clock) as
+ *   long as it's full. Bytes sent at a rate different from the panel one are lost;
+ * - the panel serial buffer hold bufSize bytes: a byte arriving when it's full is lost,
+ *   and 0x24 is sent (once, until a command is executed);
+ * - commands are executed one at a time, in order, each taking cmdNs (drawNs for the
+ *   drawing commands, or the time given with setCost()); the bytes of a command leave
+ *   the buffer when it's done;
+ * - replies follow bkcmd (0: none, 1: only success, 2: only failures, 3: always);
+ * - "rest" (or restart()) send 00 00 00 FF FF FF at once and 0x88 after bootNs, the
+ *   bytes received meanwhile are lost, and the panel start again at "bauds";
+ * - transparent data (addt) are added to the wave channel, 0xFE and 0xFD are sent;
+ * - "baud=" and "bauds=" above maxBaud fail (0x1C) and the rate is kept.
+ *
+ * Components are addressed as on the display, "b[3].val", "p[1].b[3].val",
+ * "n0.val" or "main.n0.val"; names must be declared with addPage() and addObj().
+ * State is read and written by tests with the canonical "page.id.attr" key, es.
+ * emu.num("0.3.val"), or the variable name, es. emu.num("dim").
+ *
+ * NxtEmu emu(115200);
+ * NxtLcd lcd(&emu);
+ * lcd.init(115200);
+ * lcd.setNumeric(3,42);
+ * emu.settle();
+ * if(emu.num("0.3.val") == 42) ...
+ *
+*/
+
+
+#include <Arduino.h>
+
+
+static const char* emuSysVars[] = {
+    "dim", "dims", "spax", "spay", "thc", "thdra", "ussp", "thsp", "thup", "sendxy",
+    "delay", "sleep", "sys0", "sys1", "sys2", "wup", "usup",
+    "rtc0", "rtc1", "rtc2", "rtc3", "rtc4", "rtc5", "rtc6"
+};
+
+static const char* emuDrawCmds[] = {
+    "cls", "fill", "line", "draw", "cir", "cirs", "xstr", "pic", "picq", "xpic", "xpicq"
+};
+
+static const char* emuPlainCmds[] = {
+    "ref_stop", "ref_star", "doevents", "com_stop", "com_star", "code_c", "wept", "rept"
+};
+
+#define EMU_CNT(a)      (sizeof(a) / sizeof(a[0]))
+
+
+static uint8_t emuIn(const char* const* list, size_t cnt, const std::string& s){
+    for(size_t i = 0; i < cnt; i++){
+        if(s == list[i]) return 1;
+    }
+    return 0;
+}
+
+static uint8_t emuNumber(const std::string& s, int32_t* v){
+    if(s.empty()) return 0;
+    char* end;
+    long long n = strtoll(s.c_str(),&end,10);
+    if(*end != 0) return 0;
+    (*v) = (int32_t)n;
+    return 1;
+}
+
+static std::vector<std::string> emuSplit(const std::string& s, char sep){
+    std::vector<std::string> out;
+    size_t start = 0;
+    for(;;){
+        size_t pos = s.find(sep,start);
+        out.push_back(s.substr(start,pos - start));
+        if(pos == std::string::npos) break;
+        start = pos + 1;
+    }
+    return out;
+}
+
+// "b[12]" -> 12
+static uint8_t emuIndex(const std::string& tok, char prefix, uint8_t* id){
+    if(tok.size() < 4 || tok[0] != prefix || tok[1] != '[' || tok[tok.size() - 1] != ']') return 0;
+    int32_t v;
+    if(emuNumber(tok.substr(2,tok.size() - 3),&v) == 0 || v < 0 || v > 255) return 0;
+    (*id) = v;
+    return 1;
+}
+
+
+NxtEmu::NxtEmu(uint32_t rate){
+    baud = rate;
+    bauds = rate;
+    hostBaud = rate;
+    for(size_t i = 0; i < EMU_CNT(emuSysVars); i++) vars[emuSysVars[i]] = NxtEmuVal();
+    vars["dim"].num = 100;
+    vars["dims"].num = 100;
+    vars["wup"].num = 255;
+}
+
+
+/*
+ * run() - handle all the events (bytes received, commands done, boot end) up to now,
+ * in time order
+ */
+void NxtEmu::run(void){
+    uint64_t now = hostNow();
+    for(;;){
+        if(busy == 0 && booting == 0) startCmd();
+        uint64_t tArr = toPanel.empty() ? UINT64_MAX : toPanel.front().at;
+        uint64_t tDone = busy ? busyTo : UINT64_MAX;
+        uint64_t tBoot = booting ? bootAt : UINT64_MAX;
+        uint64_t t = std::min(tArr,std::min(tDone,tBoot));
+        if(t > now) break;
+        clk = t;
+        if(t == tBoot){
+            booting = 0;
+            replyCode(0x88);
+            continue;
+        }
+        if(t == tDone){
+            endCmd();
+            continue;
+        }
+        WireByte w = toPanel.front();
+        toPanel.pop_front();
+        if(w.baud != baud || booting){
+            lost++;
+            continue;
+        }
+        bytesIn++;
+        if(tdLeft > 0){
+            waves[tdWave].push_back(w.b);
+            if(--tdLeft == 0) replyCode(0xFD);
+            continue;
+        }
+        if(inBuf.size() >= bufSize){
+            lost++;
+            if(ovfl == 0){
+                ovfl = 1;
+                overflows++;
+                replyCode(0x24);
+            }
+            continue;
+        }
+        inBuf.push_back(w.b);
+        if(inBuf.size() > maxFill) maxFill = inBuf.size();
+    }
+}
+
+
+/*
+ * startCmd() - start executing the first command in the buffer, if complete
+ */
+void NxtEmu::startCmd(void){
+    uint8_t ff = 0;
+    for(size_t i = 0; i < inBuf.size(); i++){
+        ff = (inBuf[i] == 0xFF) ? ff + 1 : 0;
+        if(ff == 3){
+            std::string cmd(inBuf.begin(),inBuf.begin() + i - 2);
+            busy = 1;
+            busyLen = i + 1;
+            busyTo = clk + cost(cmd);
+            return;
+        }
+    }
+}
+
+
+/*
+ * endCmd() - the command started by startCmd() is done: free its bytes and run it
+ */
+void NxtEmu::endCmd(void){
+    std::string cmd(inBuf.begin(),inBuf.begin() + busyLen - 3);
+    inBuf.erase(inBuf.begin(),inBuf.begin() + busyLen);
+    busy = 0;
+    ovfl = 0;
+    exec(cmd);
+    while(tdLeft > 0 && !inBuf.empty()){
+        waves[tdWave].push_back(inBuf.front());
+        inBuf.pop_front();
+        if(--tdLeft == 0) replyCode(0xFD);
+    }
+}
+
+
+/*
+ * cost() - execution time of "cmd"
+ */
+uint32_t NxtEmu::cost(const std::string& cmd){
+    for(size_t i = 0; i < costs.size(); i++){
+        if(cmd.compare(0,costs[i].first.size(),costs[i].first) == 0) return costs[i].second;
+    }
+    std::string verb = cmd.substr(0,cmd.find(' '));
+    if(emuIn(emuDrawCmds,EMU_CNT(emuDrawCmds),verb)) return drawNs;
+    return cmdNs;
+}
+
+
+/*
+ * reply() - send "n" bytes to the host, after the ones already on the wire
+ */
+void NxtEmu::reply(const uint8_t* b, size_t n){
+    for(size_t i = 0; i < n; i++){
+        uint64_t start = std::max(clk,toHostEnd);
+        toHostEnd = start + byteNs(baud);
+        WireByte w = {toHostEnd,baud,b[i]};
+        toHost.push_back(w);
+    }
+}
+
+void NxtEmu::replyCode(uint8_t code){
+    uint8_t b[4] = {code,0xFF,0xFF,0xFF};
+    reply(b,4);
+}
+
+void NxtEmu::replyOk(void){
+    if(bkcmd == 1 || bkcmd == 3) replyCode(0x01);
+}
+
+void NxtEmu::replyNum(int32_t v){
+    uint8_t b[8] = {0x71,(uint8_t)v,(uint8_t)(v >> 8),(uint8_t)(v >> 16),(uint8_t)(v >> 24),0xFF,0xFF,0xFF};
+    reply(b,8);
+}
+
+void NxtEmu::replyStr(const std::string& s){
+    uint8_t c = 0x70;
+    reply(&c,1);
+    reply((const uint8_t*)s.data(),s.size());
+    uint8_t end[3] = {0xFF,0xFF,0xFF};
+    reply(end,3);
+}
+
+
+/*
+ * boot() - panel restart: state back to the defaults, startup and ready telegrams
+ */
+void NxtEmu::boot(void){
+    restarts++;
+    for(std::map<std::string,NxtEmuVal>::iterator it = vars.begin(); it != vars.end();){
+        if(emuIn(emuSysVars,EMU_CNT(emuSysVars),it->first)) ++it;
+        else vars.erase(it++);
+    }
+    for(size_t i = 0; i < EMU_CNT(emuSysVars); i++) vars[emuSysVars[i]] = NxtEmuVal();
+    vars["dim"].num = 100;
+    vars["dims"].num = 100;
+    vars["wup"].num = 255;
+    waves.clear();
+    bkcmd = 2;
+    page = 0;
+    baud = bauds;
+    busy = 0;
+    ovfl = 0;
+    tdLeft = 0;
+    inBuf.clear();
+    uint8_t b[6] = {0x00,0x00,0x00,0xFF,0xFF,0xFF};
+    reply(b,6);
+    booting = 1;
+    bootAt = clk + bootNs;
+}
+
+
+uint8_t NxtEmu::pageId(const std::string& tok, uint8_t* id){
+    if(emuIndex(tok,'p',id)) return 1;
+    int32_t v;
+    if(emuNumber(tok,&v) && v >= 0 && v < 256){
+        (*id) = v;
+        return 1;
+    }
+    std::map<std::string,uint8_t>::iterator it = pages.find(tok);
+    if(it == pages.end()) return 0;
+    (*id) = it->second;
+    return 1;
+}
+
+
+uint8_t NxtEmu::objId(uint8_t pg, const std::string& tok, uint8_t* id){
+    if(emuIndex(tok,'b',id)) return 1;
+    int32_t v;
+    if(emuNumber(tok,&v) && v >= 0 && v < 256){
+        (*id) = v;
+        return 1;
+    }
+    char pfx[8];
+    snprintf(pfx,sizeof(pfx),"%u.",pg);
+    std::map<std::string,uint8_t>::iterator it = objs.find(pfx + tok);
+    if(it == objs.end()) return 0;
+    (*id) = it->second;
+    return 1;
+}
+
+
+/*
+ * addr() - canonical key of a variable or attribute, "err" is the failure reply
+ */
+uint8_t NxtEmu::addr(const std::string& lhs, std::string* key, uint8_t* err){
+    std::vector<std::string> t = emuSplit(lhs,'.');
+    if(t.size() == 1){
+        if(lhs == "dp" || lhs == "bkcmd" || lhs == "baud" || lhs == "bauds" ||
+           emuIn(emuSysVars,EMU_CNT(emuSysVars),lhs)){
+            (*key) = lhs;
+            return 1;
+        }
+        (*err) = 0x1A;
+        return 0;
+    }
+    if(t.size() > 3){
+        (*err) = 0x1A;
+        return 0;
+    }
+    uint8_t pg = page;
+    uint8_t id;
+    if(t.size() == 3 && pageId(t[0],&pg) == 0){
+        (*err) = 0x03;
+        return 0;
+    }
+    const std::string& obj = t[t.size() - 2];
+    if(objId(pg,obj,&id) == 0){
+        if(strict || obj.empty()){
+            (*err) = 0x02;
+            return 0;
+        }
+        id = 255;
+    }
+    char buf[16];
+    snprintf(buf,sizeof(buf),"%u.%u.",pg,id);
+    (*key) = buf + t[t.size() - 1];
+    return 1;
+}
+
+
+/*
+ * exec() - run a command
+ */
+void NxtEmu::exec(const std::string& cmd){
+    log.push_back(cmd);
+    if(cmd.empty()) return;
+    size_t sp = cmd.find(' ');
+    size_t eq = cmd.find('=');
+    std::string verb = cmd.substr(0,sp);
+    std::string args = (sp == std::string::npos) ? "" : cmd.substr(sp + 1);
+    std::vector<std::string> a = emuSplit(args,',');
+    uint8_t err = 0x00;
+    std::string key;
+    if(verb == "get"){
+        if(addr(args,&key,&err) == 0){
+            if(bkcmd >= 2) replyCode(err);
+            return;
+        }
+        if(key.size() > 3 && key.compare(key.size() - 3,3,".id") == 0){
+            replyNum(atoi(key.substr(key.find('.') + 1).c_str()));
+            return;
+        }
+        if(key.size() > 4 && key.compare(key.size() - 4,4,".txt") == 0) replyStr(str(key));
+        else if(has(key) && vars[key].isStr) replyStr(vars[key].str);
+        else replyNum(num(key));
+        return;
+    }
+    if(eq != std::string::npos && (sp == std::string::npos || eq < sp)){
+        std::string lhs = cmd.substr(0,eq);
+        std::string rhs = cmd.substr(eq + 1);
+        if(addr(lhs,&key,&err) == 0){
+            if(bkcmd >= 2) replyCode(err);
+            return;
+        }
+        if(rhs.size() >= 2 && rhs[0] == '"' && rhs[rhs.size() - 1] == '"'){
+            std::string s;
+            for(size_t i = 1; i + 1 < rhs.size(); i++){
+                if(rhs[i] == '\\' && i + 2 < rhs.size()) i++;
+                s += rhs[i];
+            }
+            setStr(key,s);
+            replyOk();
+            return;
+        }
+        int32_t v;
+        if(emuNumber(rhs,&v) == 0){
+            if(bkcmd >= 2) replyCode(0x00);
+            return;
+        }
+        if(key == "baud" || key == "bauds"){
+            if((uint32_t)v > maxBaud){
+                if(bkcmd >= 2) replyCode(0x1C);
+                return;
+            }
+            if(key == "bauds") bauds = v;
+            replyOk();
+            baud = v;           // the reply go out at the old rate
+            return;
+        }
+        setNum(key,v);
+        replyOk();
+        return;
+    }
+    uint8_t id;
+    uint8_t ok = 1;
+    if(verb == "page"){
+        ok = pageId(args,&id);
+        err = 0x03;
+        if(ok) page = id;
+    }
+    else if(verb == "sendme"){
+        uint8_t b[5] = {0x66,page,0xFF,0xFF,0xFF};
+        reply(b,5);
+        return;
+    }
+    else if(verb == "rest"){
+        boot();
+        return;
+    }
+    else if(verb == "ref" || verb == "click" || verb == "vis" || verb == "tsw"){
+        ok = objId(page,a[0],&id) || a[0] == "255";
+        err = 0x02;
+    }
+    else if(verb == "add" || verb == "addt" || verb == "cle"){
+        int32_t w = 0, c = 0, v = 0;
+        ok = a.size() == (verb == "cle" ? 2u : 3u) && emuNumber(a[0],&w) && emuNumber(a[1],&c) &&
+             (verb == "cle" || emuNumber(a[2],&v));
+        if(ok && verb == "add") waves[w * 4 + c].push_back(v);
+        if(ok && verb == "cle"){
+            for(int i = 0; i < 4; i++){
+                if(c == 255 || c == i) waves[w * 4 + i].clear();
+            }
+        }
+        if(ok && verb == "addt"){
+            tdWave = w * 4 + c;
+            tdLeft = v;
+            replyCode(0xFE);
+            if(tdLeft == 0) replyCode(0xFD);
+            return;
+        }
+    }
+    else if(!emuIn(emuDrawCmds,EMU_CNT(emuDrawCmds),verb) && !emuIn(emuPlainCmds,EMU_CNT(emuPlainCmds),verb)){
+        ok = 0;
+    }
+    if(ok) replyOk();
+    else if(bkcmd >= 2) replyCode(err);
+}
+
+
+/*
+ * begin() - the host side of the link is (re)opened at "rate"
+ */
+void NxtEmu::begin(unsigned long rate){
+    run();
+    hostBaud = rate;
+}
+
+
+int NxtEmu::available(void){
+    run();
+    uint64_t now = hostNow();
+    int n = 0;
+    for(std::deque<WireByte>::iterator it = toHost.begin(); it != toHost.end() && it->at <= now;){
+        if(it->baud != hostBaud){
+            it = toHost.erase(it);
+            lost++;
+            continue;
+        }
+        n++;
+        ++it;
+    }
+    return n;
+}
+
+
+int NxtEmu::read(void){
+    if(available() == 0) return -1;
+    uint8_t b = toHost.front().b;
+    toHost.pop_front();
+    return b;
+}
+
+
+int NxtEmu::peek(void){
+    if(available() == 0) return -1;
+    return toHost.front().b;
+}
+
+
+/*
+ * write() - queue the bytes on the wire, waiting for room in the UART FIFO
+ */
+size_t NxtEmu::write(const uint8_t* b, size_t s){
+    run();
+    uint64_t bt = byteNs(hostBaud);
+    for(size_t i = 0; i < s; i++){
+        uint64_t now = hostNow();
+        if(toPanelEnd > now + (txFifo - 1) * bt){
+            hostAdvance(toPanelEnd - (txFifo - 1) * bt - now);
+            now = hostNow();
+        }
+        toPanelEnd = std::max(now,toPanelEnd) + bt;
+        WireByte w = {toPanelEnd,(uint32_t)hostBaud,b[i]};
+        toPanel.push_back(w);
+    }
+    return s;
+}
+
+
+int NxtEmu::availableForWrite(void){
+    uint64_t now = hostNow();
+    uint64_t bt = byteNs(hostBaud);
+    uint64_t pending = (toPanelEnd > now) ? (toPanelEnd - now + bt - 1) / bt : 0;
+    return (pending < txFifo) ? txFifo - pending : 0;
+}
+
+
+void NxtEmu::addPage(uint8_t id, const char* name){
+    pages[name] = id;
+}
+
+
+void NxtEmu::addObj(uint8_t pg, uint8_t id, const char* name){
+    char pfx[8];
+    snprintf(pfx,sizeof(pfx),"%u.",pg);
+    objs[pfx + std::string(name)] = id;
+}
+
+
+/*
+ * setCost() - commands starting with "prefix" take "ns" to execute
+ */
+void NxtEmu::setCost(const char* prefix, uint32_t ns){
+    costs.insert(costs.begin(),std::make_pair(std::string(prefix),ns));
+}
+
+
+void NxtEmu::touch(uint8_t pg, uint8_t comp, uint8_t ev){
+    run();
+    clk = hostNow();
+    uint8_t b[7] = {0x65,pg,comp,ev,0xFF,0xFF,0xFF};
+    reply(b,7);
+}
+
+
+void NxtEmu::touchXY(uint16_t x, uint16_t y, uint8_t ev, uint8_t sleep){
+    run();
+    clk = hostNow();
+    uint8_t b[9] = {(uint8_t)(sleep ? 0x68 : 0x67),(uint8_t)(x >> 8),(uint8_t)x,
+                    (uint8_t)(y >> 8),(uint8_t)y,ev,0xFF,0xFF,0xFF};
+    reply(b,9);
+}
+
+
+void NxtEmu::restart(void){
+    run();
+    clk = hostNow();
+    boot();
+}
+
+
+void NxtEmu::send(const uint8_t* b, size_t n){
+    run();
+    clk = hostNow();
+    reply(b,n);
+}
+
+
+int32_t NxtEmu::num(const std::string& key){
+    run();
+    if(key == "dp") return page;
+    if(key == "bkcmd") return bkcmd;
+    if(key == "baud") return baud;
+    if(key == "bauds") return bauds;
+    std::map<std::string,NxtEmuVal>::iterator it = vars.find(key);
+    return (it == vars.end()) ? 0 : it->second.num;
+}
+
+
+std::string NxtEmu::str(const std::string& key){
+    run();
+    std::map<std::string,NxtEmuVal>::iterator it = vars.find(key);
+    return (it == vars.end()) ? std::string() : it->second.str;
+}
+
+
+void NxtEmu::setNum(const std::string& key, int32_t v){
+    if(key == "dp") page = v;
+    else if(key == "bkcmd") bkcmd = v;
+    else{
+        NxtEmuVal& val = vars[key];
+        val.isStr = 0;
+        val.num = v;
+    }
+}
+
+
+void NxtEmu::setStr(const std::string& key, const std::string& s){
+    NxtEmuVal& val = vars[key];
+    val.isStr = 1;
+    val.str = s;
+}
+
+
+/*
+ * idle() - 1 when the panel has nothing left to do or to send
+ */
+uint8_t NxtEmu::idle(void){
+    run();
+    return busy == 0 && booting == 0 && toPanel.empty() && toHost.empty() && tdLeft == 0 &&
+           inBuf.empty();
+}
+
+
+/*
+ * settle() - move the clock until all the bytes sent are received and executed; the
+ * replies are left for the host to read
+ */
+void NxtEmu::settle(void){
+    run();
+    while(busy || booting || !toPanel.empty()){
+        uint64_t t = UINT64_MAX;
+        if(!toPanel.empty()) t = toPanel.front().at;
+        if(busy) t = std::min(t,busyTo);
+        if(booting) t = std::min(t,bootAt);
+        uint64_t now = hostNow();
+        if(t > now) hostAdvance(t - now);
+        run();
+    }
+    if(!toHost.empty() && toHost.back().at > hostNow()) hostAdvance(toHost.back().at - hostNow());
+}
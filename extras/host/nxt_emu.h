@@ -0,0 +1,148 @@
+/* nxt_emu.h
+ *
+ * NxtEmu - a Nextion display emulator for the host build, with the timing of the real
+ * link: it's the serial port given to NxtLcd (-DNXT_SERIAL_TYPE=NxtEmu), and the panel
+ * behind it. See nxt_emu.cpp
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#ifndef __NXT_EMU_H__
+#define __NXT_EMU_H__
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+
+/*
+ * NxtEmuVal - a variable or component attribute of the panel
+ */
+struct NxtEmuVal{
+    uint8_t     isStr = 0;
+    int32_t     num = 0;
+    std::string str;
+};
+
+class NxtEmu : public Stream{
+private:
+    struct WireByte{
+        uint64_t    at;                 // ns, when the last bit is received
+        uint32_t    baud;               // rate of the sender
+        uint8_t     b;
+    };
+    std::deque<WireByte>    toPanel;
+    std::deque<WireByte>    toHost;
+    std::deque<uint8_t>     inBuf;      // panel serial buffer
+    uint64_t                toPanelEnd = 0;
+    uint64_t                toHostEnd = 0;
+    uint64_t                clk = 0;    // time of the last event handled
+    uint64_t                busyTo = 0;
+    uint16_t                busyLen = 0;
+    uint8_t                 busy = 0;
+    uint8_t                 ovfl = 0;
+    uint64_t                bootAt = 0;
+    uint8_t                 booting = 0;
+    uint32_t                tdLeft = 0;
+    int                     tdWave = -1;
+    uint32_t                hostBaud = 0;
+    uint32_t                newBaud = 0;
+    std::map<std::string,NxtEmuVal>         vars;
+    std::map<std::string,uint8_t>           pages;
+    std::map<std::string,uint8_t>           objs;      // "page.name" -> id
+    std::vector<std::pair<std::string,uint32_t> > costs;
+
+    void        run(void);
+    void        startCmd(void);
+    void        endCmd(void);
+    void        exec(const std::string& cmd);
+    uint32_t    cost(const std::string& cmd);
+    void        reply(const uint8_t* b, size_t n);
+    void        replyCode(uint8_t code);
+    void        replyOk(void);
+    void        replyNum(int32_t v);
+    void        replyStr(const std::string& s);
+    void        boot(void);
+    uint8_t     addr(const std::string& lhs, std::string* key, uint8_t* err);
+    uint8_t     objId(uint8_t page, const std::string& tok, uint8_t* id);
+    uint8_t     pageId(const std::string& tok, uint8_t* id);
+    uint64_t    byteNs(uint32_t rate){return 10000000000ULL / rate;};
+
+public:
+    /*
+     * model parameters, can be changed at any time
+     */
+    uint16_t    bufSize = 1024;         // panel serial buffer (NXT_DEV_BUF_SIZE)
+    uint16_t    txFifo = 64;            // host UART FIFO, write() block when it's full
+    uint32_t    cmdNs = 200000;         // execution time of a command
+    uint32_t    drawNs = 2000000;       // execution time of cls, fill, line, cir, xstr...
+    uint32_t    bootNs = 100000000;     // from startup (00 00 00) to ready (0x88)
+    uint32_t    maxBaud = 921600;       // fastest rate "baud=" accept
+
+    /*
+     * panel state, can be read and changed by tests
+     */
+    uint32_t    baud;                   // current panel rate
+    uint32_t    bauds;                  // rate after a restart
+    uint8_t     bkcmd = 2;
+    uint8_t     page = 0;
+    uint8_t     strict = 1;             // unknown component names are errors
+
+    /*
+     * statistics
+     */
+    std::vector<std::string>    log;    // commands executed, in order
+    uint32_t    bytesIn = 0;            // bytes received by the panel
+    uint32_t    overflows = 0;          // 0x24 sent
+    uint32_t    lost = 0;               // bytes dropped (buffer full or wrong rate)
+    uint16_t    maxFill = 0;            // max bytes seen in the panel buffer
+    uint32_t    restarts = 0;
+    std::map<int,std::vector<uint8_t> >     waves;     // id * 4 + ch
+
+    NxtEmu(uint32_t rate = 9600);
+
+    /*
+     * host side, as seen by NxtLcd
+     */
+    void        begin(unsigned long rate);
+    void        end(void){};
+    int         available(void);
+    int         read(void);
+    int         peek(void);
+    size_t      write(uint8_t b){return write(&b,1);};
+    size_t      write(const uint8_t* b, size_t s);
+    int         availableForWrite(void);
+
+    /*
+     * HMI content: pages and components known by name
+     */
+    void        addPage(uint8_t id, const char* name);
+    void        addObj(uint8_t page, uint8_t id, const char* name);
+    void        setCost(const char* prefix, uint32_t ns);
+
+    /*
+     * panel events
+     */
+    void        touch(uint8_t pg, uint8_t comp, uint8_t ev);
+    void        touchXY(uint16_t x, uint16_t y, uint8_t ev, uint8_t sleep = 0);
+    void        restart(void);
+    void        send(const uint8_t* b, size_t n);
+
+    /*
+     * state access; "key" is the canonical name: a system variable ("dim") or
+     * "page.id.attr" for the components ("0.3.val")
+     */
+    int32_t     num(const std::string& key);
+    std::string str(const std::string& key);
+    uint8_t     has(const std::string& key){return vars.count(key) > 0;};
+    void        setNum(const std::string& key, int32_t v);
+    void        setStr(const std::string& key, const std::string& s);
+    uint16_t    fill(void){run();return inBuf.size();};
+    uint8_t     idle(void);
+    void        settle(void);
+    void        clearLog(void){log.clear();};
+};
+
+#endif // __NXT_EMU_H__
@@ -0,0 +1,23 @@
+/* size_main.cpp
+ *
+ * The event_handle example, built as for a board to compare the library footprint
+ * with the port and display type chosen at runtime (default) or at compile time
+ * (NXT_SERIAL_TYPE, NXT_DISP_TYPE), see the size targets in CMakeLists.txt.
+ * When run, print the RAM taken by a NxtLcd instance, and how much it grew from the
+ * 0.0.2 class (NXT_SIZE_BASE, measured with the same host build).
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "../../examples/event_handle/event_handle.ino"
+
+#define NXT_SIZE_BASE   240     // sizeof(NxtLcd) of the 0.0.2 sources, ARDUINO_ARCH_STM32 on x86-64
+
+int main(void){
+    setup();
+    loop();
+    printf("sizeof(NxtLcd) = %u, baseline %u, %+d\n",(unsigned)sizeof(NxtLcd),
+           (unsigned)NXT_SIZE_BASE,(int)sizeof(NxtLcd) - NXT_SIZE_BASE);
+    return 0;
+}
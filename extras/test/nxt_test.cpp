@@ -0,0 +1,60 @@
+/* nxt_test.cpp
+ *
+ * Runner of the host tests, see nxt_test.h
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+#define NXT_TEST_MAX    64
+
+static struct{
+    const char*  name;
+    nxtTestFn_t  fn;
+} tests[NXT_TEST_MAX];
+static int testCnt = 0;
+static int testFailed = 0;
+
+
+NxtTestReg::NxtTestReg(const char* name, nxtTestFn_t fn){
+    if(testCnt == NXT_TEST_MAX){
+        printf("too many tests, %s not registered\n",name);
+        return;
+    }
+    tests[testCnt].name = name;
+    tests[testCnt].fn = fn;
+    testCnt++;
+}
+
+void nxtCheck(int ok, const char* expr, const char* file, int line){
+    if(ok) return;
+    printf("  %s:%d: check failed: %s\n",file,line,expr);
+    testFailed = 1;
+}
+
+void nxtCheckEq(long long a, long long b, const char* ea, const char* eb, const char* file, int line){
+    if(a == b) return;
+    printf("  %s:%d: %s == %s failed: %lld != %lld\n",file,line,ea,eb,a,b);
+    testFailed = 1;
+}
+
+void nxtCheckStr(const char* a, const char* b, const char* ea, const char* eb, const char* file, int line){
+    if(strcmp(a,b) == 0) return;
+    printf("  %s:%d: %s == %s failed: \"%s\" != \"%s\"\n",file,line,ea,eb,a,b);
+    testFailed = 1;
+}
+
+int main(int argc, char** argv){
+    int failed = 0;
+    for(int i = 0; i < testCnt; i++){
+        if(argc > 1 && strcmp(argv[1],tests[i].name) != 0) continue;
+        hostReset();
+        testFailed = 0;
+        tests[i].fn();
+        printf("%s %s\n",testFailed ? "FAIL" : "ok  ",tests[i].name);
+        failed += testFailed;
+    }
+    return failed;
+}
@@ -0,0 +1,53 @@
+/* nxt_test.h
+ *
+ * A tiny test framework for the host build: each NXT_TEST() is registered and run by
+ * main() (nxt_test.cpp), with the virtual clock reset; a failed NXT_CHECK print the
+ * file, line and expression and the test go on. The exit code is the number of tests
+ * failed, so ctest see them.
+ *
+ * NXT_TEST(setNumericWrite){
+ *     NxtEmu emu(115200);
+ *     NxtLcd lcd(&emu);
+ *     NXT_CHECK_EQ(lcd.init(115200,1,0,0),replyCmdOk);
+ *     ...
+ * }
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#ifndef __NXT_TEST_H__
+#define __NXT_TEST_H__
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+typedef void (*nxtTestFn_t)(void);
+
+class NxtTestReg{
+public:
+    NxtTestReg(const char* name, nxtTestFn_t fn);
+};
+
+void nxtCheck(int ok, const char* expr, const char* file, int line);
+void nxtCheckEq(long long a, long long b, const char* ea, const char* eb, const char* file, int line);
+void nxtCheckStr(const char* a, const char* b, const char* ea, const char* eb, const char* file, int line);
+
+#define NXT_TEST(name) \
+    static void name(void); \
+    static NxtTestReg name##Reg(#name,name); \
+    static void name(void)
+
+#define NXT_CHECK(e)            nxtCheck((e) ? 1 : 0,#e,__FILE__,__LINE__)
+#define NXT_CHECK_EQ(a,b)       nxtCheckEq((long long)(a),(long long)(b),#a,#b,__FILE__,__LINE__)
+#define NXT_CHECK_STR(a,b)      nxtCheckStr((a),(b),#a,#b,__FILE__,__LINE__)
+
+/*
+ * nxtLast() - last command executed by the emulator, "" if none
+ */
+inline const char* nxtLast(NxtEmu& emu){
+    emu.settle();
+    return emu.log.empty() ? "" : emu.log.back().c_str();
+}
+
+#endif // __NXT_TEST_H__
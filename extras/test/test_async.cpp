@@ -0,0 +1,260 @@
+/* test_async.cpp
+ *
+ * Host tests of the async get requests: FIFO completion, callbacks, timeouts with
+ * late replies, string copy limits
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+#define SLOTS       4           // request slots given to setReqSlots()
+
+
+static uint8_t cbRes[8];
+static uint8_t cbCnt;
+
+static void reqCb(uint8_t handle, uint8_t res, void* ctx){
+    (void)handle;
+    (void)ctx;
+    if(cbCnt < sizeof(cbRes)) cbRes[cbCnt++] = res;
+}
+
+
+/*
+ * requests sent back to back complete in order, with their own values
+ */
+NXT_TEST(fifoOrder){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    nxtReq_t slots[SLOTS];
+    lcd.setReqSlots(slots,SLOTS);
+    int32_t v[SLOTS];
+    uint8_t h[SLOTS];
+    for(int i = 0; i < SLOTS; i++){
+        emu.setNum("0." + std::to_string(i + 1) + ".val",100 + i);
+        NXT_CHECK_EQ(lcd.getNumericAsync(i + 1,&v[i],sizeof(v[i]),&h[i]),replyCmdOk);
+    }
+    NXT_CHECK_EQ(lcd.getReqCnt(),SLOTS);
+    NXT_CHECK_EQ(lcd.reqStatus(h[0]),noComplete);
+    lcd.reqFlush();
+    for(int i = 0; i < SLOTS; i++){
+        NXT_CHECK_EQ(lcd.reqStatus(h[i]),replyCmdOk);
+        NXT_CHECK_EQ(v[i],100 + i);
+    }
+    NXT_CHECK_EQ(lcd.reqStatus(h[0]),invalidData);
+}
+
+
+/*
+ * callbacks free the slot and get the result
+ */
+NXT_TEST(callbacks){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    nxtReq_t slots[SLOTS];
+    lcd.setReqSlots(slots,SLOTS);
+    emu.addObj(0,2,"n0");
+    cbCnt = 0;
+    int32_t a, b;
+    uint8_t h;
+    lcd.getNumericAsync(2,&a,sizeof(a),&h,reqCb);
+    lcd.getNumericAsync("x9",&b,sizeof(b),&h,reqCb);
+    lcd.reqFlush();
+    NXT_CHECK_EQ(cbCnt,2);
+    NXT_CHECK_EQ(cbRes[0],replyCmdOk);
+    NXT_CHECK_EQ(cbRes[1],replyWrongId);
+}
+
+
+static int32_t chainVal;
+static uint8_t chainHnd;
+
+static void chainCb(uint8_t handle, uint8_t res, void* ctx){
+    NxtLcd* lcd = (NxtLcd*)ctx;
+    reqCb(handle,res,NULL);
+    lcd->getNumericAsync(5,&chainVal,sizeof(chainVal),&chainHnd,reqCb);
+}
+
+
+/*
+ * a callback sending a new request is not called while a blocking command is being
+ * sent: the command is not overwritten, the callback run on the next poll()
+ */
+NXT_TEST(callbackSends){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    nxtReq_t slots[SLOTS];
+    lcd.setReqSlots(slots,SLOTS);
+    emu.setNum("0.2.val",2);
+    emu.setNum("0.5.val",5);
+    cbCnt = 0;
+    chainVal = 0;
+    int32_t a = 0;
+    uint8_t h;
+    lcd.getNumericAsync(2,&a,sizeof(a),&h,chainCb,&lcd);
+    emu.settle();
+    emu.clearLog();
+    NXT_CHECK_EQ(lcd.setNumeric(3,42),replyCmdOk);
+    NXT_CHECK_EQ(cbCnt,0);
+    NXT_CHECK_STR(nxtLast(emu),"b[3].val=42");
+    NXT_CHECK_EQ(emu.num("0.3.val"),42);
+    lcd.poll();
+    NXT_CHECK_EQ(cbCnt,1);
+    NXT_CHECK_EQ(a,2);
+    lcd.reqFlush();
+    NXT_CHECK_EQ(cbCnt,2);
+    NXT_CHECK_EQ(cbRes[1],replyCmdOk);
+    NXT_CHECK_EQ(chainVal,5);
+    NXT_CHECK_EQ(emu.log.size(),2);
+    NXT_CHECK_STR(nxtLast(emu),"get b[5].val");
+}
+
+
+/*
+ * a reply arriving after NXT_REQ_WAIT (but inside the resync window) is not given
+ * to the next request
+ */
+NXT_TEST(lateReply){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    nxtReq_t slots[SLOTS];
+    lcd.setReqSlots(slots,SLOTS);
+    emu.setNum("0.1.val",11);
+    emu.setNum("0.2.val",22);
+    emu.setCost("get b[1]",(NXT_REQ_WAIT + NXT_REPLY_WAIT / 2) * 1000000UL);
+    int32_t a = 0, b = 0;
+    uint8_t ha, hb;
+    lcd.getNumericAsync(1,&a,sizeof(a),&ha);
+    lcd.getNumericAsync(2,&b,sizeof(b),&hb);
+    lcd.reqFlush();
+    NXT_CHECK_EQ(lcd.reqStatus(ha),noReply);
+    NXT_CHECK_EQ(lcd.reqStatus(hb),noReply);
+    NXT_CHECK_EQ(lcd.getNumericAsync(2,&b,sizeof(b),&hb),replyCmdOk);
+    lcd.reqFlush();
+    NXT_CHECK_EQ(lcd.reqStatus(hb),replyCmdOk);
+    NXT_CHECK_EQ(b,22);
+    NXT_CHECK_EQ(a,0);
+}
+
+
+/*
+ * the same with a sketch that only poll()
+ */
+NXT_TEST(lateReplyPoll){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    nxtReq_t slots[SLOTS];
+    lcd.setReqSlots(slots,SLOTS);
+    emu.setNum("0.2.val",22);
+    emu.setCost("get b[1]",(NXT_REQ_WAIT + NXT_REPLY_WAIT / 2) * 1000000UL);
+    int32_t a = 0, b = 0;
+    uint8_t ha, hb;
+    lcd.getNumericAsync(1,&a,sizeof(a),&ha);
+    while(lcd.reqStatus(ha) == noComplete) hostAdvance(1000000);
+    lcd.getNumericAsync(2,&b,sizeof(b),&hb);
+    uint8_t res;
+    while((res = lcd.reqStatus(hb)) == noComplete) hostAdvance(1000000);
+    NXT_CHECK_EQ(res,replyCmdOk);
+    NXT_CHECK_EQ(b,22);
+}
+
+
+/*
+ * strings are cut at size-1 characters and always terminated
+ */
+NXT_TEST(stringLimit){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    nxtReq_t slots[SLOTS];
+    lcd.setReqSlots(slots,SLOTS);
+    emu.setStr("0.4.txt","hello");
+    char s[6];
+    memset(s,'#',sizeof(s));
+    uint8_t h;
+    NXT_CHECK_EQ(lcd.getStringAsync(4,s,4,&h),replyCmdOk);
+    lcd.reqFlush();
+    NXT_CHECK_EQ(lcd.reqStatus(h),replyCmdOk);
+    NXT_CHECK_STR(s,"hel");
+    NXT_CHECK_EQ(s[4],'#');
+    NXT_CHECK_EQ(lcd.getStringAsync(4,s,sizeof(s),&h),replyCmdOk);
+    lcd.reqFlush();
+    NXT_CHECK_EQ(lcd.reqStatus(h),replyCmdOk);
+    NXT_CHECK_STR(s,"hello");
+    NXT_CHECK_EQ(lcd.getStringAsync(4,s,0,&h),invalidData);
+}
+
+
+/*
+ * a blocking command wait for the requests in flight
+ */
+NXT_TEST(blockingAfterAsync){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,1);
+    nxtReq_t slots[SLOTS];
+    lcd.setReqSlots(slots,SLOTS);
+    emu.setNum("0.1.val",5);
+    int32_t a = 0, b = 0;
+    uint8_t h;
+    lcd.getNumericAsync(1,&a,sizeof(a),&h);
+    NXT_CHECK_EQ(lcd.getNumeric(1,&b,sizeof(b)),replyCmdOk);
+    NXT_CHECK_EQ(lcd.reqStatus(h),replyCmdOk);
+    NXT_CHECK_EQ(a,5);
+    NXT_CHECK_EQ(b,5);
+}
+
+
+/*
+ * requests queued behind a TX ring backlog at 9600 baud: the timeout start when they
+ * are on the wire, not when they are queued
+ */
+NXT_TEST(txBacklog){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    uint8_t ring[512];
+    lcd.init(9600,1,0,0);
+    nxtReq_t slots[SLOTS];
+    lcd.setReqSlots(slots,SLOTS);
+    lcd.setTxBuf(ring,sizeof(ring));
+    for(int i = 0; i < 3; i++){
+        NXT_CHECK_EQ(lcd.writeStr("backlog of a slow link, queued in the ring",0,i * 20,200,20),replyCmdOk);
+    }
+    int32_t v[4];
+    uint8_t h[4];
+    for(int i = 0; i < 4; i++){
+        emu.setNum("0." + std::to_string(i + 1) + ".val",10 + i);
+        NXT_CHECK_EQ(lcd.getNumericAsync(i + 1,&v[i],sizeof(v[i]),&h[i]),replyCmdOk);
+    }
+    for(int i = 0; i < 4; i++){
+        uint8_t res;
+        while((res = lcd.reqStatus(h[i])) == noComplete) hostAdvance(1000000);
+        NXT_CHECK_EQ(res,replyCmdOk);
+        NXT_CHECK_EQ(v[i],10 + i);
+    }
+}
+
+
+/*
+ * without slots the async gets are refused, init() in nxt_propPipe mode use its own
+ */
+NXT_TEST(noSlots){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    int32_t v;
+    uint8_t h;
+    emu.setNum("dim",70);
+    NXT_CHECK_EQ(lcd.init(115200,1,0,0,nxt_propPipe),replyCmdOk);
+    uint16_t dim = 0;
+    NXT_CHECK_EQ(lcd.getProperty(nxt_dim,&dim,1),replyCmdOk);
+    NXT_CHECK_EQ(dim,70);
+    NXT_CHECK_EQ(lcd.getNumericAsync(1,&v,sizeof(v),&h),notSupported);
+    NXT_CHECK_EQ(lcd.getReqCnt(),0);
+}
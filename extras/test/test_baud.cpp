@@ -0,0 +1,142 @@
+/* test_baud.cpp
+ *
+ * Host tests of the baudrate switch and of the link recovery (baud.cpp): fall back to
+ * the old rate, scan of the supported rates, probing at init()
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+/*
+ * both sides use "rate", and the commands reach the display
+ */
+static void linkOk(NxtEmu& emu, NxtLcd& lcd, uint32_t rate){
+    NXT_CHECK_EQ(lcd.getBaud(),rate);
+    NXT_CHECK_EQ(emu.baud,rate);
+    int32_t v = emu.num("0.2.val") + 1;
+    lcd.setNumeric(2,v);
+    emu.settle();
+    NXT_CHECK_EQ(emu.num("0.2.val"),v);
+}
+
+
+/*
+ * the display refuse the new rate: the probe at it fail, the old one is still good
+ */
+NXT_TEST(fallBack){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    lcd.init(9600,1,0,0);
+    emu.maxBaud = 57600;
+    NXT_CHECK(lcd.setBaud(115200) != replyCmdOk);
+    linkOk(emu,lcd,9600);
+    NXT_CHECK_EQ(lcd.setBaud(57600),replyCmdOk);
+    linkOk(emu,lcd,57600);
+}
+
+
+/*
+ * a rate not supported is refused before sending anything
+ */
+NXT_TEST(badRate){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    lcd.init(9600,1,0,0);
+    emu.clearLog();
+    NXT_CHECK_EQ(lcd.setBaud(14400),invalidData);
+    NXT_CHECK_EQ(emu.log.size(),0);
+    linkOk(emu,lcd,9600);
+}
+
+
+/*
+ * the display switch too late for the probe at the new rate, and no longer answer at
+ * the old one: the rates are scanned and the new one found
+ */
+NXT_TEST(lateSwitch){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    lcd.init(9600,1,0,0);
+    emu.setCost("baud=",120000000);
+    NXT_CHECK(lcd.setBaud(115200) != replyCmdOk);
+    linkOk(emu,lcd,115200);
+}
+
+
+/*
+ * the display left at a rate the library does not know: findBaud() scan the rates
+ */
+NXT_TEST(findBaud){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    lcd.init(9600,1,0,0);
+    emu.baud = 38400;
+    lcd.setNumeric(2,5);
+    emu.settle();
+    NXT_CHECK(emu.lost > 0);
+    NXT_CHECK(emu.num("0.2.val") != 5);
+    uint32_t rate = 0;
+    NXT_CHECK_EQ(lcd.findBaud(&rate),replyCmdOk);
+    NXT_CHECK_EQ(rate,38400);
+    linkOk(emu,lcd,38400);
+}
+
+
+/*
+ * no rate answer: the port is left at the previous one
+ */
+NXT_TEST(findNone){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    lcd.init(9600,1,0,0);
+    emu.baud = 14400;
+    uint32_t rate = 0;
+    NXT_CHECK_EQ(lcd.findBaud(&rate),noReply);
+    NXT_CHECK_EQ(rate,0);
+    NXT_CHECK_EQ(lcd.getBaud(),9600);
+    emu.baud = 9600;
+    linkOk(emu,lcd,9600);
+}
+
+
+/*
+ * init() with baudrate=0 probe the rates before reading the properties
+ */
+NXT_TEST(initProbe){
+    NxtEmu emu(57600);
+    emu.setNum("dim",42);
+    NxtLcd lcd(&emu);
+    NXT_CHECK_EQ(lcd.init(0,1,0,0),replyCmdOk);
+    linkOk(emu,lcd,57600);
+    uint16_t dim;
+    NXT_CHECK_EQ(lcd.getProperty(nxt_dim,&dim,1),replyCmdOk);
+    NXT_CHECK_EQ(dim,42);
+}
+
+
+/*
+ * persist=1 send "bauds=": the display restart at the new rate. A refused one leave
+ * the startup rate as it was
+ */
+NXT_TEST(persist){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    lcd.init(9600,1,0,0);
+    emu.maxBaud = 57600;
+    NXT_CHECK(lcd.setBaud(115200,1) != replyCmdOk);
+    NXT_CHECK_EQ(emu.bauds,9600);
+    linkOk(emu,lcd,9600);
+    emu.clearLog();
+    NXT_CHECK_EQ(lcd.setBaud(57600,1),replyCmdOk);
+    NXT_CHECK_STR(emu.log[0].c_str(),"bauds=57600");
+    NXT_CHECK_EQ(emu.bauds,57600);
+    linkOk(emu,lcd,57600);
+    emu.restart();
+    emu.settle();
+    NXT_CHECK_EQ(emu.baud,57600);
+    lcd.poll();
+    linkOk(emu,lcd,57600);
+}
@@ -0,0 +1,116 @@
+/* test_builder.cpp
+ *
+ * Host tests of the command builder (cmd_buf.cpp): integer conversion, terminator,
+ * buffer overflow
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+#include "nxt_access.h"
+
+typedef NxtHostAccess A;
+
+
+static std::string uintStr(NxtLcd& lcd, uint32_t v){
+    A::cmdStart(lcd);
+    A::cmdUint(lcd,v);
+    return A::cmd(lcd);
+}
+
+static std::string intStr(NxtLcd& lcd, int32_t v){
+    A::cmdStart(lcd);
+    A::cmdInt(lcd,v);
+    return A::cmd(lcd);
+}
+
+
+NXT_TEST(cmdUint){
+    NxtEmu emu;
+    NxtLcd lcd(&emu);
+    const uint32_t vals[] = {0, 1, 9, 10, 99, 100, 9999, 10000, 65535, 65536, 99999,
+                             100000, 1000000000UL, 4294967295UL};
+    char tmp[16];
+    for(size_t i = 0; i < sizeof(vals) / sizeof(vals[0]); i++){
+        snprintf(tmp,sizeof(tmp),"%lu",(unsigned long)vals[i]);
+        NXT_CHECK_STR(uintStr(lcd,vals[i]).c_str(),tmp);
+    }
+    for(uint32_t v = 0; v < 70000; v += 7){
+        snprintf(tmp,sizeof(tmp),"%lu",(unsigned long)v);
+        if(uintStr(lcd,v) != tmp) NXT_CHECK_STR(uintStr(lcd,v).c_str(),tmp);
+    }
+}
+
+
+NXT_TEST(cmdInt){
+    NxtEmu emu;
+    NxtLcd lcd(&emu);
+    NXT_CHECK_STR(intStr(lcd,0).c_str(),"0");
+    NXT_CHECK_STR(intStr(lcd,-1).c_str(),"-1");
+    NXT_CHECK_STR(intStr(lcd,-65536).c_str(),"-65536");
+    NXT_CHECK_STR(intStr(lcd,2147483647L).c_str(),"2147483647");
+    NXT_CHECK_STR(intStr(lcd,(int32_t)0x80000000UL).c_str(),"-2147483648");
+}
+
+
+NXT_TEST(pieces){
+    NxtEmu emu;
+    NxtLcd lcd(&emu);
+    A::cmdStart(lcd);
+    A::cmdObj(lcd,2,13);
+    A::cmdStr(lcd,".val=");
+    A::cmdInt(lcd,-40);
+    A::cmdEnd(lcd);
+    NXT_CHECK_EQ(A::cmdOvfl(lcd),0);
+    NXT_CHECK_EQ(A::sendLen(lcd),strlen("p[2].b[13].val=-40") + 3);
+    NXT_CHECK_STR(A::cmd(lcd).c_str(),"p[2].b[13].val=-40");
+    uint8_t* buf = A::sendBuf(lcd);
+    uint16_t len = A::sendLen(lcd);
+    NXT_CHECK(buf[len - 1] == 0xFF && buf[len - 2] == 0xFF && buf[len - 3] == 0xFF);
+    A::cmdStart(lcd);
+    NXT_CHECK_EQ(A::sendLen(lcd),0);
+}
+
+
+/*
+ * a command that does not fit is never sent, not even truncated
+ */
+NXT_TEST(overflow){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,1);
+    std::string fill(NXT_BUF_SIZE - 5,'a');
+    A::cmdStart(lcd);
+    A::cmdStr(lcd,fill.c_str());
+    A::cmdUint(lcd,123);
+    NXT_CHECK_EQ(A::cmdOvfl(lcd),0);
+    A::cmdEnd(lcd);
+    NXT_CHECK_EQ(A::cmdOvfl(lcd),1);        // 3 bytes of terminator don't fit
+    A::cmdStart(lcd);
+    A::cmdStr(lcd,fill.c_str());
+    A::cmdUint(lcd,1234567);
+    NXT_CHECK_EQ(A::cmdOvfl(lcd),1);
+    emu.settle();
+    emu.bytesIn = 0;
+    std::string text(NXT_BUF_SIZE,'x');
+    NXT_CHECK_EQ(lcd.setString(3,text.c_str()),dataTooBig);
+    NXT_CHECK_EQ(emu.bytesIn,0);
+    NXT_CHECK_EQ(emu.available(),0);
+}
+
+
+/*
+ * the commands reach the display as built
+ */
+NXT_TEST(setters){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,1);
+    lcd.setNumeric(3,-5);
+    NXT_CHECK_STR(nxtLast(emu),"b[3].val=-5");
+    lcd.setNumeric(1,2,2147483647L);
+    NXT_CHECK_STR(nxtLast(emu),"p[1].b[2].val=2147483647");
+    lcd.drawLine(0,1,479,271,65535);
+    NXT_CHECK_STR(nxtLast(emu),"line 0,1,479,271,65535");
+}
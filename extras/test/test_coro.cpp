@@ -0,0 +1,158 @@
+/* test_coro.cpp
+ *
+ * Host tests of the coroutine front-end (nxt_coro.h): gets and delays, resumes only
+ * from run(), limit of suspended coroutines. Built with -std=gnu++20, see
+ * CMakeLists.txt.
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+#define SLOTS       4           // request slots given to setReqSlots()
+#include "nxt_coro.h"
+
+static uint8_t inRun;           // set while sched.run() is running
+static uint8_t outside;         // coroutines resumed out of run()
+static uint8_t finished;
+
+
+static void runAll(NxtCoSched& sched){
+    for(int i = 0; i < 10000 && sched.pending() > 0; i++){
+        inRun = 1;
+        sched.run();
+        inRun = 0;
+        hostAdvance(100000);
+    }
+}
+
+
+static NxtCoTask getter(NxtCoSched& sched, uint8_t id, int32_t* v, uint8_t* res){
+    *res = co_await nxtGetNumeric(sched,0,id,v);
+    if(inRun == 0) outside++;
+    finished++;
+}
+
+
+NXT_TEST(getValue){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    nxtReq_t slots[SLOTS];
+    lcd.setReqSlots(slots,SLOTS);
+    NxtCoSched sched(&lcd);
+    emu.setNum("0.3.val",1234);
+    int32_t v = 0;
+    uint8_t res = noReply;
+    finished = 0;
+    getter(sched,3,&v,&res);
+    NXT_CHECK_EQ(sched.pending(),1);
+    runAll(sched);
+    NXT_CHECK_EQ(finished,1);
+    NXT_CHECK_EQ(res,replyCmdOk);
+    NXT_CHECK_EQ(v,1234);
+}
+
+
+/*
+ * more gets than request slots: issuing one wait for the replies of the older ones,
+ * that are parsed inside the await; they must be resumed later by run(), not there
+ */
+NXT_TEST(noInlineResume){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    nxtReq_t slots[SLOTS];
+    lcd.setReqSlots(slots,SLOTS);
+    NxtCoSched sched(&lcd);
+    int32_t v[NXT_CO_MAX];
+    uint8_t res[NXT_CO_MAX];
+    finished = 0;
+    outside = 0;
+    for(int i = 0; i < NXT_CO_MAX; i++){
+        emu.setNum("0." + std::to_string(i + 1) + ".val",100 + i);
+        getter(sched,i + 1,&v[i],&res[i]);
+    }
+    NXT_CHECK(NXT_CO_MAX > SLOTS);
+    NXT_CHECK_EQ(finished,0);
+    runAll(sched);
+    NXT_CHECK_EQ(finished,NXT_CO_MAX);
+    NXT_CHECK_EQ(outside,0);
+    for(int i = 0; i < NXT_CO_MAX; i++){
+        NXT_CHECK_EQ(res[i],replyCmdOk);
+        NXT_CHECK_EQ(v[i],100 + i);
+    }
+}
+
+
+/*
+ * with NXT_CO_MAX suspended a further await is refused at once
+ */
+static NxtCoTask sleeper(NxtCoSched& sched, uint32_t ms, uint8_t* res, uint32_t* at){
+    *res = co_await nxtDelay(sched,ms);
+    *at = millis();
+    finished++;
+}
+
+NXT_TEST(limit){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    nxtReq_t slots[SLOTS];
+    lcd.setReqSlots(slots,SLOTS);
+    NxtCoSched sched(&lcd);
+    uint8_t res[NXT_CO_MAX + 2];
+    uint32_t at[NXT_CO_MAX + 2];
+    int32_t v;
+    finished = 0;
+    uint32_t start = millis();
+    for(int i = 0; i < NXT_CO_MAX; i++) sleeper(sched,50,&res[i],&at[i]);
+    NXT_CHECK_EQ(sched.pending(),NXT_CO_MAX);
+    sleeper(sched,50,&res[NXT_CO_MAX],&at[NXT_CO_MAX]);
+    NXT_CHECK_EQ(finished,1);
+    NXT_CHECK_EQ(res[NXT_CO_MAX],dataTooBig);
+    getter(sched,1,&v,&res[NXT_CO_MAX + 1]);
+    NXT_CHECK_EQ(finished,2);
+    NXT_CHECK_EQ(res[NXT_CO_MAX + 1],dataTooBig);
+    NXT_CHECK_EQ(sched.pending(),NXT_CO_MAX);
+    runAll(sched);
+    NXT_CHECK_EQ(finished,NXT_CO_MAX + 2);
+    for(int i = 0; i < NXT_CO_MAX; i++){
+        NXT_CHECK_EQ(res[i],replyCmdOk);
+        NXT_CHECK(at[i] - start >= 50);
+    }
+}
+
+
+/*
+ * sleepers and getters mixed, resumed in time
+ */
+static NxtCoTask loopFlow(NxtCoSched& sched, uint8_t id, int n, uint32_t* cnt){
+    int32_t v;
+    for(int i = 0; i < n; i++){
+        if(co_await nxtGetNumeric(sched,0,id,&v) == replyCmdOk && v == id) (*cnt)++;
+        co_await nxtDelay(sched,10);
+    }
+    finished++;
+}
+
+NXT_TEST(mixed){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    nxtReq_t slots[SLOTS];
+    lcd.setReqSlots(slots,SLOTS);
+    NxtCoSched sched(&lcd);
+    uint32_t cnt = 0;
+    finished = 0;
+    for(int i = 1; i <= 5; i++){
+        emu.setNum("0." + std::to_string(i) + ".val",i);
+        loopFlow(sched,i,20,&cnt);
+    }
+    uint32_t start = millis();
+    runAll(sched);
+    NXT_CHECK_EQ(finished,5);
+    NXT_CHECK_EQ(cnt,100);
+    NXT_CHECK(millis() - start >= 200);
+}
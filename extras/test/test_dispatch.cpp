@@ -0,0 +1,214 @@
+/* test_dispatch.cpp
+ *
+ * Host tests of the event handlers (dispatch.cpp): table order, press/release masks,
+ * filtering at parse time, event types
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+struct Seen{
+    int         calls = 0;
+    nxtEvent_t  last;
+};
+
+static void record(nxtEvent_t* ev, void* ctx){
+    Seen* s = (Seen*)ctx;
+    s->calls++;
+    s->last = *ev;
+}
+
+
+/*
+ * handlers registered in any order are all found
+ */
+NXT_TEST(sortedTable){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtHandler_t table[16];
+    Seen seen[10];
+    lcd.init(115200,1,0,1);
+    lcd.setHandlers(table,16);
+    const uint8_t comps[10] = {40, 3, 250, 17, 1, 99, 18, 0, 200, 5};
+    for(int i = 0; i < 10; i++){
+        NXT_CHECK_EQ(lcd.onTouch(i % 3,comps[i],NXT_EV_PRESS,record,&seen[i]),replyCmdOk);
+    }
+    for(int i = 9; i >= 0; i--){
+        emu.touch(i % 3,comps[i],1);
+        emu.settle();
+        NXT_CHECK_EQ(lcd.dispatch(),1);
+        NXT_CHECK_EQ(seen[i].calls,1);
+        NXT_CHECK_EQ(seen[i].last.compId_Y,comps[i]);
+        NXT_CHECK_EQ(seen[i].last.page_X,i % 3);
+    }
+    emu.touch(2,3,1);          // comps[1] is on page 1, not on this one
+    emu.settle();
+    NXT_CHECK_EQ(lcd.dispatch(),0);
+}
+
+
+NXT_TEST(pressRelease){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtHandler_t table[4];
+    Seen press, both;
+    lcd.init(115200,1,0,1);
+    lcd.setHandlers(table,4);
+    lcd.onTouch(0,10,NXT_EV_PRESS,record,&press);
+    lcd.onTouch(0,11,NXT_EV_BOTH,record,&both);
+    emu.touch(0,10,1);
+    emu.touch(0,10,0);
+    emu.touch(0,11,1);
+    emu.touch(0,11,0);
+    emu.settle();
+    NXT_CHECK_EQ(lcd.dispatch(),3);
+    NXT_CHECK_EQ(press.calls,1);
+    NXT_CHECK_EQ(press.last.event,1);
+    NXT_CHECK_EQ(both.calls,2);
+    NXT_CHECK_EQ(both.last.event,0);
+}
+
+
+/*
+ * in filter mode events without handler are dropped when parsed, they don't take
+ * room in the queue
+ */
+NXT_TEST(filter){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtHandler_t table[4];
+    Seen seen;
+    lcd.init(115200,1,0,1);
+    lcd.setHandlers(table,4);
+    lcd.onTouch(0,10,NXT_EV_BOTH,record,&seen);
+    for(int i = 0; i < NXT_EV_QUEUE_SIZE * 2; i++) emu.touch(0,20,1);
+    emu.touch(0,10,1);
+    emu.settle();
+    NXT_CHECK_EQ(lcd.dispatch(),1);
+    NXT_CHECK_EQ(seen.calls,1);
+    NXT_CHECK_EQ(lcd.getEvFiltered(),NXT_EV_QUEUE_SIZE * 2);
+}
+
+
+/*
+ * without filter events without handler are returned by ckEvents(), the others go
+ * to their handler
+ */
+NXT_TEST(noFilter){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtHandler_t table[4];
+    Seen seen;
+    lcd.init(115200,1,0,1);
+    lcd.setHandlers(table,4,0);
+    lcd.onTouch(0,10,NXT_EV_BOTH,record,&seen);
+    emu.touch(0,20,1);
+    emu.touch(0,10,1);
+    emu.touch(0,21,0);
+    emu.settle();
+    nxtEvent_t ev;
+    NXT_CHECK_EQ(lcd.ckEvents(&ev),1);
+    NXT_CHECK_EQ(ev.compId_Y,20);
+    NXT_CHECK_EQ(lcd.ckEvents(&ev),1);
+    NXT_CHECK_EQ(ev.compId_Y,21);
+    NXT_CHECK_EQ(lcd.ckEvents(&ev),0);
+    NXT_CHECK_EQ(seen.calls,1);
+    NXT_CHECK_EQ(lcd.getEvFiltered(),0);
+}
+
+
+NXT_TEST(eventTypes){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtHandler_t table[4];
+    Seen xy, sleep, wake;
+    lcd.init(115200,1,0,1);
+    lcd.setHandlers(table,4);
+    NXT_CHECK_EQ(lcd.onEvent(cmdTouchCompEv,record,&xy),invalidData);
+    lcd.onEvent(cmdTouchXYaw,record,&xy);
+    lcd.onEvent(cmdSleepOn,record,&sleep);
+    lcd.onEvent(cmdSleepOff,record,&wake);
+    emu.touchXY(300,200,1);
+    const uint8_t on[4] = {0x86,0xFF,0xFF,0xFF};
+    const uint8_t off[4] = {0x87,0xFF,0xFF,0xFF};
+    emu.send(on,4);
+    emu.send(off,4);
+    emu.settle();
+    NXT_CHECK_EQ(lcd.dispatch(),3);
+    NXT_CHECK_EQ(xy.calls,1);
+    NXT_CHECK_EQ(xy.last.page_X,300);
+    NXT_CHECK_EQ(xy.last.compId_Y,200);
+    NXT_CHECK_EQ(sleep.calls,1);
+    NXT_CHECK_EQ(wake.calls,1);
+}
+
+
+/*
+ * removing a handler, with events of it still queued
+ */
+NXT_TEST(remove){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtHandler_t table[4];
+    Seen a, b;
+    lcd.init(115200,1,0,1);
+    lcd.setHandlers(table,4,0);
+    lcd.onTouch(0,1,NXT_EV_BOTH,record,&a);
+    lcd.onTouch(0,2,NXT_EV_BOTH,record,&b);
+    emu.touch(0,1,1);
+    emu.touch(0,2,1);
+    emu.settle();
+    lcd.poll();
+    NXT_CHECK_EQ(lcd.onTouch(0,1,NXT_EV_BOTH,NULL),replyCmdOk);
+    NXT_CHECK_EQ(lcd.onTouch(0,1,NXT_EV_BOTH,NULL),invalidData);
+    NXT_CHECK_EQ(lcd.dispatch(),1);
+    NXT_CHECK_EQ(a.calls,0);
+    NXT_CHECK_EQ(b.calls,1);
+}
+
+
+/*
+ * table full
+ */
+NXT_TEST(tableFull){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtHandler_t table[2];
+    Seen s;
+    lcd.init(115200,1,0,1);
+    NXT_CHECK_EQ(lcd.onTouch(0,1,NXT_EV_BOTH,record,&s),notSupported);
+    lcd.setHandlers(table,2);
+    lcd.onTouch(0,1,NXT_EV_BOTH,record,&s);
+    lcd.onTouch(0,2,NXT_EV_BOTH,record,&s);
+    NXT_CHECK_EQ(lcd.onTouch(0,3,NXT_EV_BOTH,record,&s),dataTooBig);
+    NXT_CHECK_EQ(lcd.onTouch(0,2,NXT_EV_PRESS,record,&s),replyCmdOk);     // update
+}
+
+
+/*
+ * a handler can send commands, the events following are not lost
+ */
+static void echo(nxtEvent_t* ev, void* ctx){
+    NxtLcd* lcd = (NxtLcd*)ctx;
+    lcd->setNumeric(ev->compId_Y + 100,ev->compId_Y);
+}
+
+NXT_TEST(handlerSends){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtHandler_t table[4];
+    lcd.init(115200,1,0,1);
+    lcd.setHandlers(table,4);
+    lcd.onTouch(0,1,NXT_EV_PRESS,echo,&lcd);
+    lcd.onTouch(0,2,NXT_EV_PRESS,echo,&lcd);
+    emu.touch(0,1,1);
+    emu.touch(0,2,1);
+    emu.settle();
+    NXT_CHECK_EQ(lcd.dispatch(),2);
+    emu.settle();
+    NXT_CHECK_EQ(emu.num("0.101.val"),1);
+    NXT_CHECK_EQ(emu.num("0.102.val"),2);
+}
@@ -0,0 +1,143 @@
+/* test_emu.cpp
+ *
+ * Host tests of the display emulator (link timing, panel buffer, replies) and of the
+ * library running on it
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+static const uint8_t sendme[] = {'s','e','n','d','m','e',0xFF,0xFF,0xFF};
+
+
+/*
+ * a 9 bytes command and its 5 bytes reply take 14 byte times, plus the execution
+ */
+NXT_TEST(byteTime){
+    NxtEmu emu(9600);
+    emu.write(sendme,sizeof(sendme));
+    uint64_t start = hostNow();
+    while(emu.available() < 5) hostAdvance(1000);
+    uint64_t us = (hostNow() - start) / 1000;
+    uint64_t exp = 14 * 10000000ULL / 9600 + emu.cmdNs / 1000;
+    NXT_CHECK(us >= exp && us <= exp + 2);
+    NXT_CHECK_EQ(emu.read(),0x66);
+    NXT_CHECK_EQ(emu.read(),0x00);
+}
+
+
+/*
+ * write() return when the bytes are in the UART FIFO
+ */
+NXT_TEST(writeBlocks){
+    NxtEmu emu(9600);
+    uint8_t buf[200];
+    memset(buf,'a',sizeof(buf));
+    NXT_CHECK_EQ(emu.availableForWrite(),64);
+    emu.write(buf,sizeof(buf));
+    uint64_t us = hostNow() / 1000;
+    uint64_t exp = (200 - 64) * 10000000ULL / 9600;
+    NXT_CHECK(us + 2 >= exp && us <= exp + 2);
+    NXT_CHECK_EQ(emu.availableForWrite(),0);
+}
+
+
+/*
+ * commands sent faster than they are executed fill the panel buffer, then 0x24
+ */
+NXT_TEST(bufferOverflow){
+    NxtEmu emu(921600);
+    emu.drawNs = 5000000;
+    const uint8_t cmd[] = {'c','l','s',' ','0',0xFF,0xFF,0xFF};
+    for(int i = 0; i < 200; i++) emu.write(cmd,sizeof(cmd));
+    emu.settle();
+    NXT_CHECK_EQ(emu.maxFill,emu.bufSize);
+    NXT_CHECK(emu.overflows >= 1);
+    NXT_CHECK(emu.lost > 0);
+    NXT_CHECK(emu.log.size() < 200);
+    NXT_CHECK_EQ(emu.read(),0x24);
+}
+
+
+/*
+ * replies follow bkcmd
+ */
+NXT_TEST(bkcmdReplies){
+    NxtEmu emu(115200);
+    const uint8_t ok[] = {'d','i','m','=','5','0',0xFF,0xFF,0xFF};
+    const uint8_t bad[] = {'f','o','o',0xFF,0xFF,0xFF};
+    emu.write(ok,sizeof(ok));
+    emu.write(bad,sizeof(bad));
+    emu.settle();
+    NXT_CHECK_EQ(emu.num("dim"),50);
+    NXT_CHECK_EQ(emu.available(),4);
+    NXT_CHECK_EQ(emu.read(),0x00);
+    while(emu.available() > 0) emu.read();
+    emu.bkcmd = 1;
+    emu.write(ok,sizeof(ok));
+    emu.write(bad,sizeof(bad));
+    emu.settle();
+    NXT_CHECK_EQ(emu.available(),4);
+    NXT_CHECK_EQ(emu.read(),0x01);
+    while(emu.available() > 0) emu.read();
+    NXT_CHECK_EQ(emu.log.size(),4);
+    emu.bkcmd = 3;
+    emu.write(ok,sizeof(ok));
+    emu.settle();
+    NXT_CHECK_EQ(emu.read(),0x01);
+}
+
+
+/*
+ * bytes sent at the wrong rate are lost
+ */
+NXT_TEST(baudMismatch){
+    NxtEmu emu(115200);
+    emu.begin(9600);
+    emu.write(sendme,sizeof(sendme));
+    emu.settle();
+    NXT_CHECK_EQ(emu.available(),0);
+    NXT_CHECK_EQ(emu.lost,sizeof(sendme));
+}
+
+
+/*
+ * the library on the emulator: reset, write and read back
+ */
+NXT_TEST(libInit){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    NXT_CHECK_EQ(lcd.init(115200,1,1,1),replyCmdOk);
+    NXT_CHECK_EQ(emu.restarts,1);
+    uint16_t resetMs, propMs;
+    lcd.getInitTimes(&resetMs,&propMs);
+    NXT_CHECK(resetMs >= emu.bootNs / 1000000);
+    NXT_CHECK_EQ(lcd.setNumeric(3,-42),replyCmdOk);
+    NXT_CHECK_STR(nxtLast(emu),"b[3].val=-42");
+    NXT_CHECK_EQ(emu.num("0.3.val"),-42);
+    int32_t v = 0;
+    NXT_CHECK_EQ(lcd.getNumeric(3,&v,sizeof(v)),replyCmdOk);
+    NXT_CHECK_EQ(v,-42);
+    NXT_CHECK_EQ(lcd.setString(0,2,"hello"),replyCmdOk);
+    char s[8];
+    NXT_CHECK_EQ(lcd.getString(0,2,s,sizeof(s)),replyCmdOk);
+    NXT_CHECK_STR(s,"hello");
+    NXT_CHECK_EQ(lcd.setNumeric("nope",1),replyWrongId);
+}
+
+
+/*
+ * a restart requested by the panel is seen by the library as startup + ready
+ */
+NXT_TEST(panelRestart){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,1);
+    emu.restart();
+    hostAdvance(emu.bootNs + 1000000);
+    lcd.poll();
+    NXT_CHECK_EQ(emu.available(),0);
+    NXT_CHECK_EQ(emu.bkcmd,2);
+}
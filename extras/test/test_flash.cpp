@@ -0,0 +1,96 @@
+/* test_flash.cpp
+ *
+ * Host tests of the AVR code paths, names and strings given with the F() macro; the
+ * library is built with ARDUINO_ARCH_AVR (see CMakeLists.txt)
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+NXT_TEST(flashStrings){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    emu.addObj(0,5,"temperature");
+    lcd.init(115200,1,0,1);
+    NXT_CHECK_EQ(lcd.setNumeric(F("temperature"),7),replyCmdOk);
+    NXT_CHECK_STR(nxtLast(emu),"temperature.val=7");
+    NXT_CHECK_EQ(lcd.setString(F("temperature"),F("abc")),replyCmdOk);
+    NXT_CHECK_STR(nxtLast(emu),"temperature.txt=\"abc\"");
+}
+
+
+/*
+ * F() names go through the resolver as the RAM ones
+ */
+NXT_TEST(flashResolved){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtName_t names[8];
+    nxtNameLearn_t learn;
+    emu.addPage(2,"setup");
+    emu.addObj(0,5,"temperature");
+    emu.addObj(2,7,"speed");
+    lcd.init(115200,1,0,1);
+    lcd.setResolver(names,8,&learn);
+    lcd.addPageId("setup",2);
+    lcd.setNumeric(F("temperature"),1);
+    lcd.poll();
+    lcd.setNumeric(F("temperature"),2);
+    NXT_CHECK_STR(nxtLast(emu),"b[5].val=2");
+    lcd.setNumeric(F("setup"),F("speed"),3);
+    lcd.poll();
+    lcd.setNumeric(F("setup"),F("speed"),4);
+    NXT_CHECK_STR(nxtLast(emu),"p[2].b[7].val=4");
+    NXT_CHECK_EQ(emu.num("2.7.val"),4);
+}
+
+
+/*
+ * handles bound to F() names too
+ */
+NXT_TEST(flashHandles){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtName_t names[8];
+    nxtNameLearn_t learn;
+    emu.addPage(2,"setup");
+    emu.addObj(0,5,"temperature");
+    emu.addObj(2,7,"speed");
+    lcd.init(115200,1,0,1);
+    lcd.setResolver(names,8,&learn);
+    lcd.addPageId("setup",2);
+    NxtNumber temp(lcd,F("temperature"));
+    NxtNumber speed(lcd,F("setup.speed"));
+    temp.set(1);
+    lcd.poll();
+    speed.set(2);
+    lcd.poll();
+    temp.set(3);
+    NXT_CHECK_STR(nxtLast(emu),"b[5].val=3");
+    speed.set(4);
+    NXT_CHECK_STR(nxtLast(emu),"p[2].b[7].val=4");
+    NXT_CHECK(lcd.getNameSaved() > 0);
+}
+
+
+/*
+ * a page set with a F() name is learned by the resolver
+ */
+NXT_TEST(flashPageLearned){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtName_t names[8];
+    nxtNameLearn_t learn;
+    emu.addPage(2,"setup");
+    emu.addObj(2,7,"speed");
+    lcd.init(115200,1,0,1);
+    lcd.setResolver(names,8,&learn);
+    NXT_CHECK_EQ(lcd.setPageS(F("setup")),replyCmdOk);
+    lcd.setNumeric(F("setup"),F("speed"),3);
+    lcd.poll();
+    lcd.setNumeric(F("setup"),F("speed"),4);
+    NXT_CHECK_STR(nxtLast(emu),"p[2].b[7].val=4");
+}
@@ -0,0 +1,113 @@
+/* test_flow.cpp
+ *
+ * Host tests of the flow controller (any_serial.cpp): credits freed by the replies,
+ * no overflow of the display buffer under load
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+static uint16_t flowUsed(NxtLcd& lcd){
+    uint16_t used, ovfl;
+    lcd.getFlowStats(&used,&ovfl);
+    return used;
+}
+
+
+/*
+ * a reply to the last command written: nothing is left in the display buffer
+ */
+NXT_TEST(lastReply){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    lcd.setFlowControl(1);
+    for(int i = 0; i < 10; i++) lcd.setNumeric(i + 1,i);
+    NXT_CHECK(flowUsed(lcd) > 0);
+    uint16_t v;
+    NXT_CHECK_EQ(lcd.getProperty(nxt_dim,&v),replyCmdOk);
+    NXT_CHECK_EQ(flowUsed(lcd),0);
+}
+
+
+/*
+ * a reply to an older command free only the bytes up to it: the commands written
+ * after it are still counted
+ */
+NXT_TEST(olderReply){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    lcd.setBkcmd(3);
+    lcd.setFlowControl(1);
+    emu.settle();
+    lcd.poll();
+    emu.cmdNs = 5000000;
+    for(int i = 0; i < 20; i++) lcd.setNumeric(i + 1,i);
+    uint16_t sent = flowUsed(lcd);
+    NXT_CHECK(sent > 150);
+    hostAdvance(7000000);           // the first reply only
+    lcd.poll();
+    uint16_t used = flowUsed(lcd);
+    NXT_CHECK(used > 100);
+    NXT_CHECK(used < sent);
+    emu.settle();
+    lcd.poll();
+    NXT_CHECK_EQ(flowUsed(lcd),0);
+}
+
+
+/*
+ * bkcmd=2: the error of a set, never marked, must not complete the mark of a get
+ * written after it and still to be executed
+ */
+NXT_TEST(errorNotAnswer){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    nxtReq_t slots[4];
+    lcd.init(9600,1,0,0);
+    lcd.setReqSlots(slots,4);
+    lcd.setBkcmd(2);
+    lcd.setFlowControl(1);
+    emu.settle();
+    lcd.poll();
+    emu.cmdNs = 5000000;
+    lcd.setNumeric("nosuch",1);
+    int32_t v = 0;
+    uint8_t h;
+    NXT_CHECK_EQ(lcd.getNumericAsync(5,&v,sizeof(v),&h),replyCmdOk);
+    NXT_CHECK(flowUsed(lcd) > 25);
+    hostAdvance(26000000);          // the error reply only
+    NXT_CHECK_EQ(emu.available(),4);
+    lcd.poll();
+    NXT_CHECK(flowUsed(lcd) > 10);
+    emu.settle();
+    lcd.poll();
+    NXT_CHECK_EQ(flowUsed(lcd),0);
+}
+
+
+/*
+ * a slow display at a high rate, bkcmd=3: the replies arriving while writing must not
+ * free the bytes sent after them. The estimated rate start at half the wire speed,
+ * faster than this display, so a few 0x24 are needed to slow it down
+ */
+NXT_TEST(noOverflow){
+    NxtEmu emu(921600);
+    NxtLcd lcd(&emu);
+    lcd.init(921600,1,0,0);
+    lcd.setBkcmd(3);
+    lcd.setFlowControl(1);
+    emu.cmdNs = 400000;
+    for(int i = 0; i < 400; i++) lcd.setNumeric(i % 50 + 1,i);
+    emu.settle();
+    lcd.poll();
+    NXT_CHECK(emu.overflows < 10);
+    for(int i = 0; i < 50; i++) NXT_CHECK_EQ(emu.num("0." + std::to_string(i + 1) + ".val"),350 + i);
+    uint16_t used, ovfl;
+    lcd.getFlowStats(&used,&ovfl);
+    NXT_CHECK_EQ(ovfl,emu.overflows);
+}
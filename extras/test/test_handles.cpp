@@ -0,0 +1,112 @@
+/* test_handles.cpp
+ *
+ * Host tests of the component handles (handles.cpp): addresses encoded in the
+ * handle, range checks, bytes sent
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+/*
+ * sent() - the command executed by the panel, checking that it took exactly its
+ * bytes and the terminator
+ */
+static std::string sent(NxtEmu& emu, uint32_t* from){
+    std::string cmd = nxtLast(emu);
+    NXT_CHECK_EQ(emu.bytesIn - *from,cmd.size() + 3);
+    *from = emu.bytesIn;
+    return cmd;
+}
+
+
+NXT_TEST(idAddresses){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    emu.settle();
+    uint32_t from = emu.bytesIn;
+    const uint8_t ids[] = {0, 7, 10, 99, 100, 255};
+    for(size_t i = 0; i < sizeof(ids); i++){
+        NxtNumber a(lcd,ids[i],ids[sizeof(ids) - 1 - i]);
+        NXT_CHECK_EQ(a.set(-12),replyCmdOk);
+        std::string want = "p[" + std::to_string(ids[i]) + "].b[" +
+                           std::to_string(ids[sizeof(ids) - 1 - i]) + "].val=-12";
+        NXT_CHECK_STR(sent(emu,&from).c_str(),want.c_str());
+        NxtNumber b(lcd,ids[i]);
+        NXT_CHECK_EQ(b.set(100000),replyCmdOk);
+        want = "b[" + std::to_string(ids[i]) + "].val=100000";
+        NXT_CHECK_STR(sent(emu,&from).c_str(),want.c_str());
+    }
+}
+
+
+NXT_TEST(names){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    emu.addObj(0,4,"t0");
+    lcd.init(115200,1,0,0);
+    emu.settle();
+    uint32_t from = emu.bytesIn;
+    NxtText t(lcd,"t0");
+    NXT_CHECK_EQ(t.set("hello"),replyCmdOk);
+    NXT_CHECK_STR(sent(emu,&from).c_str(),"t0.txt=\"hello\"");
+    NXT_CHECK_STR(emu.str("0.4.txt").c_str(),"hello");
+}
+
+
+NXT_TEST(gaugeRange){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    emu.settle();
+    uint32_t from = emu.bytesIn;
+    NxtGauge g(lcd,1,2);
+    NXT_CHECK_EQ(g.set(360),replyCmdOk);
+    NXT_CHECK_STR(sent(emu,&from).c_str(),"p[1].b[2].val=360");
+    NXT_CHECK_EQ(g.set(361),invalidData);
+    NXT_CHECK_EQ(g.set(0xFFFF),invalidData);
+    emu.settle();
+    NXT_CHECK_EQ(emu.bytesIn,from);
+}
+
+
+NXT_TEST(wave){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    emu.settle();
+    uint32_t from = emu.bytesIn;
+    NxtWave w(lcd,1,3);
+    NXT_CHECK_EQ(w.add(200),replyCmdOk);
+    NXT_CHECK_STR(sent(emu,&from).c_str(),"add 1,3,200");
+    NxtWave big(lcd,123,0);
+    NXT_CHECK_EQ(big.add(0),replyCmdOk);
+    NXT_CHECK_STR(sent(emu,&from).c_str(),"add 123,0,0");
+    NXT_CHECK_EQ(emu.waves[4 + 3].size(),1);
+    NxtWave bad(lcd,1,4);
+    NXT_CHECK_EQ(bad.add(1),invalidData);
+    NxtWave bad2(lcd,1,255);
+    NXT_CHECK_EQ(bad2.add(1),invalidData);
+    emu.settle();
+    NXT_CHECK_EQ(emu.bytesIn,from);
+}
+
+
+NXT_TEST(attributes){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    emu.settle();
+    uint32_t from = emu.bytesIn;
+    NxtHandle h(lcd,0,12);
+    NXT_CHECK_EQ(h.setAttr("pic",65535),replyCmdOk);
+    NXT_CHECK_STR(sent(emu,&from).c_str(),"p[0].b[12].pic=65535");
+    NXT_CHECK_EQ(h.setBackColor(63488),replyCmdOk);
+    NXT_CHECK_STR(sent(emu,&from).c_str(),"p[0].b[12].bco=63488");
+    NXT_CHECK_EQ(h.setForeColor(31),replyCmdOk);
+    NXT_CHECK_STR(sent(emu,&from).c_str(),"p[0].b[12].pco=31");
+    NXT_CHECK_EQ(emu.num("0.12.bco"),63488);
+}
@@ -0,0 +1,160 @@
+/* test_journal.cpp
+ *
+ * Host tests of the handling of a display restart: journal replay, link rate and
+ * pipeline mode set again
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+// let the display boot and the library see it
+static void reboot(NxtEmu& emu, NxtLcd& lcd){
+    emu.restart();
+    hostAdvance(emu.bootNs + 1000000);
+    lcd.poll();
+    emu.settle();
+}
+
+
+NXT_TEST(replay){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    uint8_t pool[128];
+    lcd.init(115200,1,0,0);
+    lcd.setJournal(pool,sizeof(pool));
+    lcd.setObjAttr(0,3,"val",25);
+    reboot(emu,lcd);
+    NXT_CHECK_EQ(emu.restarts,1);
+    NXT_CHECK_EQ(emu.num("0.3.val"),25);
+    uint16_t used, replays;
+    lcd.getJournalStats(&used,&replays);
+    NXT_CHECK_EQ(replays,1);
+    uint16_t dp = 9;
+    NXT_CHECK_EQ(lcd.getProperty(nxt_dp,&dp,1),replyCmdOk);
+    NXT_CHECK_EQ(dp,0);
+}
+
+
+/*
+ * in pipeline mode bkcmd=3 is set again, and the replayed commands are matched
+ */
+NXT_TEST(pipeline){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    uint8_t pool[128];
+    lcd.init(115200,1,0,0);
+    lcd.setJournal(pool,sizeof(pool));
+    lcd.setBkcmd(1);
+    NXT_CHECK_EQ(lcd.setPipeline(1),replyCmdOk);
+    lcd.setObjAttr(0,3,"val",25);
+    lcd.pipeFlush();
+    reboot(emu,lcd);
+    NXT_CHECK_EQ(emu.num("bkcmd"),3);
+    NXT_CHECK_EQ(lcd.pipeFlush(),replyCmdOk);
+    NXT_CHECK_EQ(emu.num("0.3.val"),25);
+    lcd.setObjAttr(0,3,"val",26);
+    NXT_CHECK_EQ(lcd.pipeFlush(),replyCmdOk);
+    NXT_CHECK_EQ(lcd.setPipeline(0),replyCmdOk);
+    emu.settle();
+    NXT_CHECK_EQ(emu.num("bkcmd"),1);       // the value before the pipeline
+}
+
+
+/*
+ * without a journal the link is set up again all the same
+ */
+NXT_TEST(noJournal){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    lcd.setPipeline(1);
+    reboot(emu,lcd);
+    NXT_CHECK_EQ(emu.num("bkcmd"),3);
+}
+
+
+/*
+ * a rate set at runtime: the restart telegrams can't be read, the missing reply make
+ * poll() find the display at its startup rate and set the runtime one again
+ */
+NXT_TEST(runtimeBaud){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    uint8_t pool[128];
+    lcd.init(9600,1,0,0);
+    lcd.setJournal(pool,sizeof(pool));
+    NXT_CHECK_EQ(lcd.setBaud(115200),replyCmdOk);
+    lcd.setPipeline(1);
+    lcd.setObjAttr(0,3,"val",25);
+    lcd.pipeFlush();
+    reboot(emu,lcd);
+    NXT_CHECK_EQ(emu.baud,9600);
+    lcd.setObjAttr(0,2,"val",1);
+    NXT_CHECK(lcd.pipeFlush() != replyCmdOk);
+    lcd.poll();
+    emu.settle();
+    NXT_CHECK_EQ(lcd.getBaud(),115200);
+    NXT_CHECK_EQ(emu.baud,115200);
+    NXT_CHECK_EQ(emu.num("bkcmd"),3);
+    NXT_CHECK_EQ(lcd.pipeFlush(),replyCmdOk);
+    NXT_CHECK_EQ(emu.num("0.3.val"),25);
+    lcd.setObjAttr(0,2,"val",1);
+    NXT_CHECK_EQ(lcd.pipeFlush(),replyCmdOk);
+    NXT_CHECK_EQ(emu.restarts,1);
+}
+
+
+/*
+ * a missing reply at the runtime rate, without a restart, only check the link
+ */
+NXT_TEST(runtimeBaudNoRestart){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    lcd.init(9600,1,0,0);
+    lcd.setBaud(115200);
+    emu.setCost("get b[1]",50000000);
+    int32_t v;
+    NXT_CHECK_EQ(lcd.getNumeric(1,&v,sizeof(v)),noReply);
+    hostAdvance(60000000);
+    lcd.poll();
+    NXT_CHECK_EQ(lcd.getBaud(),115200);
+    NXT_CHECK_EQ(emu.baud,115200);
+    NXT_CHECK_EQ(lcd.getNumeric(2,&v,sizeof(v)),replyCmdOk);
+}
+
+
+/*
+ * devReset() bring back the runtime rate and the pipeline mode
+ */
+NXT_TEST(devReset){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    lcd.init(9600,1,0,0);
+    lcd.setBaud(115200);
+    lcd.setPipeline(1);
+    NXT_CHECK_EQ(lcd.devReset(),replyCmdOk);
+    NXT_CHECK_EQ(emu.restarts,1);
+    NXT_CHECK_EQ(emu.baud,115200);
+    NXT_CHECK_EQ(emu.num("bkcmd"),3);
+    lcd.setObjAttr(0,2,"val",1);
+    NXT_CHECK_EQ(lcd.pipeFlush(),replyCmdOk);
+}
+
+
+/*
+ * a persisted rate is the startup one
+ */
+NXT_TEST(persistBaud){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    lcd.init(9600,1,0,0);
+    NXT_CHECK_EQ(lcd.setBaud(115200,1),replyCmdOk);
+    NXT_CHECK_EQ(emu.bauds,115200);
+    reboot(emu,lcd);
+    NXT_CHECK_EQ(lcd.getBaud(),115200);
+    int32_t v;
+    NXT_CHECK_EQ(lcd.getNumeric(2,&v,sizeof(v)),replyCmdOk);
+}
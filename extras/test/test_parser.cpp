@@ -0,0 +1,152 @@
+/* test_parser.cpp
+ *
+ * Host tests of the RX ring and of the resumable telegram parser, and of the event
+ * queue filled by it
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+/*
+ * a telegram received in pieces is parsed once, when complete
+ */
+NXT_TEST(splitTelegram){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    const uint8_t ev[] = {0x65,0x01,0x05,0x01,0xFF,0xFF,0xFF};
+    nxtEvent_t e;
+    emu.send(ev,3);
+    hostAdvance(1000000);
+    NXT_CHECK_EQ(lcd.ckEvents(&e),0);
+    emu.send(&ev[3],3);
+    hostAdvance(1000000);
+    NXT_CHECK_EQ(lcd.ckEvents(&e),0);
+    emu.send(&ev[6],1);
+    hostAdvance(1000000);
+    NXT_CHECK_EQ(lcd.ckEvents(&e),1);
+    NXT_CHECK_EQ(e.evCode,0x65);
+    NXT_CHECK_EQ(e.page_X,1);
+    NXT_CHECK_EQ(e.compId_Y,5);
+    NXT_CHECK_EQ(e.event,1);
+    NXT_CHECK_EQ(lcd.ckEvents(&e),0);
+}
+
+
+/*
+ * telegrams back to back are all parsed, in order; XY coordinates are big endian
+ */
+NXT_TEST(burst){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    emu.touch(0,2,1);
+    emu.touchXY(300,200,1);
+    emu.send((const uint8_t*)"\x86\xFF\xFF\xFF",4);
+    emu.touch(0,2,0);
+    hostAdvance(5000000);
+    nxtEvent_t e;
+    NXT_CHECK_EQ(lcd.ckEvents(&e),1);
+    NXT_CHECK(e.evCode == 0x65 && e.compId_Y == 2 && e.event == 1);
+    NXT_CHECK_EQ(lcd.ckEvents(&e),1);
+    NXT_CHECK(e.evCode == 0x67 && e.page_X == 300 && e.compId_Y == 200);
+    NXT_CHECK_EQ(lcd.ckEvents(&e),1);
+    NXT_CHECK_EQ(e.evCode,0x86);
+    NXT_CHECK_EQ(lcd.ckEvents(&e),1);
+    NXT_CHECK(e.evCode == 0x65 && e.event == 0);
+    NXT_CHECK_EQ(lcd.ckEvents(&e),0);
+}
+
+
+/*
+ * 0xFF inside a fixed length telegram is data, not the end marker
+ */
+NXT_TEST(ffInData){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    emu.touchXY(0xFF,0xFFFF,1);
+    hostAdvance(2000000);
+    nxtEvent_t e;
+    NXT_CHECK_EQ(lcd.ckEvents(&e),1);
+    NXT_CHECK_EQ(e.page_X,0xFF);
+    NXT_CHECK_EQ(e.compId_Y,0xFFFF);
+}
+
+
+/*
+ * an unknown telegram is skipped, the next one is parsed
+ */
+NXT_TEST(unknownTelegram){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    emu.send((const uint8_t*)"\x99\x01\xFF\xFF\xFF",5);
+    emu.touch(1,1,1);
+    hostAdvance(2000000);
+    nxtEvent_t e;
+    NXT_CHECK_EQ(lcd.ckEvents(&e),1);
+    NXT_CHECK_EQ(e.evCode,0x65);
+    NXT_CHECK_EQ(lcd.getWrongId(),0x99);
+}
+
+
+/*
+ * events during a get are queued, the get still get its reply
+ */
+NXT_TEST(eventDuringGet){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    emu.setNum("0.4.val",99);
+    emu.touch(0,4,1);
+    int32_t v = 0;
+    NXT_CHECK_EQ(lcd.getNumeric(4,&v,sizeof(v)),replyCmdOk);
+    NXT_CHECK_EQ(v,99);
+    nxtEvent_t e;
+    NXT_CHECK_EQ(lcd.ckEvents(&e),1);
+    NXT_CHECK_EQ(e.compId_Y,4);
+}
+
+
+/*
+ * bytes pushed by an ISR with rxPush(); the ring drop what doesn't fit
+ */
+NXT_TEST(rxPushRing){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    const uint8_t ev[] = {0x65,0x00,0x07,0x00,0xFF,0xFF,0xFF};
+    for(size_t i = 0; i < sizeof(ev); i++) NXT_CHECK_EQ(lcd.rxPush(ev[i]),1);
+    nxtEvent_t e;
+    NXT_CHECK_EQ(lcd.ckEvents(&e),1);
+    NXT_CHECK_EQ(e.compId_Y,7);
+    uint16_t pushed = 0;
+    for(int i = 0; i < NXT_RX_RING_SIZE + 10; i++) pushed += lcd.rxPush(0x01);
+    NXT_CHECK_EQ(pushed,NXT_RX_RING_SIZE - 1);
+    NXT_CHECK_EQ(lcd.getRxDropped(),11);
+}
+
+
+/*
+ * the event queue keep NXT_EV_QUEUE_SIZE events, the others are counted as dropped
+ */
+NXT_TEST(eventQueueFull){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    for(int i = 0; i < NXT_EV_QUEUE_SIZE + 2; i++) emu.touch(0,i,1);
+    hostAdvance(10000000);
+    lcd.poll();
+    NXT_CHECK_EQ(lcd.getEvDropped(),2);
+    nxtEvent_t e;
+    int n = 0;
+    while(lcd.ckEvents(&e)){
+        NXT_CHECK_EQ(e.compId_Y,n);
+        n++;
+    }
+    NXT_CHECK_EQ(n,NXT_EV_QUEUE_SIZE);
+}
@@ -0,0 +1,113 @@
+/* test_pipeline.cpp
+ *
+ * Host tests of the pipeline mode: FIFO matching of the replies to the commands in
+ * flight, error sequence numbers, and resync after a missing reply
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+static void setup(NxtEmu& emu, NxtLcd& lcd){
+    emu.addObj(0,3,"n0");
+    lcd.init(115200,1,0,0);
+    NXT_CHECK_EQ(lcd.setPipeline(1),replyCmdOk);
+    NXT_CHECK_EQ(emu.num("bkcmd"),3);
+}
+
+
+/*
+ * commands are sent back to back, more than NXT_PIPE_DEPTH of them
+ */
+NXT_TEST(backToBack){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    setup(emu,lcd);
+    emu.clearLog();
+    uint64_t start = hostNow();
+    for(int i = 0; i < 3 * NXT_PIPE_DEPTH; i++) NXT_CHECK_EQ(lcd.setNumeric(i,i),replyCmdOk);
+    NXT_CHECK_EQ(lcd.pipeFlush(),replyCmdOk);
+    NXT_CHECK_EQ(emu.log.size(),3 * NXT_PIPE_DEPTH);
+    NXT_CHECK_EQ(emu.num("0.7.val"),7);
+    // about the wire time, far less than a reply wait each
+    NXT_CHECK(hostNow() - start < 3 * NXT_PIPE_DEPTH * 2000000ULL);
+    NXT_CHECK_EQ(lcd.setPipeline(0),replyCmdOk);
+    emu.settle();
+    NXT_CHECK_EQ(emu.bkcmd,2);
+}
+
+
+/*
+ * the error is reported with the sequence number of the command that caused it
+ */
+NXT_TEST(errorSeq){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    setup(emu,lcd);
+    lcd.setNumeric(1,1);
+    lcd.setNumeric("n0",2);
+    lcd.setNumeric("x1",3);
+    uint16_t bad = lcd.getCmdSeq();
+    lcd.setNumeric("x2",4);
+    lcd.setNumeric(2,5);
+    NXT_CHECK_EQ(lcd.pipeFlush(),replyWrongId);
+    uint16_t seq = 0;
+    NXT_CHECK_EQ(lcd.getPipeErr(&seq),replyWrongId);
+    NXT_CHECK_EQ(seq,bad);
+    NXT_CHECK_EQ(lcd.getWrongId(),cmdInvalidCid);
+    NXT_CHECK_EQ(lcd.getPipeErr(&seq),replyCmdOk);
+    NXT_CHECK_EQ(emu.num("0.3.val"),2);
+}
+
+
+/*
+ * a reply arriving after the timeout is not taken as the reply of the next command
+ */
+NXT_TEST(lateReply){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    setup(emu,lcd);
+    emu.setCost("b[5]",(NXT_REPLY_WAIT + 10) * 1000000UL);
+    lcd.setNumeric(5,1);
+    uint16_t slow = lcd.getCmdSeq();
+    lcd.setNumeric("x1",2);
+    NXT_CHECK_EQ(lcd.pipeFlush(),noReply);
+    uint16_t seq = 0;
+    NXT_CHECK_EQ(lcd.getPipeErr(&seq),noReply);
+    NXT_CHECK_EQ(seq,slow);
+    lcd.setNumeric(6,3);
+    lcd.setNumeric(7,4);
+    NXT_CHECK_EQ(lcd.pipeFlush(),replyCmdOk);
+    NXT_CHECK_EQ(lcd.getPipeErr(&seq),replyCmdOk);
+    lcd.setNumeric("x3",5);
+    uint16_t bad = lcd.getCmdSeq();
+    lcd.setNumeric(8,6);
+    NXT_CHECK_EQ(lcd.pipeFlush(),replyWrongId);
+    NXT_CHECK_EQ(lcd.getPipeErr(&seq),replyWrongId);
+    NXT_CHECK_EQ(seq,bad);
+}
+
+
+/*
+ * a frame committed in pipeline mode get one reply for each command
+ */
+NXT_TEST(frameAcks){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    uint8_t frame[256];
+    setup(emu,lcd);
+    lcd.setFrameBuf(frame,sizeof(frame));
+    lcd.beginFrame(1);
+    lcd.setNumeric(1,1);
+    lcd.setNumeric("x1",2);
+    uint16_t bad = lcd.getCmdSeq();
+    lcd.setNumeric(2,3);
+    NXT_CHECK_EQ(lcd.commitFrame(),replyWrongId);
+    uint16_t seq = 0;
+    NXT_CHECK_EQ(lcd.getPipeErr(&seq),replyWrongId);
+    NXT_CHECK_EQ(seq,bad);
+    NXT_CHECK_EQ(emu.num("0.2.val"),3);
+    NXT_CHECK_STR(nxtLast(emu),"ref_star");
+}
@@ -0,0 +1,131 @@
+/* test_reply.cpp
+ *
+ * Host tests of the reply wait of writeBuf(): a command return as soon as its reply
+ * is parsed, the whole wait is spent only when no reply comes
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+/*
+ * with bkcmd=3 a set return after wire time + execution + ack, well before the deadline
+ */
+NXT_TEST(returnOnAck){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,1);
+    NXT_CHECK_EQ(lcd.setBkcmd(3),replyCmdOk);
+    uint64_t start = hostNow();
+    NXT_CHECK_EQ(lcd.setNumeric(3,12345),replyCmdOk);
+    uint64_t us = (hostNow() - start) / 1000;
+    // "b[3].val=12345" + ff ff ff out, 01 ff ff ff back: 21 bytes at 87 us
+    NXT_CHECK(us >= 21 * 86 + emu.cmdNs / 1000);
+    NXT_CHECK(us < 3000);
+}
+
+
+/*
+ * get replies are waited for the same way
+ */
+NXT_TEST(returnOnData){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,1);
+    emu.setNum("0.3.val",7);
+    int32_t v = 0;
+    uint64_t start = hostNow();
+    NXT_CHECK_EQ(lcd.getNumeric(3,&v,sizeof(v)),replyCmdOk);
+    NXT_CHECK_EQ(v,7);
+    NXT_CHECK(hostNow() - start < 3000000ULL);
+}
+
+
+/*
+ * with bkcmd=2 success has no reply, the deadline is reached (counted from the end of
+ * the command on the wire); a failure return at once
+ */
+NXT_TEST(deadlineWithoutReply){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,1);
+    uint64_t start = hostNow();
+    NXT_CHECK_EQ(lcd.setNumeric(3,1),replyCmdOk);
+    uint64_t us = (hostNow() - start) / 1000;
+    // "b[3].val=1" + ff ff ff, 13 bytes at 87 us
+    NXT_CHECK(us >= NXT_REPLY_WAIT * 1000UL - 1000 && us <= NXT_REPLY_WAIT * 1000UL + 13 * 87 + 1000);
+    start = hostNow();
+    NXT_CHECK_EQ(lcd.setNumeric("x9",1),replyWrongId);
+    NXT_CHECK(hostNow() - start < 3000000ULL);
+}
+
+
+/*
+ * the reply length is known from its code, 0xFF in the data doesn't end it
+ */
+NXT_TEST(ffInNumber){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,1);
+    emu.setNum("0.3.val",-1);
+    int32_t v = 0;
+    NXT_CHECK_EQ(lcd.getNumeric(3,&v,sizeof(v)),replyCmdOk);   // 0xFF in the data
+    NXT_CHECK_EQ(v,-1);
+}
+
+
+/*
+ * a get reply arriving after the timeout is discarded, the next get has its own value
+ */
+NXT_TEST(lateGetReply){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,1);
+    emu.setNum("0.5.val",55);
+    emu.setNum("0.6.val",66);
+    emu.setCost("get b[5]",(NXT_REPLY_WAIT + 10) * 1000000UL);
+    int32_t v = 0;
+    NXT_CHECK_EQ(lcd.getNumeric(5,&v,sizeof(v)),noReply);
+    NXT_CHECK_EQ(lcd.getNumeric(6,&v,sizeof(v)),replyCmdOk);
+    NXT_CHECK_EQ(v,66);
+}
+
+
+/*
+ * a get reply cut by the timeout: its rest is discarded too, not taken as the start
+ * of the next reply
+ */
+NXT_TEST(cutGetReply){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    lcd.init(9600,1,0,1);
+    emu.setNum("0.5.val",55);
+    emu.setNum("0.6.val",66);
+    emu.setCost("get b[5]",(NXT_REPLY_WAIT - 4) * 1000000UL);   // 8 bytes reply, 8.3 ms
+    int32_t v = 0;
+    NXT_CHECK_EQ(lcd.getNumeric(5,&v,sizeof(v)),noComplete);
+    NXT_CHECK_EQ(lcd.getNumeric(6,&v,sizeof(v)),replyCmdOk);
+    NXT_CHECK_EQ(v,66);
+}
+
+
+/*
+ * at 9600 baud the commands take longer than NXT_REPLY_WAIT on the wire: the deadline
+ * start when they are sent, those written before without waiting included
+ */
+NXT_TEST(slowLink){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    NXT_CHECK_EQ(lcd.init(9600,1,0,0),replyCmdOk);
+    emu.setNum("0.3.val",1234);
+    lcd.setNumeric(4,1);
+    lcd.setNumeric(5,2);
+    int32_t v = 0;
+    NXT_CHECK_EQ(lcd.getNumeric(3,&v,sizeof(v)),replyCmdOk);
+    NXT_CHECK_EQ(v,1234);
+    uint16_t dims = 0;
+    NXT_CHECK_EQ(lcd.getProperty(nxt_dims,&dims),replyCmdOk);
+    NXT_CHECK_EQ(dims,emu.num("dims"));
+}
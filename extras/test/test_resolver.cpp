@@ -0,0 +1,270 @@
+/* test_resolver.cpp
+ *
+ * Host tests of the name resolver (resolver.cpp)
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+static int count(NxtEmu& emu, const char* cmd){
+    emu.settle();
+    int n = 0;
+    for(size_t i = 0; i < emu.log.size(); i++) if(emu.log[i] == cmd) n++;
+    return n;
+}
+
+
+NXT_TEST(learnInPoll){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtName_t names[8];
+    nxtNameLearn_t learn;
+    emu.addObj(0,5,"temperature");
+    lcd.init(115200,1,0,1);
+    NXT_CHECK_EQ(lcd.setResolver(names,8,NULL),invalidData);
+    lcd.setResolver(names,8,&learn);
+    emu.clearLog();
+    lcd.setNumeric("temperature",1);
+    lcd.setNumeric("temperature",2);               // not learned yet
+    NXT_CHECK_STR(nxtLast(emu),"temperature.val=2");
+    NXT_CHECK_EQ(count(emu,"get temperature.id"),0);
+    lcd.poll();
+    NXT_CHECK_STR(nxtLast(emu),"get temperature.id");
+    lcd.setNumeric("temperature",3);
+    NXT_CHECK_STR(nxtLast(emu),"b[5].val=3");
+    lcd.poll();
+    NXT_CHECK_EQ(count(emu,"get temperature.id"),1);
+    NXT_CHECK(lcd.getNameSaved() > 0);
+}
+
+
+/*
+ * the page id comes from addPageId(), the component one from the display
+ */
+NXT_TEST(pageObject){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtName_t names[8];
+    nxtNameLearn_t learn;
+    emu.addPage(2,"setup");
+    emu.addObj(2,7,"speed");
+    lcd.init(115200,1,0,1);
+    lcd.setResolver(names,8,&learn);
+    lcd.addPageId("setup",2);
+    lcd.setNumeric("setup","speed",4);
+    NXT_CHECK_STR(nxtLast(emu),"setup.speed.val=4");
+    lcd.poll();
+    NXT_CHECK_STR(nxtLast(emu),"get setup.speed.id");
+    lcd.setNumeric("setup","speed",5);
+    NXT_CHECK_STR(nxtLast(emu),"p[2].b[7].val=5");
+    NXT_CHECK_EQ(emu.num("2.7.val"),5);
+}
+
+
+/*
+ * a name unknown to the display is asked only once
+ */
+NXT_TEST(failedLookup){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtName_t names[8];
+    nxtNameLearn_t learn;
+    lcd.init(115200,1,0,1);
+    lcd.setResolver(names,8,&learn);
+    emu.clearLog();
+    lcd.setNumeric("nope",1);
+    lcd.poll();
+    lcd.setNumeric("nope",2);
+    lcd.poll();
+    lcd.setNumeric("nope",3);
+    lcd.poll();
+    NXT_CHECK_EQ(count(emu,"get nope.id"),1);
+    NXT_CHECK_STR(nxtLast(emu),"nope.val=3");
+}
+
+
+/*
+ * nothing is asked while a frame is open or async requests are in flight
+ */
+NXT_TEST(notWhileBusy){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtName_t names[8];
+    nxtNameLearn_t learn;
+    uint8_t frame[256];
+    nxtReq_t slots[4];
+    emu.addObj(0,5,"temperature");
+    lcd.init(115200,1,0,1);
+    lcd.setResolver(names,8,&learn);
+    lcd.setFrameBuf(frame,sizeof(frame));
+    lcd.setReqSlots(slots,4);
+    emu.clearLog();
+    lcd.beginFrame();
+    lcd.setNumeric("temperature",1);
+    lcd.poll();
+    NXT_CHECK_EQ(count(emu,"get temperature.id"),0);
+    NXT_CHECK_EQ(lcd.commitFrame(),replyCmdOk);
+    int32_t v;
+    uint8_t h;
+    emu.setNum("0.2.val",9);
+    lcd.getNumericAsync(2,&v,sizeof(v),&h);
+    lcd.poll();
+    NXT_CHECK_EQ(count(emu,"get temperature.id"),0);
+    lcd.reqFlush();
+    NXT_CHECK_EQ(lcd.reqStatus(h),replyCmdOk);
+    NXT_CHECK_EQ(v,9);
+    lcd.poll();
+    NXT_CHECK_EQ(count(emu,"get temperature.id"),1);
+}
+
+
+/*
+ * the learned get does not break the command being built: a command built with the
+ * resolver (cmdObj()) while a name is pending is sent whole
+ */
+NXT_TEST(commandIntact){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtName_t names[8];
+    nxtNameLearn_t learn;
+    emu.addObj(0,5,"temperature");
+    emu.addObj(0,6,"humidity");
+    lcd.init(115200,1,0,1);
+    lcd.setResolver(names,8,&learn);
+    lcd.setNumeric("temperature",1);
+    lcd.setNumeric("humidity",2);
+    NXT_CHECK_STR(nxtLast(emu),"humidity.val=2");
+    lcd.poll();
+    lcd.setNumeric("humidity",3);
+    lcd.poll();
+    lcd.setNumeric("temperature",4);
+    lcd.setNumeric("humidity",5);
+    NXT_CHECK_EQ(emu.num("0.5.val"),4);
+    NXT_CHECK_STR(nxtLast(emu),"b[6].val=5");
+}
+
+
+/*
+ * handles bound to a name are resolved too, <page>.<object> names included
+ */
+NXT_TEST(handles){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtName_t names[8];
+    nxtNameLearn_t learn;
+    emu.addPage(2,"setup");
+    emu.addObj(0,5,"temperature");
+    emu.addObj(2,7,"speed");
+    lcd.init(115200,1,0,1);
+    lcd.setResolver(names,8,&learn);
+    lcd.addPageId("setup",2);
+    NxtNumber temp(lcd,"temperature");
+    NxtNumber speed(lcd,"setup.speed");
+    temp.set(1);
+    lcd.poll();
+    speed.set(2);
+    lcd.poll();
+    temp.set(3);
+    NXT_CHECK_STR(nxtLast(emu),"b[5].val=3");
+    speed.set(4);
+    NXT_CHECK_STR(nxtLast(emu),"p[2].b[7].val=4");
+    lcd.setNumeric("setup.speed",5);
+    NXT_CHECK_STR(nxtLast(emu),"p[2].b[7].val=5");
+    NXT_CHECK_EQ(emu.num("2.7.val"),5);
+}
+
+
+/*
+ * lazy init without reset: the current page is read, bare names are resolved on it
+ */
+NXT_TEST(lazyPage){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtName_t names[8];
+    nxtNameLearn_t learn;
+    emu.addObj(0,5,"temperature");
+    emu.addObj(2,9,"temperature");
+    emu.page = 2;
+    NXT_CHECK_EQ(lcd.init(115200,1,0,1,nxt_propLazy),replyCmdOk);
+    lcd.setResolver(names,8,&learn);
+    lcd.setNumeric("temperature",1);
+    lcd.poll();
+    lcd.setNumeric("temperature",2);
+    NXT_CHECK_STR(nxtLast(emu),"b[9].val=2");
+    NXT_CHECK_EQ(emu.num("2.9.val"),2);
+    NXT_CHECK_EQ(emu.num("0.5.val"),0);
+    uint16_t page = 0;
+    emu.clearLog();
+    NXT_CHECK_EQ(lcd.getProperty(nxt_dp,&page,1),replyCmdOk);      // known, not asked
+    NXT_CHECK_EQ(page,2);
+    NXT_CHECK_EQ(emu.log.size(),0);
+}
+
+
+/*
+ * the shadow cache key a component by its name, whether it's sent with the name or
+ * with the id: a write after the name is forgotten is not taken for a cache hit
+ */
+NXT_TEST(shadowKey){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtName_t names[1];
+    nxtNameLearn_t learn;
+    nxtShadow_t shadow[8];
+    emu.addObj(0,5,"aaaaaaaa");
+    emu.addObj(0,1,"bbbbbbbb");
+    lcd.init(115200,1,0,1);
+    lcd.setResolver(names,1,&learn);
+    lcd.setShadow(shadow,8);
+    lcd.setNumeric("aaaaaaaa",5);
+    lcd.poll();
+    lcd.setNumeric("aaaaaaaa",7);
+    NXT_CHECK_STR(nxtLast(emu),"b[5].val=7");
+    lcd.setNumeric("bbbbbbbb",1);
+    lcd.poll();                                     // forget "aaaaaaaa"
+    lcd.setNumeric("aaaaaaaa",5);
+    NXT_CHECK_STR(nxtLast(emu),"aaaaaaaa.val=5");
+    NXT_CHECK_EQ(emu.num("0.5.val"),5);
+    lcd.setNumeric("aaaaaaaa",5);
+    uint32_t hits, misses;
+    lcd.getShadowStats(&hits,&misses);
+    NXT_CHECK_EQ(hits,1);
+    NXT_CHECK_EQ(misses,4);
+}
+
+
+/*
+ * after a touch the display can be on another page: bare names are sent as names
+ * until the page is known again, page qualified ones are still resolved
+ */
+NXT_TEST(pageNotSure){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtName_t names[8];
+    nxtNameLearn_t learn;
+    emu.addPage(0,"main");
+    emu.addObj(0,5,"temperature");
+    lcd.init(115200,1,0,1);
+    lcd.setResolver(names,8,&learn);
+    lcd.addPageId("main",0);
+    lcd.setNumeric("temperature",1);
+    lcd.poll();
+    lcd.setNumeric("main","temperature",1);
+    lcd.poll();
+    lcd.setNumeric("temperature",2);
+    NXT_CHECK_STR(nxtLast(emu),"b[5].val=2");
+    emu.touch(0,3,1);
+    emu.settle();
+    lcd.poll();
+    lcd.setNumeric("temperature",3);
+    NXT_CHECK_STR(nxtLast(emu),"temperature.val=3");
+    lcd.setNumeric("main","temperature",4);
+    NXT_CHECK_STR(nxtLast(emu),"p[0].b[5].val=4");
+    uint8_t page;
+    NXT_CHECK_EQ(lcd.getPage(&page),replyCmdOk);
+    lcd.setNumeric("temperature",5);
+    NXT_CHECK_STR(nxtLast(emu),"b[5].val=5");
+}
@@ -0,0 +1,176 @@
+/* test_shadow.cpp
+ *
+ * Host tests of the shadow cache (shadow.cpp): hashing, skipped writes, invalidation
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+static uint32_t hash(const char* s){
+    return nxtHash((const uint8_t*)s,strlen(s));
+}
+
+
+/*
+ * FNV-1a reference values
+ */
+NXT_TEST(fnv1a){
+    NXT_CHECK_EQ(hash(""),0x811C9DC5UL);
+    NXT_CHECK_EQ(hash("a"),0xE40C292CUL);
+    NXT_CHECK_EQ(hash("foobar"),0xBF9CF968UL);
+    NXT_CHECK(hash("b[3].val") != hash("b[3].va"));
+    NXT_CHECK(hash("p[0].b[13].val") != hash("p[0].b[31].val"));
+}
+
+
+NXT_TEST(skipSame){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtShadow_t shadow[4];
+    lcd.init(115200,1,0,1);
+    lcd.setShadow(shadow,4);
+    emu.clearLog();
+    lcd.setNumeric(3,10);
+    lcd.setNumeric(3,10);
+    lcd.setNumeric(3,101);      // the value hash cover the whole value
+    lcd.setNumeric(3,10);
+    lcd.setNumeric(4,10);       // another component
+    emu.settle();
+    NXT_CHECK_EQ(emu.log.size(),4);
+    uint32_t hits, misses;
+    lcd.getShadowStats(&hits,&misses);
+    NXT_CHECK_EQ(hits,1);
+    NXT_CHECK_EQ(misses,4);
+    lcd.setString(5,"ab");
+    lcd.setString(5,"ab");
+    lcd.setString(5,"abc");
+    emu.settle();
+    NXT_CHECK_EQ(emu.log.size(),6);
+}
+
+
+/*
+ * entries are reused round robin when the table is full
+ */
+NXT_TEST(tableFull){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtShadow_t shadow[2];
+    lcd.init(115200,1,0,1);
+    lcd.setShadow(shadow,2);
+    emu.clearLog();
+    lcd.setNumeric(1,1);
+    lcd.setNumeric(2,2);
+    lcd.setNumeric(3,3);        // replace b[1]
+    lcd.setNumeric(3,3);
+    lcd.setNumeric(2,2);
+    lcd.setNumeric(1,1);
+    emu.settle();
+    NXT_CHECK_EQ(emu.log.size(),4);
+}
+
+
+NXT_TEST(pageChange){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtShadow_t shadow[4];
+    lcd.init(115200,1,0,1);
+    lcd.setShadow(shadow,4);
+    lcd.setNumeric(3,10);
+    lcd.setPageN(1);
+    lcd.setPageN(0);
+    lcd.setNumeric(3,10);
+    NXT_CHECK_STR(nxtLast(emu),"b[3].val=10");
+}
+
+
+/*
+ * a write failed in pipeline mode is not taken as done
+ */
+NXT_TEST(pipelineError){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtShadow_t shadow[4];
+    lcd.init(115200,1,0,0);
+    lcd.setShadow(shadow,4);
+    lcd.setPipeline(1);
+    NXT_CHECK_EQ(lcd.setNumeric("x9",5),replyCmdOk);    // queued
+    lcd.pipeFlush();
+    uint16_t seq;
+    NXT_CHECK(lcd.getPipeErr(&seq) != replyCmdOk);
+    emu.addObj(0,9,"x9");
+    lcd.setNumeric("x9",5);
+    NXT_CHECK_EQ(lcd.pipeFlush(),replyCmdOk);
+    NXT_CHECK_EQ(emu.num("0.9.val"),5);
+}
+
+
+/*
+ * the same when the reply does not come
+ */
+NXT_TEST(pipelineTimeout){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtShadow_t shadow[4];
+    lcd.init(115200,1,0,0);
+    lcd.setShadow(shadow,4);
+    lcd.setPipeline(1);
+    emu.setCost("b[3].val=5",(NXT_REPLY_WAIT + 10) * 1000000UL);
+    lcd.setNumeric(3,5);
+    NXT_CHECK_EQ(lcd.pipeFlush(),noReply);
+    uint16_t seq;
+    lcd.getPipeErr(&seq);
+    hostAdvance(50000000);
+    lcd.poll();
+    emu.setCost("b[3].val=5",emu.cmdNs);
+    emu.clearLog();
+    lcd.setNumeric(3,5);
+    NXT_CHECK_EQ(lcd.pipeFlush(),replyCmdOk);
+    NXT_CHECK_STR(nxtLast(emu),"b[3].val=5");
+}
+
+
+/*
+ * and in a frame
+ */
+NXT_TEST(frameError){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtShadow_t shadow[4];
+    uint8_t frame[256];
+    lcd.init(115200,1,0,1);
+    lcd.setShadow(shadow,4);
+    lcd.setFrameBuf(frame,sizeof(frame));
+    lcd.beginFrame();
+    lcd.setNumeric(3,7);
+    lcd.setNumeric("x9",7);
+    NXT_CHECK(lcd.commitFrame() != replyCmdOk);
+    emu.clearLog();
+    lcd.setNumeric(3,7);
+    NXT_CHECK_STR(nxtLast(emu),"b[3].val=7");
+}
+
+
+/*
+ * the same at 9600 baud, the error of the last command of a long frame arrive well
+ * after the frame is written
+ */
+NXT_TEST(frameErrorSlow){
+    NxtEmu emu(9600);
+    NxtLcd lcd(&emu);
+    nxtShadow_t shadow[8];
+    uint8_t frame[256];
+    lcd.init(9600,1,0,1);
+    lcd.setShadow(shadow,8);
+    lcd.setFrameBuf(frame,sizeof(frame));
+    lcd.beginFrame();
+    for(int i = 1; i <= 5; i++) lcd.setNumeric(i,7);
+    lcd.setNumeric("nosuch",1);
+    NXT_CHECK_EQ(lcd.commitFrame(),replyWrongId);
+    emu.clearLog();
+    lcd.setNumeric(3,7);
+    NXT_CHECK_STR(nxtLast(emu),"b[3].val=7");
+}
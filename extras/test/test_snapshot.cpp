@@ -0,0 +1,102 @@
+/* test_snapshot.cpp
+ *
+ * Host tests of the properties snapshot (snapshot.cpp) with the init() property modes
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+struct Store{
+    nxtSnap_t   snap;
+    int         saves = 0;
+    int         has = 0;
+};
+
+static uint8_t snapIo(uint8_t save, nxtSnap_t* snap, void* ctx){
+    Store* st = (Store*)ctx;
+    if(save){
+        st->snap = *snap;
+        st->saves++;
+        st->has = 1;
+        return 1;
+    }
+    if(st->has == 0) return 0;
+    *snap = st->snap;
+    return 1;
+}
+
+
+/*
+ * a snapshot saved by init() make the next init() a warm boot
+ */
+NXT_TEST(warmBoot){
+    NxtEmu emu(115200);
+    Store st;
+    {
+        NxtLcd lcd(&emu);
+        lcd.setSnapshot(snapIo,&st);
+        NXT_CHECK_EQ(lcd.init(115200,1,0,1),replyCmdOk);
+        NXT_CHECK_EQ(lcd.getWarmBoot(),0);
+        NXT_CHECK_EQ(st.saves,1);
+    }
+    NxtLcd lcd(&emu);
+    lcd.setSnapshot(snapIo,&st);
+    NXT_CHECK_EQ(lcd.init(115200,1,0,1),replyCmdOk);
+    NXT_CHECK_EQ(lcd.getWarmBoot(),1);
+}
+
+
+/*
+ * lazy mode: no snapshot of properties still unknown, the sketch save it later
+ */
+NXT_TEST(lazyNoSave){
+    NxtEmu emu(115200);
+    Store st;
+    NxtLcd lcd(&emu);
+    lcd.setSnapshot(snapIo,&st);
+    NXT_CHECK_EQ(lcd.init(115200,1,0,1,nxt_propLazy),replyCmdOk);
+    NXT_CHECK_EQ(st.saves,0);
+    uint16_t v;
+    NXT_CHECK_EQ(lcd.getProperty(nxt_dim,&v,1),replyCmdOk);
+    NXT_CHECK_EQ(lcd.saveSnapshot(),replyCmdOk);
+    NXT_CHECK_EQ(st.saves,1);
+    NXT_CHECK(st.snap.valid & NXT_PROP_BIT(nxt_dim));
+    NxtLcd lcd2(&emu);
+    lcd2.setSnapshot(snapIo,&st);
+    NXT_CHECK_EQ(lcd2.init(115200,1,0,1,nxt_propLazy),replyCmdOk);
+    NXT_CHECK_EQ(lcd2.getWarmBoot(),1);
+    emu.clearLog();
+    NXT_CHECK_EQ(lcd2.getProperty(nxt_dim,&v,1),replyCmdOk);
+    NXT_CHECK_EQ(emu.log.size(),0);
+}
+
+
+/*
+ * the display changed page and went to sleep after the save: a warm boot read them again
+ */
+NXT_TEST(pageChanged){
+    NxtEmu emu(115200);
+    Store st;
+    {
+        NxtLcd lcd(&emu);
+        lcd.setSnapshot(snapIo,&st);
+        NXT_CHECK_EQ(lcd.init(115200,1,0,1),replyCmdOk);
+        NXT_CHECK_EQ(lcd.saveSnapshot(1),replyCmdOk);
+    }
+    emu.page = 3;
+    emu.setNum("sleep",1);
+    NxtLcd lcd(&emu);
+    lcd.setSnapshot(snapIo,&st);
+    NXT_CHECK_EQ(lcd.init(115200,1,0,1),replyCmdOk);
+    NXT_CHECK_EQ(lcd.getWarmBoot(),1);
+    emu.clearLog();
+    uint16_t v;
+    NXT_CHECK_EQ(lcd.getProperty(nxt_dp,&v,1),replyCmdOk);
+    NXT_CHECK_EQ(v,3);
+    NXT_CHECK_EQ(lcd.getProperty(nxt_sleep,&v,1),replyCmdOk);
+    NXT_CHECK_EQ(v,1);
+    NXT_CHECK_EQ(emu.log.size(),0);
+}
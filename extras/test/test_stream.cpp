@@ -0,0 +1,34 @@
+/* test_stream.cpp
+ *
+ * Host tests of the Stream backend (NXT_STREAM_SERIAL): the library drive the
+ * emulator as a plain Stream
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+NXT_TEST(streamRoundTrip){
+    NxtEmu emu(115200);
+    NxtLcd lcd((Stream*)&emu);
+    NXT_CHECK_EQ(lcd.init(115200,1,1,1),replyCmdOk);
+    NXT_CHECK_EQ(lcd.setNumeric(0,3,7),replyCmdOk);
+    NXT_CHECK_STR(nxtLast(emu),"p[0].b[3].val=7");
+    int32_t v = 0;
+    NXT_CHECK_EQ(lcd.getNumeric(0,3,&v,sizeof(v)),replyCmdOk);
+    NXT_CHECK_EQ(v,7);
+}
+
+
+/*
+ * the stream is not reopened by init(), and it's not limited by availableForWrite()
+ */
+NXT_TEST(streamKeepRate){
+    NxtEmu emu(115200);
+    NxtLcd lcd((Stream*)&emu);
+    lcd.init(9600,1,0,1);
+    NXT_CHECK_EQ(lcd.setDim(30),replyCmdOk);
+    NXT_CHECK_EQ(emu.num("dim"),30);
+}
@@ -0,0 +1,222 @@
+/* test_stroke.cpp
+ *
+ * Host tests of the stroke buffer (touch.cpp): full buffer handling, drawing while
+ * new points arrive
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+/*
+ * lines drawn, as "x1,y1,x2,y2" strings, from the emulator log
+ */
+static std::vector<std::string> lines(NxtEmu& emu){
+    std::vector<std::string> res;
+    emu.settle();
+    for(size_t i = 0; i < emu.log.size(); i++){
+        const std::string& c = emu.log[i];
+        if(c.compare(0,5,"line ") != 0) continue;
+        res.push_back(c.substr(5,c.rfind(',') - 5));
+    }
+    return res;
+}
+
+
+static void stroke(NxtEmu& emu, NxtLcd& lcd, const uint16_t (*pt)[2], int n){
+    for(int i = 0; i < n; i++){
+        emu.touchXY(pt[i][0],pt[i][1],1);
+        emu.settle();
+        lcd.poll();
+    }
+}
+
+
+/*
+ * buffer full: the points already drawn are dropped but the last one
+ */
+NXT_TEST(fullShift){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtPoint_t buf[4];
+    lcd.init(115200,1,0,1);
+    lcd.setXYMode(nxt_xyStroke,buf,4);
+    const uint16_t a[3][2] = {{10,10},{20,10},{30,10}};
+    stroke(emu,lcd,a,3);
+    emu.clearLog();
+    NXT_CHECK_EQ(lcd.drawStroke(0),replyCmdOk);
+    NXT_CHECK_EQ(lines(emu).size(),2);
+    const uint16_t b[3][2] = {{40,10},{50,10},{60,10}};
+    stroke(emu,lcd,b,3);
+    NXT_CHECK_EQ(lcd.getStrokeLen(),4);
+    NXT_CHECK_EQ(buf[0].x,30);
+    NXT_CHECK_EQ(buf[3].x,60);
+    emu.clearLog();
+    NXT_CHECK_EQ(lcd.drawStroke(0),replyCmdOk);
+    std::vector<std::string> l = lines(emu);
+    NXT_CHECK_EQ(l.size(),3);
+    if(l.size() == 3){
+        NXT_CHECK_STR(l[0].c_str(),"30,10,40,10");
+        NXT_CHECK_STR(l[2].c_str(),"50,10,60,10");
+    }
+}
+
+
+/*
+ * buffer full and nothing drawn: the last point follow the finger
+ */
+NXT_TEST(fullReplace){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtPoint_t buf[3];
+    lcd.init(115200,1,0,1);
+    lcd.setXYMode(nxt_xyStroke,buf,3);
+    const uint16_t a[5][2] = {{10,10},{20,10},{30,10},{40,10},{50,10}};
+    stroke(emu,lcd,a,5);
+    NXT_CHECK_EQ(lcd.getStrokeLen(),3);
+    NXT_CHECK_EQ(buf[1].x,20);
+    NXT_CHECK_EQ(buf[2].x,50);
+    emu.clearLog();
+    lcd.drawStroke(0);
+    std::vector<std::string> l = lines(emu);
+    NXT_CHECK_EQ(l.size(),2);
+    if(l.size() == 2) NXT_CHECK_STR(l[1].c_str(),"20,10,50,10");
+}
+
+
+/*
+ * points received while drawing (the writes poll the port): a new press stop drawing,
+ * the rest of the first stroke and the new one are drawn by the next call, not joined
+ */
+NXT_TEST(pressWhileDrawing){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtPoint_t buf[16];
+    lcd.init(115200,1,0,1);
+    lcd.setXYMode(nxt_xyStroke,buf,16);
+    const uint16_t a[6][2] = {{10,10},{20,10},{30,10},{40,10},{50,10},{60,10}};
+    stroke(emu,lcd,a,6);
+    emu.touchXY(60,10,0);
+    emu.settle();
+    lcd.poll();
+    emu.clearLog();
+    emu.touchXY(100,100,1);            // arrive while the first lines are sent
+    emu.touchXY(100,110,1);
+    lcd.drawStroke(0);
+    emu.settle();
+    lcd.poll();
+    std::vector<std::string> l = lines(emu);
+    emu.clearLog();
+    lcd.drawStroke(0);
+    std::vector<std::string> l2 = lines(emu);
+    l.insert(l.end(),l2.begin(),l2.end());
+    NXT_CHECK_EQ(l.size(),7);           // 5 segments and the release point, then the new one
+    if(l.size() == 7){
+        NXT_CHECK_STR(l[0].c_str(),"10,10,20,10");
+        NXT_CHECK_STR(l[4].c_str(),"50,10,60,10");
+        NXT_CHECK_STR(l[5].c_str(),"60,10,60,10");
+        NXT_CHECK_STR(l[6].c_str(),"100,100,100,110");
+    }
+    NXT_CHECK_EQ(lcd.getStrokeLost(),0);
+    emu.clearLog();
+    lcd.drawStroke(0);
+    NXT_CHECK_EQ(lines(emu).size(),0);
+}
+
+
+/*
+ * two strokes received before drawStroke(): both are drawn, with no line between them
+ */
+NXT_TEST(twoStrokes){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtPoint_t buf[8];
+    lcd.init(115200,1,0,1);
+    lcd.setXYMode(nxt_xyStroke,buf,8);
+    emu.touchXY(10,10,1);
+    emu.touchXY(20,10,1);
+    emu.touchXY(20,10,0);
+    emu.touchXY(50,50,1);
+    emu.touchXY(50,60,1);
+    emu.settle();
+    lcd.poll();
+    NXT_CHECK_EQ(lcd.getStrokeLen(),6);
+    NXT_CHECK_EQ(buf[3].x,NXT_STROKE_BREAK);
+    emu.clearLog();
+    NXT_CHECK_EQ(lcd.drawStroke(0),replyCmdOk);
+    std::vector<std::string> l = lines(emu);
+    NXT_CHECK_EQ(l.size(),3);
+    if(l.size() == 3){
+        NXT_CHECK_STR(l[0].c_str(),"10,10,20,10");
+        NXT_CHECK_STR(l[1].c_str(),"20,10,20,10");
+        NXT_CHECK_STR(l[2].c_str(),"50,50,50,60");
+    }
+    NXT_CHECK_EQ(lcd.getStrokeLost(),0);
+    emu.touchXY(50,60,0);
+    emu.settle();
+    lcd.poll();
+    lcd.drawStroke(0);
+    emu.touchXY(80,80,1);              // all drawn: the press restart the buffer
+    emu.settle();
+    lcd.poll();
+    NXT_CHECK_EQ(lcd.getStrokeLen(),1);
+    NXT_CHECK_EQ(buf[0].x,80);
+}
+
+
+/*
+ * no room to keep the undrawn stroke: it's dropped and counted
+ */
+NXT_TEST(strokeLost){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtPoint_t buf[4];
+    lcd.init(115200,1,0,1);
+    lcd.setXYMode(nxt_xyStroke,buf,4);
+    emu.touchXY(10,10,1);
+    emu.touchXY(20,10,1);
+    emu.touchXY(20,10,0);
+    emu.touchXY(50,50,1);
+    emu.settle();
+    lcd.poll();
+    NXT_CHECK_EQ(lcd.getStrokeLen(),1);
+    NXT_CHECK_EQ(buf[0].x,50);
+    NXT_CHECK_EQ(lcd.getStrokeLost(),2);
+}
+
+
+/*
+ * buffer shifted while drawing: no segment is skipped or drawn with moved points
+ */
+NXT_TEST(shiftWhileDrawing){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    nxtPoint_t buf[4];
+    lcd.init(115200,1,0,1);
+    lcd.setXYMode(nxt_xyStroke,buf,4);
+    const uint16_t a[2][2] = {{10,10},{20,10}};
+    stroke(emu,lcd,a,2);
+    lcd.drawStroke(0);
+    const uint16_t b[2][2] = {{30,10},{40,10}};
+    stroke(emu,lcd,b,2);
+    emu.clearLog();
+    for(int i = 0; i < 3; i++) emu.touchXY(50 + i * 10,10,1);
+    for(int i = 0; i < 6; i++){
+        lcd.drawStroke(0);
+        emu.settle();
+        lcd.poll();
+    }
+    // the stroke stay connected from the last point drawn to the finger, each
+    // segment sent once (points can be replaced, the buffer is small)
+    std::vector<std::string> l = lines(emu);
+    NXT_CHECK(l.size() >= 2);
+    if(l.size() < 2) return;
+    NXT_CHECK_STR(l.front().substr(0,5).c_str(),"20,10");
+    NXT_CHECK_STR(l.back().substr(6).c_str(),"70,10");
+    for(size_t i = 1; i < l.size(); i++){
+        NXT_CHECK(l[i].substr(0,5) == l[i - 1].substr(6));
+        NXT_CHECK(l[i] != l[i - 1]);
+    }
+}
@@ -0,0 +1,146 @@
+/* test_txring.cpp
+ *
+ * Host tests of the transmit ring (any_serial.cpp): non blocking writes, wrap-around,
+ * limited FIFO room, flush, writes larger than the ring, ports without a FIFO count
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+#include <HardwareSerial.h>
+#include <SoftwareSerial.h>
+
+
+static void drain(NxtEmu& emu, NxtLcd& lcd){
+    while(lcd.getTxPending() > 0){
+        hostAdvance(100000);
+        lcd.poll();
+    }
+    emu.settle();
+}
+
+
+/*
+ * writes return at once, the bytes go out from poll()
+ */
+NXT_TEST(nonBlocking){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    uint8_t ring[256];
+    lcd.init(115200,1,0,0);
+    NXT_CHECK_EQ(lcd.setTxBuf(ring,sizeof(ring)),replyCmdOk);
+    uint64_t start = hostNow();
+    for(int i = 0; i < 10; i++) NXT_CHECK_EQ(lcd.setNumeric(i + 1,1000 + i),replyCmdOk);
+    NXT_CHECK(hostNow() - start < 2000000);     // the wire take ~15 ms
+    NXT_CHECK(lcd.getTxPending() > 0);
+    drain(emu,lcd);
+    for(int i = 0; i < 10; i++) NXT_CHECK_EQ(emu.num("0." + std::to_string(i + 1) + ".val"),1000 + i);
+}
+
+
+NXT_TEST(badRing){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    uint8_t ring[NXT_BUF_SIZE];
+    lcd.init(115200,1,0,0);
+    NXT_CHECK_EQ(lcd.setTxBuf(ring,NXT_BUF_SIZE - 1),invalidData);
+    NXT_CHECK_EQ(lcd.setTxBuf(ring,NXT_BUF_SIZE),replyCmdOk);
+    NXT_CHECK_EQ(lcd.setTxBuf(NULL,0),replyCmdOk);
+}
+
+
+/*
+ * a small ring wrap many times, commands arrive whole and in order
+ */
+NXT_TEST(wrapAround){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    uint8_t ring[NXT_BUF_SIZE];
+    lcd.init(115200,1,0,0);
+    lcd.setTxBuf(ring,sizeof(ring));
+    emu.clearLog();
+    for(int i = 0; i < 200; i++){
+        NXT_CHECK_EQ(lcd.setNumeric(i % 7 + 1,i * 13),replyCmdOk);
+        if(i % 3 == 0) lcd.poll();
+    }
+    drain(emu,lcd);
+    NXT_CHECK_EQ(emu.log.size(),200);
+    NXT_CHECK_EQ(emu.lost,0);
+    for(size_t i = 0; i < emu.log.size(); i++){
+        std::string want = "b[" + std::to_string(i % 7 + 1) + "].val=" + std::to_string(i * 13);
+        NXT_CHECK_STR(emu.log[i].c_str(),want.c_str());
+    }
+}
+
+
+/*
+ * the port FIFO take only what it has room for, the rest wait in the ring
+ */
+NXT_TEST(fifoRoom){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    uint8_t ring[NXT_BUF_SIZE];
+    lcd.init(115200,1,0,0);
+    emu.settle();
+    emu.txFifo = 8;
+    lcd.setTxBuf(ring,sizeof(ring));
+    lcd.setNumeric(1,5);                        // b[1].val=5 + 3 terminators
+    NXT_CHECK_EQ(lcd.getTxPending(),13 - 8);
+    drain(emu,lcd);
+    NXT_CHECK_EQ(emu.num("0.1.val"),5);
+}
+
+
+/*
+ * removing the ring send first what is queued
+ */
+NXT_TEST(flushOnRemove){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    uint8_t ring[256];
+    lcd.init(115200,1,0,0);
+    lcd.setTxBuf(ring,sizeof(ring));
+    for(int i = 0; i < 10; i++) lcd.setNumeric(i + 1,i);
+    NXT_CHECK(lcd.getTxPending() > 0);
+    lcd.setTxBuf(NULL,0);
+    NXT_CHECK_EQ(lcd.getTxPending(),0);
+    emu.settle();
+    for(int i = 0; i < 10; i++) NXT_CHECK_EQ(emu.num("0." + std::to_string(i + 1) + ".val"),i);
+}
+
+
+/*
+ * data larger than the ring (transparent data) go to the port after the queued bytes
+ */
+NXT_TEST(oversize){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    uint8_t ring[NXT_BUF_SIZE];
+    lcd.init(115200,1,0,0);
+    lcd.setTxBuf(ring,sizeof(ring));
+    emu.clearLog();
+    for(int i = 0; i < 5; i++) lcd.setNumeric(i + 1,i);
+    uint8_t data[500];
+    for(int i = 0; i < 500; i++) data[i] = i & 0xFF;
+    NXT_CHECK_EQ(lcd.addWaveBytes(1,0,data,sizeof(data)),replyCmdOk);
+    drain(emu,lcd);
+    NXT_CHECK_EQ(emu.waves[4].size(),500);
+    NXT_CHECK(emu.waves[4] == std::vector<uint8_t>(data,data + 500));
+    NXT_CHECK(emu.log.size() >= 6);
+    if(emu.log.size() >= 6){
+        NXT_CHECK_STR(emu.log[4].c_str(),"b[5].val=4");
+        NXT_CHECK_EQ(emu.log[5].compare(0,5,"addt "),0);
+    }
+}
+
+
+/*
+ * with NXT_SERIAL_TYPE, a port keeping Print::availableForWrite() (always 0) is taken as
+ * blocking, not as full
+ */
+NXT_TEST(portFifo){
+    NXT_CHECK_EQ(nxtPortFifo<decltype(&SoftwareSerial::availableForWrite)>::known,0);
+    NXT_CHECK_EQ(nxtPortFifo<decltype(&HardwareSerial::availableForWrite)>::known,1);
+    NXT_CHECK_EQ(nxtPortFifo<decltype(&NxtEmu::availableForWrite)>::known,1);
+}
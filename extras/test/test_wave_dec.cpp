@@ -0,0 +1,146 @@
+/* test_wave_dec.cpp
+ *
+ * Host tests of the wave decimator (wave_dec.cpp): buffer checks, scaling, clipping,
+ * average and min/max points
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+#define WAVE    1
+
+
+/*
+ * points received by channel 0 of the wave
+ */
+static std::vector<uint8_t>& points(NxtEmu& emu){
+    emu.settle();
+    return emu.waves[WAVE * 4];
+}
+
+
+NXT_TEST(badBuffer){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    int16_t s[4] = {1, 2, 3, 4};
+    float f[4] = {1, 2, 3, 4};
+    uint8_t buf[4];
+    NxtWaveDec none(lcd,WAVE,0,NULL,64);
+    NXT_CHECK_EQ(none.add(s,4),invalidData);
+    NXT_CHECK_EQ(none.add(f,4),invalidData);
+    NXT_CHECK_EQ(none.getSamples(),0);
+    NXT_CHECK_EQ(none.flush(),replyCmdOk);
+    NxtWaveDec empty(lcd,WAVE,0,buf,0);
+    NXT_CHECK_EQ(empty.add(s,4),invalidData);
+    NxtWaveDec one(lcd,WAVE,0,buf,1);
+    NXT_CHECK_EQ(one.setDecimation(2,NXT_DEC_MINMAX),invalidData);
+    NXT_CHECK_EQ(one.setDecimation(2,NXT_DEC_AVG),replyCmdOk);
+    NXT_CHECK_EQ(one.add(s,4),replyCmdOk);
+    NXT_CHECK_EQ(one.flush(),replyCmdOk);
+    NXT_CHECK_EQ(points(emu).size(),2);
+}
+
+
+/*
+ * average of each group, scaled on the height; a partial group is not sent
+ */
+NXT_TEST(average){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    uint8_t buf[16];
+    NxtWaveDec dec(lcd,WAVE,0,buf,sizeof(buf));
+    dec.setScale(0,1000,101);           // 10 units each pixel
+    dec.setDecimation(4);
+    int16_t s[10] = {0, 10, 20, 38, 500, 500, 520, 520, 990, 990};
+    NXT_CHECK_EQ(dec.add(s,10),replyCmdOk);
+    NXT_CHECK_EQ(dec.flush(),replyCmdOk);
+    std::vector<uint8_t>& p = points(emu);
+    NXT_CHECK_EQ(p.size(),2);
+    if(p.size() == 2){
+        NXT_CHECK_EQ(p[0],2);           // 17 -> 1.7
+        NXT_CHECK_EQ(p[1],51);
+    }
+    NXT_CHECK_EQ(dec.getSamples(),10);
+}
+
+
+/*
+ * min and max of each group, in alternate order
+ */
+NXT_TEST(minMax){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    uint8_t buf[16];
+    NxtWaveDec dec(lcd,WAVE,0,buf,sizeof(buf));
+    dec.setScale(0,255,256);
+    dec.setDecimation(5,NXT_DEC_MINMAX);
+    int16_t s[15] = {50, 10, 200, 30, 40,     // spike kept
+                     100, 100, 100, 100, 100,
+                     0, 255, 1, 2, 3};
+    dec.add(s,15);
+    dec.flush();
+    std::vector<uint8_t>& p = points(emu);
+    const uint8_t want[6] = {10, 200, 100, 100, 0, 255};
+    NXT_CHECK_EQ(p.size(),6);
+    for(size_t i = 0; i < 6 && i < p.size(); i++) NXT_CHECK_EQ(p[i],want[i]);
+}
+
+
+/*
+ * out of range samples are clipped, NaN is drawn at the bottom; 'dis' scaling
+ */
+NXT_TEST(clipScale){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    uint8_t buf[16];
+    NxtWaveDec dec(lcd,WAVE,0,buf,sizeof(buf));
+    NXT_CHECK_EQ(dec.setScale(-1.0,1.0,201,200),replyCmdOk);     // top at 100
+    NXT_CHECK_EQ(dec.setScale(1.0,1.0,201),invalidData);
+    NXT_CHECK_EQ(dec.setScale(-1.0,1.0,201,5),invalidData);
+    float f[5] = {-5.0f, 5.0f, 0.0f, NAN, 1.0f};
+    dec.add(f,5);
+    dec.flush();
+    std::vector<uint8_t>& p = points(emu);
+    const uint8_t want[5] = {0, 100, 50, 0, 100};
+    NXT_CHECK_EQ(p.size(),5);
+    for(size_t i = 0; i < 5 && i < p.size(); i++) NXT_CHECK_EQ(p[i],want[i]);
+    NxtWaveDec iDec(lcd,WAVE,1,buf,sizeof(buf));
+    iDec.setScale(-100,100,256,100);
+    int16_t s[4] = {-32768, 32767, 0, -100};
+    iDec.add(s,4);
+    iDec.flush();
+    std::vector<uint8_t>& q = emu.waves[WAVE * 4 + 1];
+    NXT_CHECK_EQ(q.size(),4);
+    if(q.size() == 4){
+        NXT_CHECK_EQ(q[0],0);
+        NXT_CHECK_EQ(q[1],255);
+        NXT_CHECK(q[2] == 127 || q[2] == 128);
+        NXT_CHECK_EQ(q[3],0);
+    }
+}
+
+
+/*
+ * a full buffer is sent by add(), no point is lost
+ */
+NXT_TEST(autoFlush){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,0);
+    uint8_t buf[8];
+    NxtWaveDec dec(lcd,WAVE,0,buf,sizeof(buf));
+    dec.setDecimation(2,NXT_DEC_MINMAX);
+    int16_t s[100];
+    for(int i = 0; i < 100; i++) s[i] = i;
+    NXT_CHECK_EQ(dec.add(s,100),replyCmdOk);
+    dec.flush();
+    std::vector<uint8_t>& p = points(emu);
+    NXT_CHECK_EQ(p.size(),100);
+    for(size_t i = 0; i < p.size(); i++) NXT_CHECK_EQ(p[i],((i / 2) % 2) ? i ^ 1 : i);
+}
@@ -0,0 +1,119 @@
+/* test_xy.cpp
+ *
+ * Host tests of the XY touch coalescing (touch.cpp, nxt_xyLatest): press and release
+ * delivered as they are, moves merged in one event with the latest position
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+*/
+
+#include "nxt_test.h"
+
+
+static void drag(NxtEmu& emu, uint16_t x0, uint16_t n){
+    for(uint16_t i = 0; i < n; i++) emu.touchXY(x0 + i * 10,100 + i,1);
+}
+
+
+NXT_TEST(latest){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,1);
+    NXT_CHECK_EQ(lcd.setXYMode(nxt_xyLatest),replyCmdOk);
+    drag(emu,10,20);                    // press and 19 moves
+    emu.touchXY(500,300,0);
+    emu.settle();
+    lcd.poll();
+    nxtEvent_t ev;
+    NXT_CHECK_EQ(lcd.ckEvents(&ev),1);
+    NXT_CHECK_EQ(ev.evCode,cmdTouchXYaw);
+    NXT_CHECK_EQ(ev.event,1);
+    NXT_CHECK_EQ(ev.page_X,10);
+    NXT_CHECK_EQ(ev.compId_Y,100);
+    NXT_CHECK_EQ(lcd.ckEvents(&ev),1);
+    NXT_CHECK_EQ(ev.event,NXT_XY_MOVE);
+    NXT_CHECK_EQ(ev.page_X,10 + 19 * 10);
+    NXT_CHECK_EQ(ev.compId_Y,100 + 19);
+    NXT_CHECK_EQ(lcd.ckEvents(&ev),1);
+    NXT_CHECK_EQ(ev.event,0);
+    NXT_CHECK_EQ(ev.page_X,500);
+    NXT_CHECK_EQ(ev.compId_Y,300);
+    NXT_CHECK_EQ(lcd.ckEvents(&ev),0);
+    NXT_CHECK_EQ(lcd.getXYMerged(),18);
+}
+
+
+/*
+ * a move read from the queue is not updated any more, the next ones start a new one
+ */
+NXT_TEST(afterRead){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,1);
+    lcd.setXYMode(nxt_xyLatest);
+    drag(emu,10,5);
+    emu.settle();
+    lcd.poll();
+    nxtEvent_t ev;
+    lcd.ckEvents(&ev);
+    lcd.ckEvents(&ev);
+    NXT_CHECK_EQ(ev.event,NXT_XY_MOVE);
+    NXT_CHECK_EQ(ev.page_X,50);
+    drag(emu,100,3);                    // finger still down: all moves
+    emu.settle();
+    lcd.poll();
+    NXT_CHECK_EQ(lcd.ckEvents(&ev),1);
+    NXT_CHECK_EQ(ev.event,NXT_XY_MOVE);
+    NXT_CHECK_EQ(ev.page_X,120);
+    NXT_CHECK_EQ(lcd.ckEvents(&ev),0);
+}
+
+
+/*
+ * another event queued between moves: the moves after it are a new event
+ */
+NXT_TEST(otherEvent){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,1);
+    lcd.setXYMode(nxt_xyLatest);
+    drag(emu,10,4);
+    emu.touch(0,5,1);
+    drag(emu,200,3);
+    emu.settle();
+    lcd.poll();
+    nxtEvent_t ev;
+    lcd.ckEvents(&ev);                  // press
+    NXT_CHECK_EQ(lcd.ckEvents(&ev),1);
+    NXT_CHECK_EQ(ev.event,NXT_XY_MOVE);
+    NXT_CHECK_EQ(ev.page_X,40);
+    NXT_CHECK_EQ(lcd.ckEvents(&ev),1);
+    NXT_CHECK_EQ(ev.evCode,cmdTouchCompEv);
+    NXT_CHECK_EQ(ev.compId_Y,5);
+    NXT_CHECK_EQ(lcd.ckEvents(&ev),1);
+    NXT_CHECK_EQ(ev.event,NXT_XY_MOVE);
+    NXT_CHECK_EQ(ev.page_X,220);
+    NXT_CHECK_EQ(lcd.ckEvents(&ev),0);
+}
+
+
+/*
+ * without coalescing every sample is an event, as sent
+ */
+NXT_TEST(off){
+    NxtEmu emu(115200);
+    NxtLcd lcd(&emu);
+    lcd.init(115200,1,0,1);
+    drag(emu,10,4);
+    emu.touchXY(60,60,0);
+    emu.settle();
+    lcd.poll();
+    nxtEvent_t ev;
+    int n = 0;
+    while(lcd.ckEvents(&ev) > 0){
+        NXT_CHECK(ev.event != NXT_XY_MOVE);
+        n++;
+    }
+    NXT_CHECK_EQ(n,5);
+    NXT_CHECK_EQ(lcd.setXYMode(nxt_xyStroke + 1),invalidData);
+}
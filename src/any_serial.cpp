@@ -0,0 +1,338 @@
+/* any_serial.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the following class methods:
+ *
+ * anySerial :
+ * - setTxBuf()
+ * - write()
+ * - service()
+ * - flushTx()
+ * - setFlow()
+ * - ack()
+ * - mark()
+ * - overflow()
+ * - credit()
+ * - portWrite()
+ *
+ * NxtLcd public :
+ * - setTxBuf()
+ * - setFlowControl()
+ * - getFlowStats()
+ *
+ * NxtLcd private :
+ * - flowAck()
+ * - flowMark()
+ *
+ * Without a TX ring, write() return only when the whole command is in the port
+ * FIFO: at 9600 baud a 60 bytes command take about 60 ms. With the ring the command
+ * is queued and write() return at once; the bytes are moved to the port by service(),
+ * called by NxtLcd::poll() (so call it often from loop()), only as many as the port
+ * can accept without blocking.
+ * Before waiting for a reply the ring is always drained (flushTx()), so commands
+ * that read data from display, or pipeline/debug mode, work as usual.
+ *
+ * uint8_t txRing[128];
+ * lcd.setTxBuf(txRing,sizeof(txRing));
+ * ...
+ * loop(){
+ *   lcd.poll();
+ *   ...
+ * }
+ *
+ * At high baudrates the display can receive commands faster than it execute them,
+ * and when its input buffer (NXT_DEV_BUF_SIZE) is full it reply 0x24 and drop data.
+ * The flow controller (setFlowControl()) count the bytes sent and not yet consumed by
+ * the display, and send only while they are under NXT_FC_LIMIT: blocking writes wait,
+ * the TX ring just keep the bytes queued. Bytes are considered consumed:
+ * - at an estimated rate, starting at half the wire speed;
+ * - up to the end of a command when the display reply to it (bkcmd 1/3, gets): the
+ *   commands sure to get a reply are marked when written (flowMark()), and each reply
+ *   complete the oldest mark, so only the bytes written after it can still be there.
+ *   Error replies count only when every command is marked (bkcmd 1 or 3), see flowAck().
+ * Each reply raise a little the estimated rate, each 0x24 halve it and stop the sending
+ * until the buffer is modelled as empty again. Without flow control a 0x24 just hold
+ * the next write for NXT_REPLY_WAIT * 2 ms.
+ *
+*/
+
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+
+/*
+ * setTxBuf() - use "buf", of "size" bytes, as transmit ring. Pass NULL to go back to
+ * blocking writes; anything still queued is sent first.
+ */
+void anySerial::setTxBuf(uint8_t* buf, uint16_t size){
+    flushTx();
+    txBuf = (size > 0) ? buf : NULL;
+    txSize = (txBuf != NULL) ? size : 0;
+    txHead = 0;
+    txCnt = 0;
+}
+
+
+/*
+ * write() - queue "s" bytes in the ring, or write them to the port if there is no ring.
+ * If the ring is full we wait for room, data larger than the whole ring (es. transparent
+ * data) are written straight to the port after the queued bytes.
+ */
+size_t anySerial::write(const unsigned char* b, size_t s){
+    if(txBuf == NULL) return portWrite(b,s,1);
+    if(s > txSize){
+        flushTx();
+        return portWrite(b,s,1);
+    }
+    service();
+    if((size_t)(txSize - txCnt) < s) flushTx();
+    uint16_t tail = (txHead + txCnt) % txSize;
+    uint16_t n = txSize - tail;
+    if(n > s) n = s;
+    memcpy(&txBuf[tail],b,n);
+    if(n < s) memcpy(txBuf,&b[n],s - n);
+    txCnt += s;
+    service();
+    return s;
+}
+
+
+/*
+ * service() - move queued bytes to the port, as many as its FIFO can take now
+ */
+void anySerial::service(void){
+    while(txCnt > 0){
+        int room = anyPort::availableForWrite();
+        if(room <= 0) return;
+        uint16_t n = txSize - txHead;
+        if(n > txCnt) n = txCnt;
+        if(n > (uint16_t)room) n = room;
+        size_t sent = portWrite(&txBuf[txHead],n,0);
+        txHead = (txHead + sent) % txSize;
+        txCnt -= sent;
+        if(sent < n) return;
+    }
+}
+
+
+/*
+ * flushTx() - write all the queued bytes to the port, blocking as a plain write
+ */
+void anySerial::flushTx(void){
+    while(txCnt > 0){
+        uint16_t n = txSize - txHead;
+        if(n > txCnt) n = txCnt;
+        size_t sent = portWrite(&txBuf[txHead],n,1);
+        if(sent == 0) break;
+        txHead = (txHead + sent) % txSize;
+        txCnt -= sent;
+    }
+    if(txCnt == 0) txHead = 0;
+}
+
+
+/*
+ * setFlow() - enable the flow controller, allowing up to "limit" bytes in the display
+ * buffer; "baud" give the wire speed. limit=0 disable it.
+ */
+void anySerial::setFlow(uint16_t limit, uint32_t baud){
+    fcLimit = limit;
+    fcMax = (baud / 625 > 0) ? baud / 625 : 1;     // 1/16 of byte per ms
+    fcRate = (fcMax / 2 > 0) ? fcMax / 2 : 1;
+    fcUsed = 0;
+    fcLast = millis();
+    fcMarks = 0;
+}
+
+
+/*
+ * mark() - the command just written (or queued) will get "replies" replies, the last
+ * one meaning the display read it all. If the list is full it's merged with the newest
+ * mark, so its bytes are freed later, never earlier.
+ */
+void anySerial::mark(uint16_t replies){
+    if(fcLimit == 0 || replies == 0) return;
+    uint16_t pos = fcSent + txCnt;
+    if(fcMarks == NXT_FC_MARKS){
+        uint8_t last = (fcMarkHead + fcMarks - 1) % NXT_FC_MARKS;
+        fcMarkPos[last] = pos;
+        fcMarkCnt[last] += replies;
+        return;
+    }
+    uint8_t n = (fcMarkHead + fcMarks) % NXT_FC_MARKS;
+    fcMarkPos[n] = pos;
+    fcMarkCnt[n] = replies;
+    fcMarks++;
+}
+
+
+/*
+ * ack() - the display replied to the oldest marked command; when it's the last reply
+ * for it, only the bytes written after it can still be in the display buffer
+ */
+void anySerial::ack(void){
+    if(fcLimit == 0 || fcMarks == 0) return;
+    if(--fcMarkCnt[fcMarkHead] > 0) return;
+    uint16_t after = fcSent - fcMarkPos[fcMarkHead];
+    fcMarkHead = (fcMarkHead + 1) % NXT_FC_MARKS;
+    fcMarks--;
+    if((int16_t)after < 0) after = 0;
+    credit();                                   // the estimated consumption so far
+    if(after < fcUsed) fcUsed = after;
+    uint16_t step = (fcMax / 32 > 0) ? fcMax / 32 : 1;
+    fcRate = (fcMax - fcRate > step) ? fcRate + step : fcMax;
+}
+
+
+/*
+ * overflow() - the display replied 0x24, back off
+ */
+void anySerial::overflow(void){
+    fcOvfl++;
+    if(fcLimit == 0){
+        fcHold = millis() + NXT_REPLY_WAIT * 2;
+        fcHolding = 1;
+        return;
+    }
+    uint16_t min = (fcMax / 16 > 0) ? fcMax / 16 : 1;
+    fcRate = (fcRate / 2 > min) ? fcRate / 2 : min;
+    fcUsed = fcLimit;
+    fcLast = millis();
+}
+
+
+/*
+ * credit() - bytes that can be sent now
+ */
+uint16_t anySerial::credit(void){
+    uint32_t now = millis();
+    if(fcHolding){
+        if((int32_t)(now - fcHold) < 0) return 0;
+        fcHolding = 0;
+    }
+    if(fcLimit == 0) return NXT_TX_NOLIMIT;
+    uint32_t elapsed = now - fcLast;
+    if(elapsed > 60000) elapsed = 60000;
+    uint32_t done = elapsed * fcRate / 16;
+    if(done > 0){
+        fcUsed = (done >= fcUsed) ? 0 : fcUsed - done;
+        fcLast = now;
+    }
+    return (fcUsed < fcLimit) ? fcLimit - fcUsed : 0;
+}
+
+
+/*
+ * portWrite() - write to the port as many bytes as the credits allow; with "block"
+ * wait for the credits to send all of them
+ */
+size_t anySerial::portWrite(const unsigned char* b, size_t s, uint8_t block){
+    if(fcLimit == 0 && fcHolding == 0) return anyPort::write(b,s);
+    size_t done = 0;
+    while(done < s){
+        uint16_t c = credit();
+        if(c == 0){
+            if(block == 0) break;
+            yield();
+            continue;
+        }
+        size_t n = s - done;
+        if(n > c) n = c;
+        size_t sent = anyPort::write(&b[done],n);
+        if(fcLimit > 0){
+            fcUsed += sent;
+            fcSent += sent;
+        }
+        done += sent;
+        if(sent < n) break;
+    }
+    return done;
+}
+
+
+/*
+ * setTxBuf() - enable the non blocking transmit path, using the "buf" array of "size"
+ * bytes provided by user as TX ring; should be at least as large as the longest command
+ * (NXT_BUF_SIZE). Pass NULL to disable it.
+ */
+uint8_t NxtLcd::setTxBuf(uint8_t* buf, uint16_t size){
+    if(buf != NULL && size < NXT_BUF_SIZE) return invalidData;
+    serial.setTxBuf(buf,size);
+    return replyCmdOk;
+}
+
+
+/*
+ * setFlowControl() - enable (en=1) or disable (en=0) the flow controller, after init()
+ */
+uint8_t NxtLcd::setFlowControl(uint8_t en){
+    if(initialized == 0) return notInit;
+    if(en > 1) return invalidData;
+    serial.flushTx();
+    serial.setFlow(en ? NXT_FC_LIMIT : 0,baud);
+    return replyCmdOk;
+}
+
+
+/*
+ * getFlowStats() - return the bytes modelled in the display buffer and the number of
+ * 0x24 (buffer overflow) replies received
+ */
+uint8_t NxtLcd::getFlowStats(uint16_t* used, uint16_t* overflows){
+    if(initialized == 0) return notInit;
+    (*used) = serial.flowUsed();
+    (*overflows) = serial.flowOvfl();
+    return replyCmdOk;
+}
+
+
+/*
+ * flowAck() - called by readBuf() for each reply "res", that answer the oldest command
+ * marked by flowMark(). With bkcmd 0 or 2 (or not known) the commands not waiting for
+ * a reply are not marked, and their errors would complete the mark of a later get:
+ * errors count only with bkcmd 1 or 3, where every command is marked. An error to a
+ * marked get is then left to the next reply, freeing the credit late, never early.
+ */
+void NxtLcd::flowAck(uint8_t res){
+    switch(res){
+        case replyCmdFail:
+        case replyWrongId:
+        case replyWrongVar:
+            if((propValid & NXT_PROP_BIT(nxt_bkcmd)) == 0) break;
+            if(sysProp[nxt_bkcmd] != 1 && sysProp[nxt_bkcmd] != 3) break;
+            serial.ack();
+            break;
+        case replyCmdOk:
+        case replyGetNum:
+        case replyGetStr:
+        case replyTDReady:
+        case replyTDEnd:
+            serial.ack();
+            break;
+    }
+}
+
+
+/*
+ * flowMark() - the last "cmds" commands written are sure to get a reply each: "expReply"
+ * is set (gets, pipeline, waits for an ack) or bkcmd is 1 or 3. The marks tell the flow
+ * controller how much of the display buffer a reply frees, see flowAck().
+ */
+void NxtLcd::flowMark(uint8_t expReply, uint16_t cmds){
+    if(serial.flowLimit() == 0) return;
+    if(expReply == 0){
+        if((propValid & NXT_PROP_BIT(nxt_bkcmd)) == 0) return;
+        if(sysProp[nxt_bkcmd] != 1 && sysProp[nxt_bkcmd] != 3) return;
+    }
+    serial.mark(cmds);
+}
@@ -0,0 +1,462 @@
+/* async.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the following class methods:
+ *
+ * public :
+ * - setReqSlots()
+ * - getNumericAsync()
+ * - getStringAsync()
+ * - getObjAttrAsync()
+ * - getPropertyAsync()
+ * - reqStatus()
+ * - reqFlush()
+ *
+ * private:
+ * - reqSend()
+ * - reqWait()
+ * - reqDrain()
+ * - reqDone()
+ * - reqCall()
+ * - reqCheck()
+ *
+ * The async get functions send the request and return at once, with a handle in
+ * "handle"; "value" is filled later by poll() (or ckEvents()), when the reply arrives.
+ * The requests are kept in the "table" given to setReqSlots(), one slot for each request
+ * in flight (or completed and not yet read); without it the async functions return
+ * notSupported. The display answer them in the same order, so replies are matched in FIFO order. A request without reply for
+ * NXT_REQ_WAIT ms is completed with noReply, as the others in flight, and late replies
+ * are discarded (see rxResync() in basic_func.cpp).
+ * Completion can be checked with reqStatus(handle), that return noComplete while the
+ * request is pending, and the result (replyCmdOk or an error) once, freeing the slot;
+ * or a callback "cb" can be given, it's called with handle, result and "ctx" and the
+ * slot is freed just before (so reqStatus() is not needed, and new requests can be
+ * sent from the callback). Callbacks are called by poll() (or reqStatus(), reqFlush(),
+ * or a get*Async() needing the slot), never from inside the parser, as a command can be
+ * in sendBuf meanwhile; until then the slot is held.
+ * Any other (blocking) command wait for all the async requests to complete before
+ * being sent. "value" must stay valid until the request is completed.
+ *
+ * nxtReq_t slots[4];
+ * int32_t speed;
+ * uint8_t h;
+ * lcd.setReqSlots(slots,4);
+ * lcd.getNumericAsync(0,3,&speed,sizeof(speed),&h);
+ * ...
+ * loop(){
+ *   lcd.poll();
+ *   if(lcd.reqStatus(h) == replyCmdOk) ...
+ * }
+ *
+*/
+
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+// request types
+#define NXT_REQ_NUM     0
+#define NXT_REQ_STR     1
+#define NXT_REQ_PROP    2
+
+// slot states
+#define NXT_REQ_FREE    0
+#define NXT_REQ_PEND    1
+#define NXT_REQ_DONE    2
+#define NXT_REQ_CALL    3   //completed, callback not yet called
+
+
+/*
+ * setReqSlots() - enable the async requests, using the "table" array of "size" slots
+ * provided by user; size is the max number of requests in flight. The requests
+ * pending are completed first (results not yet read with reqStatus() are lost).
+ * Pass NULL to disable them.
+ */
+uint8_t NxtLcd::setReqSlots(nxtReq_t* table, uint8_t size){
+    if(table != NULL && size == 0) return invalidData;
+    if(reqSlot != NULL){
+        reqDrain();
+        reqCall();
+    }
+    reqSlot = table;
+    reqSize = (table != NULL) ? size : 0;
+    reqHead = 0;
+    reqCnt = 0;
+    reqCbHead = 0;
+    reqCbCnt = 0;
+    if(table != NULL) memset(table,0,size * sizeof(nxtReq_t));
+    return replyCmdOk;
+}
+
+
+/*
+ * getNumericAsync() - as getNumeric(), but don't wait for the reply
+ */
+uint8_t NxtLcd::getNumericAsync(const char* page, const char* field, void* value, uint8_t size,
+                                uint8_t* handle, nxtReqCb_t cb, void* ctx){
+    if(initialized == 0) return notInit;
+    if(size > 4) return invalidData;
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".val"));
+    cmdEnd();
+    return reqSend(NXT_REQ_NUM,value,size,handle,cb,ctx);
+}
+
+uint8_t NxtLcd::getNumericAsync(uint8_t page, uint8_t field, void* value, uint8_t size,
+                                uint8_t* handle, nxtReqCb_t cb, void* ctx){
+    if(initialized == 0) return notInit;
+    if(size > 4) return invalidData;
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".val"));
+    cmdEnd();
+    return reqSend(NXT_REQ_NUM,value,size,handle,cb,ctx);
+}
+
+uint8_t NxtLcd::getNumericAsync(const char* field, void* value, uint8_t size,
+                                uint8_t* handle, nxtReqCb_t cb, void* ctx){
+    if(initialized == 0) return notInit;
+    if(size > 4) return invalidData;
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(field);
+    cmdStrP(NXT_P(".val"));
+    cmdEnd();
+    return reqSend(NXT_REQ_NUM,value,size,handle,cb,ctx);
+}
+
+uint8_t NxtLcd::getNumericAsync(uint8_t field, void* value, uint8_t size,
+                                uint8_t* handle, nxtReqCb_t cb, void* ctx){
+    if(initialized == 0) return notInit;
+    if(size > 4) return invalidData;
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(field);
+    cmdStrP(NXT_P(".val"));
+    cmdEnd();
+    return reqSend(NXT_REQ_NUM,value,size,handle,cb,ctx);
+}
+
+
+/*
+ * getStringAsync() - as getString(), but don't wait for the reply. At most size-1
+ * characters are copied, "value" is always terminated.
+ */
+uint8_t NxtLcd::getStringAsync(const char* page, const char* field, char* value, uint16_t size,
+                               uint8_t* handle, nxtReqCb_t cb, void* ctx){
+    if(initialized == 0) return notInit;
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".txt"));
+    cmdEnd();
+    return reqSend(NXT_REQ_STR,value,size,handle,cb,ctx);
+}
+
+uint8_t NxtLcd::getStringAsync(uint8_t page, uint8_t field, char* value, uint16_t size,
+                               uint8_t* handle, nxtReqCb_t cb, void* ctx){
+    if(initialized == 0) return notInit;
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".txt"));
+    cmdEnd();
+    return reqSend(NXT_REQ_STR,value,size,handle,cb,ctx);
+}
+
+uint8_t NxtLcd::getStringAsync(const char* field, char* value, uint16_t size,
+                               uint8_t* handle, nxtReqCb_t cb, void* ctx){
+    if(initialized == 0) return notInit;
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(field);
+    cmdStrP(NXT_P(".txt"));
+    cmdEnd();
+    return reqSend(NXT_REQ_STR,value,size,handle,cb,ctx);
+}
+
+uint8_t NxtLcd::getStringAsync(uint8_t field, char* value, uint16_t size,
+                               uint8_t* handle, nxtReqCb_t cb, void* ctx){
+    if(initialized == 0) return notInit;
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(field);
+    cmdStrP(NXT_P(".txt"));
+    cmdEnd();
+    return reqSend(NXT_REQ_STR,value,size,handle,cb,ctx);
+}
+
+
+/*
+ * getObjAttrAsync() - as getObjAttr(), but don't wait for the reply
+ */
+uint8_t NxtLcd::getObjAttrAsync(const char* page, const char* obj, const char* attr, uint16_t* value,
+                                uint8_t* handle, nxtReqCb_t cb, void* ctx){
+    if(initialized == 0) return notInit;
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdEnd();
+    return reqSend(NXT_REQ_NUM,value,sizeof(uint16_t),handle,cb,ctx);
+}
+
+uint8_t NxtLcd::getObjAttrAsync(uint8_t page, uint8_t obj, const char* attr, uint16_t* value,
+                                uint8_t* handle, nxtReqCb_t cb, void* ctx){
+    if(initialized == 0) return notInit;
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdEnd();
+    return reqSend(NXT_REQ_NUM,value,sizeof(uint16_t),handle,cb,ctx);
+}
+
+uint8_t NxtLcd::getObjAttrAsync(const char* obj, const char* attr, uint16_t* value,
+                                uint8_t* handle, nxtReqCb_t cb, void* ctx){
+    if(initialized == 0) return notInit;
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdEnd();
+    return reqSend(NXT_REQ_NUM,value,sizeof(uint16_t),handle,cb,ctx);
+}
+
+uint8_t NxtLcd::getObjAttrAsync(uint8_t obj, const char* attr, uint16_t* value,
+                                uint8_t* handle, nxtReqCb_t cb, void* ctx){
+    if(initialized == 0) return notInit;
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdEnd();
+    return reqSend(NXT_REQ_NUM,value,sizeof(uint16_t),handle,cb,ctx);
+}
+
+
+/*
+ * getPropertyAsync() - as getProperty(), but don't wait for the reply. The local copy
+ * of the property is updated too when the reply arrives.
+ */
+uint8_t NxtLcd::getPropertyAsync(const char* prop, uint16_t* value,
+                                 uint8_t* handle, nxtReqCb_t cb, void* ctx){
+    if(initialized == 0) return notInit;
+    uint8_t propNdx = chkProperty(prop);
+    if(propNdx == 255) return invalidData;
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdStr(prop);
+    cmdEnd();
+    return reqSend(NXT_REQ_PROP,value,sizeof(uint16_t),handle,cb,ctx,propNdx);
+}
+
+uint8_t NxtLcd::getPropertyAsync(uint8_t prop, uint16_t* value,
+                                 uint8_t* handle, nxtReqCb_t cb, void* ctx){
+    if(initialized == 0) return notInit;
+    uint8_t propNdx = chkProperty(prop);
+    if(propNdx == 255) return invalidData;
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdStrP(sysPropNames[propNdx]);
+    cmdEnd();
+    return reqSend(NXT_REQ_PROP,value,sizeof(uint16_t),handle,cb,ctx,propNdx);
+}
+
+
+/*
+ * reqStatus() - return noComplete if the request "handle" is still pending, otherwise
+ * its result, freeing the slot. invalidData is returned for an unknown (or already
+ * freed) handle.
+ */
+uint8_t NxtLcd::reqStatus(uint8_t handle){
+    if(handle == 0 || handle > reqSize) return invalidData;
+    nxtReq_t* req = &reqSlot[handle - 1];
+    if(req->state == NXT_REQ_PEND || req->state == NXT_REQ_CALL) poll();
+    if(req->state == NXT_REQ_PEND || req->state == NXT_REQ_CALL) return noComplete;
+    if(req->state == NXT_REQ_FREE) return invalidData;
+    req->state = NXT_REQ_FREE;
+    return req->res;
+}
+
+
+/*
+ * reqFlush() - wait for all the requests in flight to complete and call their callbacks.
+ * "wait" is the max time (ms) to wait for each reply.
+ */
+uint8_t NxtLcd::reqFlush(uint16_t wait){
+    if(initialized == 0) return notInit;
+    while(reqCnt > 0) reqWait(wait);
+    reqCall();
+    return replyCmdOk;
+}
+
+
+/*
+ * reqSend() - send the request in sendBuf and queue it. If no slot is free, the pending
+ * callbacks are called (sendBuf is saved meanwhile) or we wait for the oldest request to
+ * complete; dataTooBig is returned if all the slots hold completed requests not yet
+ * read with reqStatus().
+ */
+uint8_t NxtLcd::reqSend(uint8_t type, void* dest, uint16_t size, uint8_t* handle,
+                        nxtReqCb_t cb, void* ctx, uint8_t prop){
+    if(reqSlot == NULL) return notSupported;
+    if(cmdOvfl > 0) return dataTooBig;
+    if(type == NXT_REQ_STR && size == 0) return invalidData;
+    rxPoll();
+    uint8_t slot = reqSize;
+    while(slot == reqSize){
+        rxSkipWait();
+        if(frameLen > 0) frameSend();
+        if(pipeCnt > 0) pipeFlush();
+        for(uint8_t i = 0; i < reqSize; i++){
+            if(reqSlot[i].state == NXT_REQ_FREE){
+                slot = i;
+                break;
+            }
+        }
+        if(slot < reqSize) break;
+        if(reqCbCnt > 0){
+            // slots held by callbacks not yet called: call them, keeping our request
+            uint8_t buf[NXT_BUF_SIZE];
+            uint16_t len = sendLen;
+            memcpy(buf,sendBuf,len);
+            reqCall();
+            memcpy(sendBuf,buf,len);
+            sendLen = len;
+            cmdOvfl = 0;
+        }
+        else if(reqCnt == 0) return dataTooBig;
+        else reqWait(NXT_REQ_WAIT);
+    }
+    if(serial.write((unsigned char *)sendBuf,sendLen) != sendLen) return replyCmdFail;
+    txSent(sendLen);
+    cmdSeq++;
+    flowMark(1);
+    nxtReq_t* req = &reqSlot[slot];
+    req->dest = dest;
+    req->size = size;
+    req->type = type;
+    req->prop = prop;
+    req->state = NXT_REQ_PEND;
+    req->res = noReply;
+    req->cb = cb;
+    req->ctx = ctx;
+    if(reqCnt == 0) reqStart = millis() + txLeftMs();
+    reqSlot[(reqHead + reqCnt) % reqSize].fifo = slot;
+    reqCnt++;
+    (*handle) = slot + 1;
+    return replyCmdOk;
+}
+
+
+/*
+ * reqWait() - read incoming telegrams until the oldest request is completed, or
+ * "wait" ms are elapsed (then it's completed as noReply, with the others in flight,
+ * see rxResync())
+ */
+void NxtLcd::reqWait(uint16_t wait){
+    uint8_t cnt = reqCnt;
+    if(cnt == 0) return;
+    serial.flushTx();
+    uint32_t start = millis() + txLeftMs();
+    while(reqCnt == cnt){
+        readEvent();
+        if((int32_t)(millis() - start) >= (int32_t)wait) break;
+    }
+    if(reqCnt == cnt) rxResync();
+}
+
+
+/*
+ * reqDrain() - wait for all the requests in flight to complete, without calling their
+ * callbacks: used before sending a command, that is already in sendBuf
+ */
+void NxtLcd::reqDrain(void){
+    while(reqCnt > 0) reqWait(NXT_REQ_WAIT);
+}
+
+
+/*
+ * reqDone() - complete the oldest request with reply "res", copying the data from
+ * recvBuf to the user variable
+ */
+void NxtLcd::reqDone(uint8_t res){
+    if(reqCnt == 0) return;
+    uint8_t slot = reqSlot[reqHead].fifo;
+    reqHead = (reqHead + 1) % reqSize;
+    reqCnt--;
+    reqStart = millis() + txLeftMs();
+    nxtReq_t* req = &reqSlot[slot];
+    if(res == replyGetNum){
+        if(req->type == NXT_REQ_STR) res = replyUnknown;
+        else{
+            memcpy(req->dest,&recvBuf[1],req->size);
+            if(req->type == NXT_REQ_PROP){
+                uint16_t v;
+                memcpy(&v,&recvBuf[1],sizeof(uint16_t));
+                propStore(req->prop,v);
+            }
+            res = replyCmdOk;
+        }
+    }
+    else if(res == replyGetStr){
+        if(req->type != NXT_REQ_STR) res = replyUnknown;
+        else{
+            uint16_t len = min((uint16_t)(req->size - 1),getStrLen);
+            memcpy(req->dest,&recvBuf[1],len);
+            ((char *)req->dest)[len] = 0;
+            res = replyCmdOk;
+        }
+    }
+    req->res = res;
+    req->state = NXT_REQ_DONE;
+    if(req->cb != NULL){
+        req->state = NXT_REQ_CALL;
+        reqSlot[(reqCbHead + reqCbCnt) % reqSize].cbFifo = slot;
+        reqCbCnt++;
+    }
+}
+
+
+/*
+ * reqCall() - call the callbacks of the completed requests, in completion order,
+ * freeing their slots. A callback can send new requests, their callbacks are called
+ * too if they complete meanwhile.
+ */
+void NxtLcd::reqCall(void){
+    while(reqCbCnt > 0){
+        uint8_t slot = reqSlot[reqCbHead].cbFifo;
+        reqCbHead = (reqCbHead + 1) % reqSize;
+        reqCbCnt--;
+        nxtReq_t* req = &reqSlot[slot];
+        req->state = NXT_REQ_FREE;
+        req->cb(slot + 1,req->res,req->ctx);
+    }
+}
+
+
+/*
+ * reqCheck() - complete as noReply the requests in flight, if the oldest is waiting
+ * since more than NXT_REQ_WAIT ms. The wait start when the bytes written so far
+ * should be on the wire (see txSent()), so a backlog in the TX ring is not counted.
+ */
+void NxtLcd::reqCheck(void){
+    if(reqCnt > 0 && (int32_t)(millis() - reqStart) >= NXT_REQ_WAIT) rxResync();
+}
@@ -100,12 +100,12 @@
  */
 uint8_t NxtLcd::getObjAttr(const char* page, const char* obj, const char* attr, uint16_t* value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get %s.%s.%s%c%c%c"),page,obj,attr,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"get %s.%s.%s%c%c%c",page,obj,attr,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         memcpy(value,&recvBuf[1],sizeof(uint16_t));
@@ -115,12 +115,12 @@ uint8_t NxtLcd::getObjAttr(const char* page, const char* obj, const char* attr,
 
 uint8_t NxtLcd::getObjAttr(uint8_t page, uint8_t obj, const char* attr, uint16_t* value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get p[%u].b[%u].%s%c%c%c"),page,obj,attr,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"get p[%u].b[%u].%s%c%c%c",page,obj,attr,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         memcpy(value,&recvBuf[1],sizeof(uint16_t));
@@ -131,12 +131,12 @@ uint8_t NxtLcd::getObjAttr(uint8_t page, uint8_t obj, const char* attr, uint16_t
 
 uint8_t NxtLcd::getObjAttr(const char* obj, const char* attr, uint16_t* value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get %s.%s%c%c%c"),obj,attr,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"get %s.%s%c%c%c",obj,attr,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         memcpy(value,&recvBuf[1],sizeof(uint16_t));
@@ -146,12 +146,12 @@ uint8_t NxtLcd::getObjAttr(const char* obj, const char* attr, uint16_t* value){
 
 uint8_t NxtLcd::getObjAttr(uint8_t obj, const char* attr, uint16_t* value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get b[%u].%s%c%c%c"),obj,attr,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"get b[%u].%s%c%c%c",obj,attr,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         memcpy(value,&recvBuf[1],sizeof(uint16_t));
@@ -164,47 +164,51 @@ uint8_t NxtLcd::getObjAttr(uint8_t obj, const char* attr, uint16_t* value){
  */
 uint8_t NxtLcd::setObjAttr(const char* page, const char* obj, const char* attr, uint16_t value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s.%s.%s=%u%c%c%c"),page,obj,attr,value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s.%s.%s=%u%c%c%c",page,obj,attr,value,NXT_MSG_END);
-#endif  
-    return writeBuf();
+    cmdStart();
+    cmdObj(page,obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdChar('=');
+    cmdUint(value);
+    cmdEnd();
+    return writeCached();
 }
 
 uint8_t NxtLcd::setObjAttr(uint8_t page, uint8_t obj, const char* attr, uint16_t value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("p[%u].b[%u].%s=%u%c%c%c"),page,obj,attr,value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"p[%u].b[%u].%s=%u%c%c%c",page,obj,attr,value,NXT_MSG_END);
-#endif    
-    return writeBuf();
+    cmdStart();
+    cmdObj(page,obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdChar('=');
+    cmdUint(value);
+    cmdEnd();
+    return writeCached();
 }
 
 
 uint8_t NxtLcd::setObjAttr(const char* obj, const char* attr, uint16_t value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s.%s=%u%c%c%c"),obj,attr,value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s.%s=%u%c%c%c",obj,attr,value,NXT_MSG_END);
-#endif    
-    return writeBuf();
+    cmdStart();
+    cmdObj(obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdChar('=');
+    cmdUint(value);
+    cmdEnd();
+    return writeCached();
 }
 
 uint8_t NxtLcd::setObjAttr(uint8_t obj, const char* attr, uint16_t value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("b[%u].%s=%u%c%c%c"),obj,attr,value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"b[%u].%s=%u%c%c%c",obj,attr,value,NXT_MSG_END);
-#endif    
-    return writeBuf();
+    cmdStart();
+    cmdObj(obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdChar('=');
+    cmdUint(value);
+    cmdEnd();
+    return writeCached();
 }
 
 
@@ -296,8 +300,12 @@ uint8_t NxtLcd::formatNumb(uint8_t obj, uint16_t len, uint8_t format){
 uint8_t NxtLcd::getObjAttr(const __FlashStringHelper* page, const __FlashStringHelper* obj, 
                                const __FlashStringHelper* attr, uint16_t* value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get %S.%S.%S%c%c%c"),page,obj,attr,NXT_MSG_END);
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         memcpy(value,&recvBuf[1],sizeof(uint16_t));
@@ -307,8 +315,12 @@ uint8_t NxtLcd::getObjAttr(const __FlashStringHelper* page, const __FlashStringH
 
 uint8_t NxtLcd::getObjAttr(uint8_t page, uint8_t obj, const __FlashStringHelper* attr, uint16_t* value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get p[%u].b[%u].%S%c%c%c"),page,obj,attr,NXT_MSG_END);
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         memcpy(value,&recvBuf[1],sizeof(uint16_t));
@@ -319,8 +331,12 @@ uint8_t NxtLcd::getObjAttr(uint8_t page, uint8_t obj, const __FlashStringHelper*
 
 uint8_t NxtLcd::getObjAttr(const __FlashStringHelper* obj, const __FlashStringHelper* attr, uint16_t* value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get %S.%S%c%c%c"),obj,attr,NXT_MSG_END);
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         memcpy(value,&recvBuf[1],sizeof(uint16_t));
@@ -330,8 +346,12 @@ uint8_t NxtLcd::getObjAttr(const __FlashStringHelper* obj, const __FlashStringHe
 
 uint8_t NxtLcd::getObjAttr(uint8_t obj, const __FlashStringHelper* attr, uint16_t* value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get b[%u].%S%c%c%c"),obj,attr,NXT_MSG_END);
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         memcpy(value,&recvBuf[1],sizeof(uint16_t));
@@ -342,31 +362,51 @@ uint8_t NxtLcd::getObjAttr(uint8_t obj, const __FlashStringHelper* attr, uint16_
 uint8_t NxtLcd::setObjAttr(const __FlashStringHelper* page, const __FlashStringHelper* obj, 
                                const __FlashStringHelper* attr, uint16_t value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%S.%S.%S=%u%c%c%c"),page,obj,attr,value,NXT_MSG_END);
-    return writeBuf();
+    cmdStart();
+    cmdObj(page,obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdChar('=');
+    cmdUint(value);
+    cmdEnd();
+    return writeCached();
 }
 
 uint8_t NxtLcd::setObjAttr(uint8_t page, uint8_t obj, const __FlashStringHelper* attr, uint16_t value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("p[%u].b[%u].%S=%u%c%c%c"),page,obj,attr,value,NXT_MSG_END);
-    return writeBuf();
+    cmdStart();
+    cmdObj(page,obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdChar('=');
+    cmdUint(value);
+    cmdEnd();
+    return writeCached();
 }
 
 
 uint8_t NxtLcd::setObjAttr(const __FlashStringHelper* obj, const __FlashStringHelper* attr, uint16_t value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%S.%S=%u%c%c%c"),obj,attr,value,NXT_MSG_END);
-    return writeBuf();
+    cmdStart();
+    cmdObj(obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdChar('=');
+    cmdUint(value);
+    cmdEnd();
+    return writeCached();
 }
 
 uint8_t NxtLcd::setObjAttr(uint8_t obj, const __FlashStringHelper* attr, uint16_t value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("b[%u].%S=%u%c%c%c"),obj,attr,value,NXT_MSG_END);
-    return writeBuf();
+    cmdStart();
+    cmdObj(obj);
+    cmdChar('.');
+    cmdStr(attr);
+    cmdChar('=');
+    cmdUint(value);
+    cmdEnd();
+    return writeCached();
 }
 
 uint8_t NxtLcd::setBackColor(const __FlashStringHelper* page, const __FlashStringHelper* obj, uint16_t value){
@@ -15,15 +15,26 @@
  * public :
  * - NxtLcd()
  * - init()
+ * - getInitTimes()
  * - devReset()
  * - ckEvents()
+ * - poll()
+ * - rxPush()
  * 
  * private:
  * - getPropCnt()
  * - chkProperty()
  * - writeBuf()
+ * - waitFor()
+ * - waitReply()
+ * - txSent()
+ * - txLeftMs()
+ * - rxFill()
  * - readBuf()
  * - readEvent()
+ * - rxPoll()
+ * - rxResync()
+ * - rxSkipWait()
  * 
 */
 
@@ -50,11 +61,17 @@
  * ********************************************************************************************************
  */
 
+#ifdef NXT_SERIAL_TYPE
+NxtLcd::NxtLcd(NXT_SERIAL_TYPE *port){
+    serial.init(port);
+    initialized = 0;
+}
+#else
+
 #ifdef NXT_HAVE_HS
 NxtLcd::NxtLcd(HardwareSerial *port){
     serial.init(port);
     initialized = 0;
-    haveEvent = 0;
 }
 #endif
 
@@ -62,7 +79,6 @@ NxtLcd::NxtLcd(HardwareSerial *port){
 NxtLcd::NxtLcd(USARTClass *port){
     serial.init(port);
     initialized = 0;
-    haveEvent = 0;
 }
 #endif
 
@@ -70,7 +86,6 @@ NxtLcd::NxtLcd(USARTClass *port){
 NxtLcd::NxtLcd(Serial_ *port){
     serial.init(port);
     initialized = 0;
-    haveEvent = 0;
 }
 #endif
 
@@ -79,9 +94,26 @@ NxtLcd::NxtLcd(Serial_ *port){
 NxtLcd::NxtLcd(SoftwareSerial *port){
     serial.init(port);
     initialized = 0;
-    haveEvent = 0;
 }
 #endif
+
+#ifdef NXT_STREAM_SERIAL
+NxtLcd::NxtLcd(Stream *port){
+    serial.init(port);
+    initialized = 0;
+}
+#endif
+#endif //NXT_SERIAL_TYPE
+/*
+ * nxtInitPropCb() - completion of the property requests sent by init(), "ctx" point to
+ * the first error
+ */
+static void nxtInitPropCb(uint8_t handle, uint8_t res, void* ctx){
+    (void)handle;
+    if(res != replyCmdOk && *(uint8_t *)ctx == replyCmdOk) *(uint8_t *)ctx = res;
+}
+
+
 /*****************************************************************************************************
  * init() - initialize serial port with baudrate indicated, doing an optional reset and setting
  * debug (dbg=1) or not (dbg=0). Almost of the commands, if succesful, does not return anything
@@ -90,23 +122,99 @@ NxtLcd::NxtLcd(SoftwareSerial *port){
  * leave it at 0. See also setBkcmd().
  * "dspType" is display type, range 0-2, 0:basic; 1:ehnached; 2:professional
  * On nextion display baudrate can be changed setting bauds=<baudrate> in first page’s 
- * Preinitialization Event of HMI. 
+ * Preinitialization Event of HMI, or at runtime with setBaud(). With baudrate=0 the
+ * display rate is probed (see findBaud()).
+ * "propMode" (see propMode_t) choose how the local copy of the system properties is filled:
+ *  - nxt_propEager : one get after the other, each waiting for its reply (the old way)
+ *  - nxt_propLazy  : only the current page is read now (names and journal need it);
+ *                    getProperty(...,loc=1) ask the display the others the first time
+ *                    they are needed, and only that one
+ *  - nxt_propPipe  : the gets are sent back to back as async requests (see async.cpp),
+ *                    the replies are parsed while the next requests are sent; the
+ *                    slots set by setReqSlots() are used, or NXT_REQ_SLOTS on the stack
+ * With a snapshot set (see snapshot.cpp) and no reset, the properties are taken from the
+ * snapshot when it's still valid, and a new one is saved after reading them otherwise;
+ * with nxt_propLazy nothing is known yet, so no snapshot is saved: call saveSnapshot()
+ * once the properties needed have been read.
+ * getInitTimes() return how long the reset and the properties reading took.
  * ****************************************************************************************************
  */
-uint8_t NxtLcd::init(uint32_t bauds, uint8_t dspType, uint8_t reset, uint8_t dbg){
-    serial.begin(bauds);
+uint8_t NxtLcd::init(uint32_t bauds, uint8_t dspType, uint8_t reset, uint8_t dbg, uint8_t propMode){
+#ifdef NXT_DISP_TYPE
+    if(dspType != NXT_DISP_TYPE) return invalidData;
+#endif
+    if(propMode > nxt_propPipe) return invalidData;
+    baud = (bauds > 0) ? bauds : 9600;
+    serial.begin(baud);
     initialized = 1;
+#ifndef NXT_DISP_TYPE
     dispType = dspType;
+#endif
     debug = dbg;
-    uint8_t res = replyCmdFail;
+    propValid = 0;
+    initMs[0] = 0;
+    initMs[1] = 0;
+    uint8_t res = replyCmdOk;
     uint8_t propCnt = getPropCnt();
+    if(bauds == 0){
+        uint32_t found;
+        res = findBaud(&found);
+        if(res != replyCmdOk) return res;
+    }
+    baudBoot = baud;
+    uint32_t start = millis();
     if(reset) res = devReset();
+    initMs[0] = millis() - start;
     if(res != replyCmdOk) return res;
-    //char buf[7];
-    for(uint8_t i = 0; i < propCnt; i++){
-        res = getProperty(i,&sysProp[i]);
-        if(res != replyCmdOk) return res;
+    start = millis();
+    warmBoot = 0;
+    if(reset == 0 && snapIo != NULL && snapLoad() == replyCmdOk){
+        warmBoot = 1;
+        initMs[1] = millis() - start;
+        return replyCmdOk;
+    }
+    if(propMode == nxt_propPipe){
+        uint8_t h;
+        uint8_t err = replyCmdOk;
+        nxtReq_t slots[NXT_REQ_SLOTS];          // if the user gave none, only for these gets
+        uint8_t local = (reqSlot == NULL);
+        if(local) setReqSlots(slots,NXT_REQ_SLOTS);
+        for(uint8_t i = 0; i < propCnt && err == replyCmdOk; i++){
+            res = getPropertyAsync(i,&sysProp[i],&h,nxtInitPropCb,&err);
+            if(res != replyCmdOk) break;
+        }
+        reqFlush();
+        if(local) setReqSlots(NULL,0);
+        if(res == replyCmdOk) res = err;
+    }
+    else if(propMode == nxt_propLazy){
+        uint16_t page;
+        res = getProperty(nxt_dp,&page);
+    }
+    else if(propMode == nxt_propEager){
+        //char buf[7];
+        for(uint8_t i = 0; i < propCnt; i++){
+            res = getProperty(i,&sysProp[i]);
+            if(res != replyCmdOk) break;
+        }
+    }
+    initMs[1] = millis() - start;
+    if(res == replyCmdOk && snapIo != NULL){
+        if(propMode == nxt_propLazy) snapDirty = 1;
+        else saveSnapshot(1);
     }
+    return res;
+}
+
+
+/*
+ * getInitTimes() - return the ms spent by last init() resetting the display and
+ * reading the system properties
+ */
+uint8_t NxtLcd::getInitTimes(uint16_t* resetMs, uint16_t* propMs){
+    if(initialized == 0) return notInit;
+    (*resetMs) = initMs[0];
+    (*propMs) = initMs[1];
     return replyCmdOk;
 }
 
@@ -117,6 +225,9 @@ uint8_t NxtLcd::init(uint32_t bauds, uint8_t dspType, uint8_t reset, uint8_t dbg
  * **********************************************************************************
  */
 uint8_t NxtLcd::getPropCnt(){
+#ifdef NXT_DISP_TYPE
+    return NXT_PROP_CNT;
+#else
     uint8_t propCnt = sysPropLen;
     switch(dispType){
         case nxt_basic:
@@ -127,6 +238,7 @@ uint8_t NxtLcd::getPropCnt(){
             break;
     }
     return propCnt;    
+#endif
 }
 
 
@@ -161,110 +273,209 @@ uint8_t NxtLcd::chkProperty(uint8_t prop){
 
 /*****************************************************************************************
  * devReset() - reset the display, can be optionally done in init()
+ * The display restart at its boot rate, with bkcmd=2: a rate set with setBaud() (not
+ * persisted) and the pipeline mode are set again.
  */
 uint8_t NxtLcd::devReset(void){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("rest%c%c%c"),NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"rest%c%c%c",NXT_MSG_END);
-#endif
-    uint8_t res = writeBuf(replyStartUp,500);//readBuf();
-    if(res == replyCmdOk) return (readBuf()==replyDevReady ? replyCmdOk : replyCmdFail);
-    else return replyCmdFail;
+    uint32_t rate = baud;
+    uint8_t pipe = pipeEn;
+    if(pipeCnt > 0) pipeFlush();
+    pipeEn = 0;
+    uint8_t res = replyCmdOk;
+    if(baud != baudBoot) res = setBaud(baudBoot);
+    if(res == replyCmdOk){
+        cmdStart();
+        cmdStrP(NXT_P("rest"));
+        cmdEnd();
+        shadowClear();
+        propValid = 0;
+        res = writeBuf(replyStartUp,500);//readBuf();
+        if(res == replyCmdOk) res = (waitReply(500)==replyDevReady ? replyCmdOk : replyCmdFail);
+        else res = replyCmdFail;
+        if(res == replyCmdOk) propStore(nxt_dp,0);
+    }
+    journalClear();
+    uint8_t rec = jrnRecover(rate,pipe);
+    return (res == replyCmdOk) ? rec : res;
 }
 
 
 /******************************************************************************************
- *  writeBuf() - write the prev. setted buffer to lcd device, reading the ev. answer
- *  "wait" are ms to wait for an answer
+ *  writeBuf() - write the command built in sendBuf (see cmd_buf.cpp) to lcd device, reading the ev. answer
+ *  "wait" are ms to wait for an answer; this is a deadline, not a fixed delay : we return
+ *  as soon as a complete reply has been parsed (see waitReply()). The command (and the ones
+ *  written before without waiting) can still be in the port FIFO when write() return, so
+ *  the deadline start when they should be all sent (txEnd).
  *  "size" can be specified in some cases (using transparent mode)
  */
 uint8_t NxtLcd::writeBuf(uint8_t expReply, uint16_t wait,uint16_t size){
     if(initialized == 0) return notInit;
-    uint8_t ret = replyCmdFail;
-    readEvent();
+    rxPoll();
+    rxSkipWait();
+    if(reqCnt > 0) reqDrain();
+    if(frameEn > 0 && expReply == 0 && size == 0) return frameAdd();
+    if(frameLen > 0) frameSend();
+    if(pipeEn > 0 && expReply == 0 && size == 0) return pipeWrite();
+    if(pipeCnt > 0) pipeFlush();
     if( size == 0){
-        if(strlen((char *)sendBuf) > 0){
-            serial.write((unsigned char *)sendBuf,strlen((char *)sendBuf));
-            if(expReply > 0 || debug > 0){
-                delay(wait); 
-            }
-            else return replyCmdOk;
+        if(cmdOvfl > 0) return dataTooBig;
+        if(sendLen > 0){
+            serial.write((unsigned char *)sendBuf,sendLen);
+            txSent(sendLen);
+            cmdSeq++;
+            flowMark(expReply);
+            if(expReply == 0 && debug == 0) return replyCmdOk;
         }
         else return invalidData;
     }
     else{
         size_t sent = serial.write((unsigned char *)sendBuf,size);
         if(sent != size) return replyCmdFail;
-        if(expReply > 0 || debug > 0){
-            delay(wait); 
-        }
-        else return replyCmdOk;
+        txSent(size);
+        cmdSeq++;
+        flowMark(expReply);
+        if(expReply == 0 && debug == 0) return replyCmdOk;
     }
-    uint8_t res = readBuf();
-    if(res == replyTouchEv || res == replySleepEv || res == replySendMe){      
-        readEvent(recvBuf);
-        res = readBuf();
+    return waitFor(expReply,wait + txLeftMs());
+}
+
+
+/******************************************************************************************
+ *  waitFor() - wait for the reply to a command just sent, handling the events that can
+ *  arrive meanwhile. "expReply" is the expected reply code, if 0 no reply (or a cmd ok)
+ *  is a success. "wait" are max ms to wait.
+ */
+uint8_t NxtLcd::waitFor(uint8_t expReply, uint16_t wait){
+    uint8_t ret = replyCmdFail;
+    uint32_t start = millis();
+    uint8_t res = waitReply(wait);
+    while(res == replyTouchEv || res == replySleepEv || res == replySendMe){      
+        readEvent(1);
+        uint32_t elapsed = millis() - start;
+        res = waitReply(elapsed < wait ? wait - elapsed : 0);
     }
     if(expReply > 0){
         if(res == expReply) ret = replyCmdOk;
         else ret = res;          
+        if(res == noReply || res == noComplete) rxResync();  // the (rest of the) reply can still come, see rxResync()
     }
     else{
         if(res == noReply || res == replyCmdOk) ret = replyCmdOk;
         else ret = res;
+        if(res == noComplete) rxResync();
     }
     return ret;    
 }
 
 
+/******************************************************************************************
+ *  waitReply() - poll the serial port until a complete telegram has been parsed, or 
+ *  "wait" ms are elapsed. At 115200 baud a 4 bytes ack arrive in well under 1 ms, so
+ *  returning as soon as the frame is complete save almost all the reply wait time.
+ *  Note that with bkcmd=2 (default) a successful command has no reply at all, so in 
+ *  that case the whole "wait" is still spent (see setBkcmd()).
+ */
+uint8_t NxtLcd::waitReply(uint16_t wait){
+    serial.flushTx();
+    uint32_t start = millis();
+    uint8_t res = readBuf();
+    while(res == noReply || res == noComplete){
+        if((uint32_t)(millis() - start) >= wait) break;
+        res = readBuf();
+    }
+    return res;
+}
+
+
+/******************************************************************************************
+ *  txSent() - "len" bytes have been written to the port: move txEnd, the estimated time
+ *  (us) the port finish sending them, 10 bits each. At 9600 baud a 20 bytes command
+ *  take 21 ms, more than NXT_REPLY_WAIT.
+ */
+void NxtLcd::txSent(uint16_t len){
+    uint32_t now = micros();
+    if((int32_t)(txEnd - now) < 0) txEnd = now;
+    if(baud >= 100) txEnd += (uint32_t)len * 100000UL / (baud / 100);     // no overflow for len < 42000
+}
+
+
+/******************************************************************************************
+ *  txLeftMs() - ms until the bytes written so far should be all sent (txEnd), rounded up
+ */
+uint16_t NxtLcd::txLeftMs(void){
+    int32_t left = txEnd - micros();
+    return (left > 0) ? (left + 999) / 1000 : 0;
+}
+
+
 /***************************************************************************************
- *  readBuf() - read a telegram from lcd device and store in buffer
- *  "ckevt" if set to 1 we are checking for an event, with limited buffer
+ *  rxPush() - store an incoming byte into the rx ring. This is the producer side of
+ *  the ring, and can be called from an UART ISR (or a polling task), at most from one
+ *  context. If the ring is full the byte is dropped, counted and 0 is returned.
+ *  Please note that rxFill(), called by the class itself, is also a producer, so if
+ *  you feed the ring from an ISR the serial passed to the constructor must not receive
+ *  the same data.
  */
-uint8_t NxtLcd::readBuf(uint8_t ckevt){
+uint8_t NxtLcd::rxPush(uint8_t b){
+    uint8_t next = (rxHead + 1) & (NXT_RX_RING_SIZE - 1);
+    if(next == rxTail){
+        rxDropped++;
+        return 0;
+    }
+    rxRing[rxHead] = b;
+    rxHead = next;
+    return 1;
+}
+
+
+/***************************************************************************************
+ *  rxFill() - move the bytes available on serial port to the rx ring, as long as 
+ *  there is room for them (the others are left in the serial buffer)
+ */
+void NxtLcd::rxFill(void){
+    while(((rxHead + 1) & (NXT_RX_RING_SIZE - 1)) != rxTail && serial.available()){
+        rxPush(serial.read());
+    }
+}
+
+
+/***************************************************************************************
+ *  readBuf() - read a telegram from the rx ring and store it in recvBuf.
+ *  The parser state (rxCnt, rxExpLen) is kept in the instance, so a partial telegram
+ *  is resumed on next call; a complete telegram is returned as soon as its last byte
+ *  is read, the remaining bytes are left in the ring.
+ */
+uint8_t NxtLcd::readBuf(void){
     if(initialized == 0) return notInit;
-    static uint16_t cntStatic = 0;
-    uint16_t cnt = 0;
-    static uint8_t expLen = 3;
-    //uint32_t cnt = 0;
-    uint8_t         ret = noReply;
-    //const char cmdEnd[] = {NXT_MSG_END,'\0'};
-    if(ckevt > 0){
-        cnt = cntStatic;
-        //memset(recvBuf,0,NXT_EV_BUF_SIZE);
-    } 
-    else {
-        bufReset(recvBuf);
-        cntStatic = 0;
-    } 
-    
-    while(serial.available()){
-        recvBuf[cnt] = serial.read();
+    uint8_t         ret = (rxCnt > 0) ? noComplete : noReply;
+    rxFill();
+    while(rxTail != rxHead){
+        uint16_t cnt = rxCnt;
+        recvBuf[cnt] = rxRing[rxTail];
+        rxTail = (rxTail + 1) & (NXT_RX_RING_SIZE - 1);
         if(cnt == 0){
             switch(recvBuf[0]){
                 case cmdTouchCompEv:  //0x65
-                    expLen = 6;
+                    rxExpLen = 6;
                     break;
                 case cmdTouchXYaw:    //0x67  
                 case cmdTouchXYsl:    //0x68
-                    expLen = 8;
+                    rxExpLen = 8;
                     break;
                 case cmdGetStr:       //0x70
                 case cmdSendme:       //0x66
-                    expLen = 4;
+                    rxExpLen = 4;
                     break;
                 case cmdGetNum:       //0x71
-                    expLen = 7;
+                    rxExpLen = 7;
                     break;
                 default:
-                    expLen = 3;
+                    rxExpLen = 3;
             }
         }
         ret = noComplete;
-        if(cnt >=expLen && recvBuf[cnt] == 0xFF){ // we can already have a reply
+        if(cnt >= rxExpLen && recvBuf[cnt] == 0xFF){ // we can already have a reply
             if(recvBuf[cnt-1] == 0xFF && recvBuf[cnt-2] == 0xFF){ //now we have valid reply
                 ret = replyUnknown;
                 switch(recvBuf[0]){
@@ -272,6 +483,7 @@ uint8_t NxtLcd::readBuf(uint8_t ckevt){
                         // but 3 0x00 means device startup
                         if(recvBuf[1] == 0x00 && recvBuf[2] == 0x00 && cnt == 5){
                             ret = replyStartUp; 
+                            jrnRestart(0);
                             //serialLogStr("replyStartUp hit!!");
                         }
                         if(cnt == 3){
@@ -286,6 +498,7 @@ uint8_t NxtLcd::readBuf(uint8_t ckevt){
                     case cmdDevReady: //0x88
                         if(cnt == 3){
                             ret = replyDevReady;
+                            jrnRestart(1);
                         }
                         break;
                     case cmdInvalidCid:   //0x02
@@ -304,7 +517,7 @@ uint8_t NxtLcd::readBuf(uint8_t ckevt){
                         break;
                     case cmdBufOvfl:  //0x24
                         if(cnt == 3){
-                            delay(NXT_REPLY_WAIT * 2); // wait a little before sending other cmds
+                            serial.overflow();  // next writes are held back, see any_serial.cpp
                             ret = replyBufOvfl;
                         }
                         break;
@@ -313,18 +526,21 @@ uint8_t NxtLcd::readBuf(uint8_t ckevt){
                         //serialLogInt("case cmdTouchCompEv , cnt",cnt);
                         if(cnt == 6){
                             lastTouchCode = cmdTouchCompEv;
+                            pageSure = 0;   // the touch can change page, see resolver.cpp
                             ret = replyTouchEv;
                         }
                         break;
                     case cmdTouchXYaw: //0x67
                         if(cnt == 8){
                             lastTouchCode = cmdTouchXYaw;
+                            pageSure = 0;
                             ret = replyTouchEv;
                         }
                         break;
                     case cmdTouchXYsl: //0x68   
                         if(cnt == 8){
                             lastTouchCode = cmdTouchXYsl;
+                            pageSure = 0;
                             ret = replyTouchEv;
                         }
                         break;
@@ -333,6 +549,7 @@ uint8_t NxtLcd::readBuf(uint8_t ckevt){
                         //serialLogStr("cmdSleep trig");
                         if(cnt == 3){
                             lastTouchCode = recvBuf[0];
+                            pageSure = 0;
                             ret = replySleepEv;
                         }
                         else lastTouchCode = 11;
@@ -351,7 +568,8 @@ uint8_t NxtLcd::readBuf(uint8_t ckevt){
                         break;
                     case cmdSendme: //0x66
                         if(cnt == 4){
-                            //currPage = recvBuf[1];
+                            propStore(nxt_dp,recvBuf[1]);
+                            shadowClear();
                             ret = replySendMe;
                         }
                         break; 
@@ -367,110 +585,190 @@ uint8_t NxtLcd::readBuf(uint8_t ckevt){
                         break;
                         
                 } //switch(recvBuf[0])
-                //bufReset(recvBuf);
-                //uint8_t myCnt = cnt;
-                cnt = 0;
-                cntStatic =0;
-                expLen = 3;
-                //break;
+                rxCnt = 0;
+                rxExpLen = 3;
                 if(ret == replyUnknown ){
                     wrongIdCode = recvBuf[0];
-                    //serialLogHex("readBuf replyUnknown start code",wrongIdCode);
-                    //serialLogInt("readBuf replyUnknown cnt",myCnt);
-                    //serialLogStr("readBuf replyUnknown recvBuf",(char *)recvBuf);
-                    
                 } 
+                flowAck(ret);
                 return ret;
             } //if NXT_MSG_END found
         } // if possible answer
-        cnt++;
-        if(ckevt > 0){
-            if(cnt == NXT_EV_BUF_SIZE){
-                ret = bufOvfl;
-                cnt = 0;
-                cntStatic = 0;
-                //bufReset(recvBuf);
-                memset(recvBuf,0,NXT_EV_BUF_SIZE);
-                break;
-            }
-        }
-        else{
-            if(cnt == NXT_BUF_SIZE){
-                ret = bufOvfl;
-                cnt = 0;
-                cntStatic = 0;
-                bufReset(recvBuf);
-                break;
-            }
+        rxCnt++;
+        if(rxCnt == NXT_BUF_SIZE){
+            ret = bufOvfl;
+            rxCnt = 0;
+            rxExpLen = 3;
+            break;
         }
-        cntStatic = cnt;
-        //if(ret == noComplete ) wrongIdCode = recvBuf[0];
-    } //while serial.available
+        if(rxTail == rxHead) rxFill();
+    } //while ring not empty
     return ret;
 }
 
 /******************************************************************************
- *  readEvent() - read an event, and copy it to lastEvent struct.
- *  "ebuf" - if present, is the buffer to read from, and we already know that
- *  an event is present; if NULL event presence will be checked.
- *  If an event is present, the haveEvent flag is raised
+ *  readEvent() - read an event, and add it to the event queue.
+ *  "parsed" - if set, recvBuf already hold an event telegram; if 0 a telegram
+ *  will be read and checked for an event.
+ *  If the queue is full the new event is dropped and counted, see getEvDropped()
+ *  With the handler table in filter mode, events without handler are dropped here
+ *  (see dispatch.cpp)
+ *  Replies to async requests found here are passed to reqDone(), in pipeline mode
+ *  replies to in flight commands are passed to pipeAck(); after a timeout they are
+ *  discarded instead, see rxResync()
  */
-uint8_t NxtLcd::readEvent(uint8_t* ebuf){
+uint8_t NxtLcd::readEvent(uint8_t parsed){
     if(initialized == 0) return notInit;
-    //static uint8_t evBuf[NXT_EV_BUF_SIZE];
-    uint8_t res = noComplete;//readBuf();
-    uint8_t* buf; 
-    if(ebuf == NULL){
-        recvBuf = evtBuf;
-        res = readBuf(1);
-        buf = evtBuf;
-    }
-    else buf = ebuf;
-    //if(res != noReply) serialLogHex("ckEvents evBuf",(*evBuf));
-    if(ebuf != NULL || res == replyTouchEv || res == replySleepEv || res == replySendMe){
-        memset(&lastEvent,0,sizeof(nxtEvent_t));
-        lastEvent.evCode = buf[0];
-        //switch(lastTouchCode){
+    uint8_t res = noComplete;
+    uint8_t* buf = recvBuf; 
+    if(rxSkip > 0 && (int32_t)(millis() - rxSkipAt) >= 0) rxSkip = 0;
+    if(parsed == 0) res = readBuf();
+    if(parsed != 0 || res == replyTouchEv || res == replySleepEv || res == replySendMe){
+        nxtEvent_t ev;
+        memset(&ev,0,sizeof(nxtEvent_t));
+        ev.evCode = buf[0];
         switch(buf[0]){
             case cmdTouchCompEv:
-                lastEvent.page_X = buf[1];
-                lastEvent.compId_Y = buf[2];
-                lastEvent.event = buf[3];
+                ev.page_X = buf[1];
+                ev.compId_Y = buf[2];
+                ev.event = buf[3];
                 break;
             case cmdTouchXYaw:
             case cmdTouchXYsl:
-                lastEvent.page_X = buf[2] | (buf[1] << 8);
-                lastEvent.compId_Y = buf[4] | (buf[3] << 8);
-                lastEvent.event = buf[5];
+                ev.page_X = buf[2] | (buf[1] << 8);
+                ev.compId_Y = buf[4] | (buf[3] << 8);
+                ev.event = buf[5];
                 break;
             case cmdSleepOn:
             case cmdSleepOff:
                 break;
             case cmdSendme:
-                lastEvent.page_X = buf[1];
+                ev.page_X = buf[1];
                 break;
         }
-        memset(evtBuf,0,NXT_EV_BUF_SIZE);
-        haveEvent = 1;
+        if(xyMode > nxt_xyOff && (ev.evCode == cmdTouchXYaw || ev.evCode == cmdTouchXYsl)){
+            if(xyCoalesce(&ev) > 0) return res;  // merged with the previous move
+        }
+        uint8_t hnd = hndMatch(&ev);
+        if(hnd == 255 && hndFilter > 0){
+            evFiltered++;   // nobody subscribed, don't queue it
+            return res;
+        }
+        if(evCnt == NXT_EV_QUEUE_SIZE){
+            evDropped++;
+            return res;
+        }
+        uint8_t slot = (evHead + evCnt) % NXT_EV_QUEUE_SIZE;
+        memcpy(&evQueue[slot],&ev,sizeof(nxtEvent_t));
+        evHnd[slot] = hnd;
+        evCnt++;
     }
-    if(ebuf == NULL){
-        recvBuf = sendBuf;
+    else if(rxSkip > 0){
+        if(res != noReply && res != noComplete) rxSkipAt = millis() + NXT_REPLY_WAIT;
+    }
+    else if(reqCnt > 0){
+        switch(res){
+            case replyGetNum:
+            case replyGetStr:
+            case replyCmdFail:
+            case replyWrongId:
+            case replyWrongVar:
+            case replyBufOvfl:
+            case replyUnknown:
+                reqDone(res);
+                break;
+        }
+    }
+    else if(pipeCnt > 0 || frameAcks > 0){
+        switch(res){
+            case replyCmdOk:
+            case replyCmdFail:
+            case replyWrongId:
+            case replyWrongVar:
+            case replyBufOvfl:
+            case replyUnknown:
+                pipeAck(res);
+                break;
+        }
     }
     return res;
 }
 
 
 /**************************************************************************************
- *  ckEvents() - check for incoming event, and copy it to lastEvt struct passed.
- *  after copyng, haveEvent is set to 0
+ *  rxResync() - a reply did not arrive (or did not end) in time: it can still come, late, and be taken
+ *  as the reply of the next command, so replies are no more matched in FIFO order.
+ *  All the commands and requests in flight are completed as noReply, and the replies
+ *  received until the line is quiet for NXT_REPLY_WAIT ms are discarded (events are
+ *  handled as usual); commands sent meanwhile wait for it (see rxSkipWait()).
+ */
+void NxtLcd::rxResync(void){
+    rxSkip = 1;
+    rxSkipAt = millis() + NXT_REPLY_WAIT;
+    jrnLost(1);
+    serial.markClear();
+    while(pipeCnt > 0 || frameAcks > 0) pipeAck(noReply);
+    for(uint8_t n = reqCnt; n > 0; n--) reqDone(noReply);
+}
+
+
+/**************************************************************************************
+ *  rxSkipWait() - wait for the end of a resync, see rxResync()
+ */
+void NxtLcd::rxSkipWait(void){
+    while(rxSkip > 0) readEvent();
+}
+
+
+/**************************************************************************************
+ *  poll() - parse all the telegrams received so far, without blocking: events are
+ *  stored (see ckEvents()), replies to in flight commands (pipeline mode) and to async
+ *  requests are matched, anything else is discarded; queued bytes are sent if a TX ring
+ *  is used (see setTxBuf()). After a display restart the link is set up again and the
+ *  journal is replayed (see journal.cpp), and the id of a name just used is asked for
+ *  the resolver (see resolver.cpp): only these wait for the display. Then the callbacks
+ *  of the async requests completed are called (see async.cpp).
+ *  Can be called freely from loop().
+ */
+uint8_t NxtLcd::poll(void){
+    if(initialized == 0) return notInit;
+    rxPoll();
+    jrnCheck();
+    nameLearn();
+    reqCall();
+    return replyCmdOk;
+}
+
+
+/**************************************************************************************
+ *  rxPoll() - the receiving part of poll(), called before sending each command: it
+ *  never send anything, so the command being built in sendBuf is safe
+ */
+void NxtLcd::rxPoll(void){
+    serial.service();
+    uint8_t res;
+    do{
+        res = readEvent();
+    }while(res != noReply && res != noComplete);
+    reqCheck();
+}
+
+
+/**************************************************************************************
+ *  ckEvents() - check for incoming event, and copy the oldest one to lastEvt struct
+ *  passed, removing it from the queue. Events are returned in the same order they 
+ *  were received; call it in a loop until it return 0 to drain the queue.
+ *  Events with a registered handler (see onTouch()) are passed to it instead.
  */
 uint8_t NxtLcd::ckEvents(nxtEvent_t* lastEvt){
-    if(haveEvent == 0) readEvent();
-    if(haveEvent == 1){
-        memset(lastEvt,0,sizeof(nxtEvent_t));
-        memcpy(lastEvt,&lastEvent,sizeof(nxtEvent_t));
-        haveEvent = 0;
-        return 1;
+    if(evCnt == 0) poll();
+    while(evCnt > 0){
+        uint8_t hnd = evHnd[evHead];
+        memcpy(lastEvt,&evQueue[evHead],sizeof(nxtEvent_t));
+        evHead = (evHead + 1) % NXT_EV_QUEUE_SIZE;
+        evCnt--;
+        if(hnd == 255) return 1;
+        hndTbl[hnd].fn(lastEvt,hndTbl[hnd].ctx);
     }
     return 0;
 }
@@ -0,0 +1,150 @@
+/* baud.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the following class methods:
+ *
+ * public :
+ * - setBaud()
+ * - findBaud()
+ *
+ * private:
+ * - linkProbe()
+ *
+ * The display start at the baudrate saved with "bauds=" (9600 if never set), so a
+ * faster link can be negotiated at runtime instead of changing the HMI: setBaud() send
+ * "baud=<rate>", reopen the port at the new rate and check the link reading back the
+ * "baud" variable. If the display does not answer, the old rate is checked, and if it
+ * does not answer either all the rates are probed (see findBaud()).
+ * "baud=" is not saved in the display, after a display restart it talk again at its
+ * startup rate: poll() set the runtime rate again (see journal.cpp). Call findBaud()
+ * when commands keep failing, or init() with baudrate=0, that probe the rates before
+ * anything else.
+ *
+ * lcd.init(9600);
+ * if(lcd.setBaud(115200) != replyCmdOk){
+ *   // still at 9600 (or at the rate found, see getBaud())
+ * }
+ *
+*/
+
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+
+// baudrates supported by the display, most used first
+static const uint32_t nxtBauds[] PROGMEM = {
+    9600, 115200, 57600, 38400, 19200, 230400, 250000, 256000, 512000, 921600, 31250, 4800, 2400
+};
+
+#define NXT_BAUD_CNT        (sizeof(nxtBauds) / sizeof(nxtBauds[0]))
+
+
+/*
+ * nxtBaud() - return the i-th supported baudrate
+ */
+static uint32_t nxtBaud(uint8_t i){
+#ifdef ARDUINO_ARCH_AVR
+    uint32_t rate;
+    memcpy_P(&rate,&nxtBauds[i],sizeof(rate));
+    return rate;
+#else
+    return nxtBauds[i];
+#endif
+}
+
+
+/*
+ * setBaud() - switch the link to "rate", one of the display supported baudrates; with
+ * "persist" the display use it also after a restart ("bauds="). Not available inside
+ * a frame or in pipeline mode. On failure getBaud() return the rate in use.
+ */
+uint8_t NxtLcd::setBaud(uint32_t rate, uint8_t persist){
+    if(initialized == 0) return notInit;
+    if(frameEn > 0 || pipeEn > 0) return invalidData;
+    uint8_t i = 0;
+    while(i < NXT_BAUD_CNT && nxtBaud(i) != rate) i++;
+    if(i == NXT_BAUD_CNT) return invalidData;
+    if(rate == baud && persist == 0) return replyCmdOk;
+    uint32_t old = baud;
+    cmdStart();
+    if(persist) cmdStrP(NXT_P("bauds="));
+    else cmdStrP(NXT_P("baud="));
+    cmdUint(rate);
+    cmdEnd();
+    uint8_t res = writeBuf();   // the reply, if any, may come at either rate
+    if(res == dataTooBig || res == notInit) return res;
+    serial.flushTx();
+    delay(NXT_BAUD_WAIT);
+    res = linkProbe(rate);
+    if(res == replyCmdOk){
+        if(persist) baudBoot = rate;
+        return res;
+    }
+    if(linkProbe(old) == replyCmdOk) return res;
+    findBaud(&rate);
+    return res;
+}
+
+
+/*
+ * findBaud() - probe the supported baudrates until the display answer, returning in
+ * "rate" the one found; if none answer the port is left at the previous rate
+ */
+uint8_t NxtLcd::findBaud(uint32_t* rate){
+    if(initialized == 0) return notInit;
+    if(frameEn > 0 || pipeEn > 0) return invalidData;
+    uint32_t old = baud;
+    for(uint8_t i = 0; i < NXT_BAUD_CNT; i++){
+        if(linkProbe(nxtBaud(i)) == replyCmdOk){
+            (*rate) = baud;
+            return replyCmdOk;
+        }
+    }
+    linkProbe(old);
+    return noReply;
+}
+
+
+/*
+ * linkProbe() - reopen the port at "rate" and check that the display answer, and at
+ * the same rate
+ */
+uint8_t NxtLcd::linkProbe(uint32_t rate){
+    if(reqCnt > 0) reqDrain();
+    serial.flushTx();
+    serial.end();
+    serial.begin(rate);
+    baud = rate;
+    serial.setFlow(serial.flowLimit(),rate);
+    // terminate whatever the display got while the rates differed, then forget the replies
+    cmdStart();
+    cmdEnd();
+    serial.write((unsigned char *)sendBuf,sendLen);
+    serial.flushTx();
+    delay(NXT_REPLY_WAIT);
+    while(serial.available() > 0) serial.read();
+    rxTail = rxHead;
+    rxCnt = 0;
+    rxExpLen = 3;
+    rxSkip = 0;
+    cmdStart();
+    cmdStrP(NXT_P("get baud"));
+    cmdEnd();
+    uint8_t res = writeBuf(replyGetNum,NXT_REPLY_WAIT + 200000UL / rate);   // ~20 bytes time
+    if(res != replyCmdOk) return res;
+    uint32_t value;
+    memcpy(&value,&recvBuf[1],sizeof(value));
+    if(value != rate) return replyCmdFail;
+    jrnLost(0);
+    return replyCmdOk;
+}
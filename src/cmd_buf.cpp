@@ -0,0 +1,228 @@
+/* cmd_buf.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the following class methods:
+ *
+ * private:
+ * - cmdStart()
+ * - cmdStr()
+ * - cmdStrP()
+ * - cmdChar()
+ * - cmdUint()
+ * - cmdInt()
+ * - cmdObj()
+ * - cmdEnd()
+ *
+ * These build a command in sendBuf appending pieces one after the other, as an
+ * alternative to snprintf(): no format string parsing, no memset of the buffer
+ * and no (large) printf code in flash. The command length is kept in sendLen.
+ * If a piece does not fit in the buffer cmdOvfl is raised, and writeBuf() will
+ * refuse to send the command (dataTooBig).
+ *
+ * A typical command is built as:
+ * cmdStart();
+ * cmdObj(page,field);
+ * cmdStrP(NXT_P(".val="));
+ * cmdInt(value);
+ * cmdEnd();
+ * return writeBuf();
+ *
+*/
+
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+
+const uint8_t nxtMsgEnd[3] = {NXT_MSG_END};
+
+
+/*
+ * cmdStart() - start a new command
+ */
+void NxtLcd::cmdStart(void){
+    sendLen = 0;
+    cmdOvfl = 0;
+    cmdKeyEnd = 0;
+}
+
+
+/*
+ * cmdStr() - append a string, "s" can be in RAM or (on AVR) in program memory
+ * using the F() macro
+ */
+void NxtLcd::cmdStr(const char* s){
+    while(*s != '\0'){
+        if(sendLen == NXT_BUF_SIZE){
+            cmdOvfl = 1;
+            return;
+        }
+        sendBuf[sendLen++] = *s++;
+    }
+}
+
+#ifdef ARDUINO_ARCH_AVR
+void NxtLcd::cmdStr(const __FlashStringHelper* s){
+    cmdStrP((const char*)s);
+}
+#endif
+
+
+/*
+ * cmdStrP() - append a string in program memory (PSTR() or NXT_P() macro)
+ * On platforms other than AVR is just cmdStr()
+ */
+void NxtLcd::cmdStrP(const char* s){
+#ifdef ARDUINO_ARCH_AVR
+    char c = pgm_read_byte(s++);
+    while(c != '\0'){
+        if(sendLen == NXT_BUF_SIZE){
+            cmdOvfl = 1;
+            return;
+        }
+        sendBuf[sendLen++] = c;
+        c = pgm_read_byte(s++);
+    }
+#else
+    cmdStr(s);
+#endif
+}
+
+
+/*
+ * cmdChar() - append a single char
+ */
+void NxtLcd::cmdChar(char c){
+    if(sendLen == NXT_BUF_SIZE){
+        cmdOvfl = 1;
+        return;
+    }
+    sendBuf[sendLen++] = c;
+}
+
+
+/*
+ * cmdUint() - append an unsigned integer in decimal notation.
+ * Values that fit in 16 bit are converted with 16 bit divisions, a lot cheaper
+ * than the 32 bit ones on 8 bit MCUs.
+ */
+void NxtLcd::cmdUint(uint32_t value){
+    char    tmp[10];
+    uint8_t n = 0;
+    if(value <= 0xFFFF){
+        uint16_t v16 = value;
+        do{
+            tmp[n++] = '0' + (v16 % 10);
+            v16 /= 10;
+        }while(v16 > 0);
+    }
+    else{
+        do{
+            tmp[n++] = '0' + (value % 10);
+            value /= 10;
+        }while(value > 0);
+    }
+    if(sendLen + n > NXT_BUF_SIZE){
+        cmdOvfl = 1;
+        return;
+    }
+    while(n > 0) sendBuf[sendLen++] = tmp[--n];
+}
+
+
+/*
+ * cmdInt() - append a signed integer in decimal notation.
+ */
+void NxtLcd::cmdInt(int32_t value){
+    if(value < 0){
+        cmdChar('-');
+        cmdUint((uint32_t)0 - (uint32_t)value);
+    }
+    else cmdUint(value);
+}
+
+
+/*
+ * cmdObj() - append an object address, in one of the 4 forms:
+ * - <page_name>.<object_name> (as two strings, or as one)
+ * - p[<page_id>].b[<object_id>]
+ * - <object_name>
+ * - b[<object_id>]
+ * With the resolver enabled (see resolver.cpp) the name forms are replaced by the
+ * id forms, when these are known and shorter.
+ */
+void NxtLcd::cmdObj(const char* page, const char* obj){
+    uint16_t start = sendLen;
+    cmdStr(page);
+    uint16_t dot = sendLen;
+    cmdChar('.');
+    cmdStr(obj);
+    if(nameTbl != NULL && cmdOvfl == 0) nameUse(start,dot);
+}
+
+void NxtLcd::cmdObj(uint8_t page, uint8_t obj){
+    cmdStrP(NXT_P("p["));
+    cmdUint(page);
+    cmdStrP(NXT_P("].b["));
+    cmdUint(obj);
+    cmdChar(']');
+}
+
+void NxtLcd::cmdObj(const char* obj){
+    uint16_t start = sendLen;
+    cmdStr(obj);
+    if(nameTbl != NULL && cmdOvfl == 0){
+        uint16_t dot = start;
+        while(dot < sendLen && sendBuf[dot] != '.') dot++;
+        nameUse(start,(dot < sendLen) ? dot : start);
+    }
+}
+
+void NxtLcd::cmdObj(uint8_t obj){
+    cmdStrP(NXT_P("b["));
+    cmdUint(obj);
+    cmdChar(']');
+}
+
+#ifdef ARDUINO_ARCH_AVR
+void NxtLcd::cmdObj(const __FlashStringHelper* page, const __FlashStringHelper* obj){
+    uint16_t start = sendLen;
+    cmdStr(page);
+    uint16_t dot = sendLen;
+    cmdChar('.');
+    cmdStr(obj);
+    if(nameTbl != NULL && cmdOvfl == 0) nameUse(start,dot);
+}
+
+void NxtLcd::cmdObj(const __FlashStringHelper* obj){
+    uint16_t start = sendLen;
+    cmdStr(obj);
+    if(nameTbl != NULL && cmdOvfl == 0){
+        uint16_t dot = start;
+        while(dot < sendLen && sendBuf[dot] != '.') dot++;
+        nameUse(start,(dot < sendLen) ? dot : start);
+    }
+}
+#endif
+
+
+/*
+ * cmdEnd() - terminate the command with the 3 0xFF bytes
+ */
+void NxtLcd::cmdEnd(void){
+    if(sendLen + sizeof(nxtMsgEnd) > NXT_BUF_SIZE){
+        cmdOvfl = 1;
+        return;
+    }
+    memcpy(&sendBuf[sendLen],nxtMsgEnd,sizeof(nxtMsgEnd));
+    sendLen += sizeof(nxtMsgEnd);
+}
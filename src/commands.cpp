@@ -34,12 +34,10 @@
  */
 uint8_t NxtLcd::cls(uint16_t color){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("cls %u%c%c%c"),color,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"cls %u%c%c%c",color,NXT_MSG_END);
-#endif
+    cmdStart();
+    cmdStrP(NXT_P("cls "));
+    cmdUint(color);
+    cmdEnd();
     return writeBuf();
 }
 
@@ -49,23 +47,19 @@ uint8_t NxtLcd::cls(uint16_t color){
  */
 uint8_t NxtLcd::refresh(const char* obj){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("ref %s%c%c%c"),obj,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"ref %s%c%c%c",obj,NXT_MSG_END);
-#endif
+    cmdStart();
+    cmdStrP(NXT_P("ref "));
+    cmdStr(obj);
+    cmdEnd();
     return writeBuf();
 }
 
 uint8_t NxtLcd::refresh(uint8_t obj){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("ref %u%c%c%c"),obj,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"ref %u%c%c%c",obj,NXT_MSG_END);
-#endif
+    cmdStart();
+    cmdStrP(NXT_P("ref "));
+    cmdUint(obj);
+    cmdEnd();
     return writeBuf();
 }
 
@@ -79,24 +73,24 @@ uint8_t NxtLcd::refresh(uint8_t obj){
 uint8_t NxtLcd::click(const char* obj, uint8_t ev){
     if(initialized == 0) return notInit;
     if(ev > 1) return invalidData;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("click %s,%u%c%c%c"),obj,ev,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"click %s,%u%c%c%c",obj,ev,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("click "));
+    cmdStr(obj);
+    cmdChar(',');
+    cmdUint(ev);
+    cmdEnd();
     return writeBuf();
 }
 
 uint8_t NxtLcd::click(uint8_t obj, uint8_t ev){
     if(initialized == 0) return notInit;
     if(ev > 1) return invalidData;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("click %u,%u%c%c%c"),obj,ev,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"click %u,%u%c%c%c",obj,ev,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("click "));
+    cmdUint(obj);
+    cmdChar(',');
+    cmdUint(ev);
+    cmdEnd();
     return writeBuf();
 }
 
@@ -108,24 +102,24 @@ uint8_t NxtLcd::click(uint8_t obj, uint8_t ev){
 uint8_t NxtLcd::touchEn(const char* obj, uint8_t en){
     if(initialized == 0) return notInit;
     if(en > 1) return invalidData;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("tsw %s,%u%c%c%c"),obj,en,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"tsw %s,%u%c%c%c",obj,en,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("tsw "));
+    cmdStr(obj);
+    cmdChar(',');
+    cmdUint(en);
+    cmdEnd();
     return writeBuf();
 }
 
 uint8_t NxtLcd::touchEn(uint8_t obj, uint8_t en){
     if(initialized == 0) return notInit;
     if(en > 1) return invalidData;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("tsw %u,%u%c%c%c"),obj,en,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"tsw %u,%u%c%c%c",obj,en,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("tsw "));
+    cmdUint(obj);
+    cmdChar(',');
+    cmdUint(en);
+    cmdEnd();
     return writeBuf();
 }
 
@@ -135,24 +129,24 @@ uint8_t NxtLcd::touchEn(uint8_t obj, uint8_t en){
  */
 uint8_t NxtLcd::setVis(const char* obj,uint8_t state){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("vis %s,%u%c%c%c"),obj,state,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"vis %s,%u%c%c%c",obj,state,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("vis "));
+    cmdStr(obj);
+    cmdChar(',');
+    cmdUint(state);
+    cmdEnd();
     return writeBuf();
 }
 
 
 uint8_t NxtLcd::setVis(uint8_t obj,uint8_t state){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("vis %u,%u%c%c%c"),obj,state,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"vis %u,%u%c%c%c",obj,state,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("vis "));
+    cmdUint(obj);
+    cmdChar(',');
+    cmdUint(state);
+    cmdEnd();
     return writeBuf();
 }
 
@@ -179,16 +173,15 @@ uint8_t NxtLcd::getPage(uint8_t* page){
  */
 uint8_t NxtLcd::setPageS(const char* page){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("page %s%c%c%c"),page,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"page %s%c%c%c",page,NXT_MSG_END);
-#endif    
+    cmdStart();
+    shadowClear();
+    cmdStrP(NXT_P("page "));
+    cmdStr(page);
+    cmdEnd();
     uint8_t res = writeBuf();
     if(res == replyCmdOk){
         uint16_t pg = 0;
-        getProperty(nxt_dp,&pg);
+        if(getProperty(nxt_dp,&pg) == replyCmdOk) addPageId(page,pg);
     }
     return res;
 }
@@ -210,16 +203,22 @@ uint8_t NxtLcd::setPageN(uint8_t page){
 
 uint8_t NxtLcd::setVis(const __FlashStringHelper* obj,uint8_t state){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("vis %S,%u%c%c%c"),obj,state,NXT_MSG_END);
+    cmdStart();
+    cmdStrP(NXT_P("vis "));
+    cmdStr(obj);
+    cmdChar(',');
+    cmdUint(state);
+    cmdEnd();
     return writeBuf();
 }
 
 
 uint8_t NxtLcd::refresh(const __FlashStringHelper* obj){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("ref %S%c%c%c"),obj,NXT_MSG_END);
+    cmdStart();
+    cmdStrP(NXT_P("ref "));
+    cmdStr(obj);
+    cmdEnd();
     return writeBuf();
 }
 
@@ -227,27 +226,43 @@ uint8_t NxtLcd::refresh(const __FlashStringHelper* obj){
 uint8_t NxtLcd::click(const __FlashStringHelper* obj, uint8_t ev){
     if(initialized == 0) return notInit;
     if(ev > 1) return invalidData;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("click %S,%u%c%c%c"),obj,ev,NXT_MSG_END);
+    cmdStart();
+    cmdStrP(NXT_P("click "));
+    cmdStr(obj);
+    cmdChar(',');
+    cmdUint(ev);
+    cmdEnd();
     return writeBuf();
 }
 
 uint8_t NxtLcd::touchEn(const __FlashStringHelper* obj, uint8_t en){
     if(initialized == 0) return notInit;
     if(en > 1) return invalidData;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("tsw %S,%u%c%c%c"),obj,en,NXT_MSG_END);
+    cmdStart();
+    cmdStrP(NXT_P("tsw "));
+    cmdStr(obj);
+    cmdChar(',');
+    cmdUint(en);
+    cmdEnd();
     return writeBuf();
 }
 
 uint8_t NxtLcd::setPageS(const __FlashStringHelper* page){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("page %S%c%c%c"),page,NXT_MSG_END);
+    cmdStart();
+    shadowClear();
+    cmdStrP(NXT_P("page "));
+    cmdStr(page);
+    char name[NXT_NAME_MAX + 1];            // for the resolver, sendBuf is reused below
+    uint16_t len = sendLen - 5;
+    if(len > NXT_NAME_MAX) len = 0;
+    memcpy(name,&sendBuf[5],len);
+    name[len] = 0;
+    cmdEnd();
     uint8_t res = writeBuf();
     if(res == replyCmdOk){
         uint16_t pg = 0;
-        getProperty(nxt_dp,&pg);
+        if(getProperty(nxt_dp,&pg) == replyCmdOk && len > 0 && nameTbl != NULL) addPageId(name,pg);
     }
     return res;
 }
@@ -0,0 +1,187 @@
+/* dispatch.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the following class methods:
+ *
+ * public :
+ * - setHandlers()
+ * - onTouch()
+ * - onEvent()
+ * - dispatch()
+ *
+ * private:
+ * - hndFind()
+ * - hndMatch()
+ * - hndSet()
+ *
+ * Handlers are registered for a component touch (page, component id, press and/or
+ * release) or for a whole event type (XY touch 0x67/0x68, sleep 0x86/0x87, sendme 0x66).
+ * The table, provided by user, is kept sorted so an incoming event is looked up with a
+ * binary search as soon as it's parsed. In filter mode events without handler are not
+ * even queued (see getEvFiltered()); otherwise they are returned by ckEvents() as usual.
+ * Handlers are called by dispatch() (or ckEvents()), never from inside the parser, so
+ * they can send commands to the display.
+ *
+ * nxtHandler_t handlers[8];
+ * lcd.setHandlers(handlers,8);
+ * lcd.onTouch(0,10,NXT_EV_PRESS,onRadio);
+ * lcd.onEvent(cmdSleepOn,onSleep);
+ * ...
+ * loop(){
+ *   lcd.dispatch();
+ * }
+ *
+*/
+
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+
+/*
+ * setHandlers() - use the "table" array of "size" entries (max 254) provided by user
+ * for the event handlers. With "filter" set, events without handler are dropped when
+ * parsed. Pass NULL to remove all the handlers.
+ */
+uint8_t NxtLcd::setHandlers(nxtHandler_t* table, uint8_t size, uint8_t filter){
+    if(table != NULL && (size == 0 || size == 255)) return invalidData;
+    if(filter > 1) return invalidData;
+    hndTbl = table;
+    hndSize = (table != NULL) ? size : 0;
+    hndCnt = 0;
+    hndFilter = (table != NULL) ? filter : 0;
+    for(uint8_t i = 0; i < evCnt; i++) evHnd[(evHead + i) % NXT_EV_QUEUE_SIZE] = 255;
+    return replyCmdOk;
+}
+
+
+/*
+ * onTouch() - call "fn" for touch events of component "comp" on page "page"; "mask" is
+ * NXT_EV_PRESS, NXT_EV_RELEASE or NXT_EV_BOTH. Pass fn=NULL to remove the handler.
+ */
+uint8_t NxtLcd::onTouch(uint8_t page, uint8_t comp, uint8_t mask, nxtEvHandler_t fn, void* ctx){
+    if(mask == 0 || mask > NXT_EV_BOTH) return invalidData;
+    uint32_t key = ((uint32_t)cmdTouchCompEv << 16) | ((uint16_t)page << 8) | comp;
+    return hndSet(key,mask,fn,ctx);
+}
+
+
+/*
+ * onEvent() - call "fn" for all the events of type "evCode": cmdTouchXYaw, cmdTouchXYsl,
+ * cmdSleepOn, cmdSleepOff or cmdSendme. Pass fn=NULL to remove the handler.
+ */
+uint8_t NxtLcd::onEvent(uint8_t evCode, nxtEvHandler_t fn, void* ctx){
+    switch(evCode){
+        case cmdTouchXYaw:
+        case cmdTouchXYsl:
+        case cmdSleepOn:
+        case cmdSleepOff:
+        case cmdSendme:
+            break;
+        default:
+            return invalidData;
+    }
+    return hndSet((uint32_t)evCode << 16,NXT_EV_ALL,fn,ctx);
+}
+
+
+/*
+ * dispatch() - read incoming events and call their handlers; events without handler
+ * are discarded. Return the number of handlers called.
+ */
+uint8_t NxtLcd::dispatch(void){
+    if(initialized == 0) return 0;
+    poll();
+    uint8_t cnt = 0;
+    nxtEvent_t ev;
+    while(evCnt > 0){
+        uint8_t hnd = evHnd[evHead];
+        memcpy(&ev,&evQueue[evHead],sizeof(nxtEvent_t));
+        evHead = (evHead + 1) % NXT_EV_QUEUE_SIZE;
+        evCnt--;
+        if(hnd == 255) continue;
+        hndTbl[hnd].fn(&ev,hndTbl[hnd].ctx);
+        cnt++;
+    }
+    return cnt;
+}
+
+
+/*
+ * hndFind() - binary search of "key" in the handler table, 255 if not found
+ */
+uint8_t NxtLcd::hndFind(uint32_t key){
+    uint8_t lo = 0;
+    uint8_t hi = hndCnt;
+    while(lo < hi){
+        uint8_t mid = (lo + hi) / 2;
+        if(hndTbl[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    if(lo < hndCnt && hndTbl[lo].key == key) return lo;
+    return 255;
+}
+
+
+/*
+ * hndMatch() - return the index of the handler for event "ev", 255 if none
+ */
+uint8_t NxtLcd::hndMatch(nxtEvent_t* ev){
+    if(hndCnt == 0) return 255;
+    uint32_t key = (uint32_t)ev->evCode << 16;
+    if(ev->evCode == cmdTouchCompEv) key |= ((ev->page_X & 0xFF) << 8) | (ev->compId_Y & 0xFF);
+    uint8_t i = hndFind(key);
+    if(i == 255) return 255;
+    switch(ev->evCode){
+        case cmdTouchCompEv:
+        case cmdTouchXYaw:
+        case cmdTouchXYsl:
+            if(ev->event > NXT_XY_MOVE || (hndTbl[i].mask & (1 << ev->event)) == 0) return 255;
+            break;
+    }
+    return i;
+}
+
+
+/*
+ * hndSet() - add, update or (fn=NULL) remove a handler, keeping the table sorted.
+ * Events already queued are matched again, as indexes may have changed.
+ */
+uint8_t NxtLcd::hndSet(uint32_t key, uint8_t mask, nxtEvHandler_t fn, void* ctx){
+    if(hndTbl == NULL) return notSupported;
+    uint8_t i = hndFind(key);
+    if(fn == NULL){
+        if(i == 255) return invalidData;
+        hndCnt--;
+        for(; i < hndCnt; i++) hndTbl[i] = hndTbl[i + 1];
+    }
+    else{
+        if(i == 255){
+            if(hndCnt == hndSize) return dataTooBig;
+            i = hndCnt;
+            while(i > 0 && hndTbl[i - 1].key > key){
+                hndTbl[i] = hndTbl[i - 1];
+                i--;
+            }
+            hndCnt++;
+        }
+        hndTbl[i].key = key;
+        hndTbl[i].mask = mask;
+        hndTbl[i].fn = fn;
+        hndTbl[i].ctx = ctx;
+    }
+    for(uint8_t n = 0; n < evCnt; n++){
+        uint8_t slot = (evHead + n) % NXT_EV_QUEUE_SIZE;
+        evHnd[slot] = hndMatch(&evQueue[slot]);
+    }
+    return replyCmdOk;
+}
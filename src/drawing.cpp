@@ -43,15 +43,30 @@ uint8_t NxtLcd::writeStr(const char* msg, uint16_t x,uint16_t y,uint16_t w,
 {
     if(initialized == 0) return notInit;
     if(strlen(msg) + 42 > NXT_BUF_SIZE) return dataTooBig;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("xstr %u,%u,%u,%u,%u,%u,%u,%u,%u,1,\"%s\"%c%c%c"),x,y,w,h,
-             font,fCol,bCol,xCen,yCen,msg,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"xstr %u,%u,%u,%u,%u,%u,%u,%u,%u,1,\"%s\"%c%c%c",x,y,w,h,
-             font,fCol,bCol,xCen,yCen,msg,NXT_MSG_END);
-#endif    
-    //serialLogInt("xstr sendBuf len",strlen((char *)sendBuf));
+    cmdStart();
+    cmdStrP(NXT_P("xstr "));
+    cmdUint(x);
+    cmdChar(',');
+    cmdUint(y);
+    cmdChar(',');
+    cmdUint(w);
+    cmdChar(',');
+    cmdUint(h);
+    cmdChar(',');
+    cmdUint(font);
+    cmdChar(',');
+    cmdUint(fCol);
+    cmdChar(',');
+    cmdUint(bCol);
+    cmdChar(',');
+    cmdUint(xCen);
+    cmdChar(',');
+    cmdUint(yCen);
+    cmdStrP(NXT_P(",1,\""));
+    cmdStr(msg);
+    cmdChar('"');
+    cmdEnd();
+    //serialLogInt("xstr sendBuf len",sendLen);
     return writeBuf();
 }   
 
@@ -63,25 +78,23 @@ uint8_t NxtLcd::writeStr(const char* msg, uint16_t x,uint16_t y,uint16_t w,
  */
 uint8_t NxtLcd::drawArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h,uint16_t color, uint8_t filled){
     if(initialized == 0) return notInit;
-    char    cmd[5];
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    if(filled > 0) strncpy_P(cmd,PSTR("fill"),5);
+    cmdStart();
+    if(filled > 0) cmdStrP(NXT_P("fill "));
     else{
-        strncpy_P(cmd,PSTR("draw"),5);
+        cmdStrP(NXT_P("draw "));
         w += x;
         h += y;
     } 
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s %u,%u,%u,%u,%u%c%c%c"),cmd,x,y,w,h,color,NXT_MSG_END);
-#else    
-    if(filled > 0) strncpy(cmd,"fill",5);
-    else{
-        strncpy(cmd,"draw",5);
-        w += x;
-        h += y;
-    } 
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s %u,%u,%u,%u,%u%c%c%c",cmd,x,y,w,h,color,NXT_MSG_END);
-#endif    
+    cmdUint(x);
+    cmdChar(',');
+    cmdUint(y);
+    cmdChar(',');
+    cmdUint(w);
+    cmdChar(',');
+    cmdUint(h);
+    cmdChar(',');
+    cmdUint(color);
+    cmdEnd();
     return writeBuf();
 }
 
@@ -90,12 +103,18 @@ uint8_t NxtLcd::drawArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h,uint16_t
  */
 uint8_t NxtLcd::drawLine(uint16_t x, uint16_t y, uint16_t x1, uint16_t y1,uint16_t color){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("line %u,%u,%u,%u,%u%c%c%c"),x,y,x1,y1,color,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"line %u,%u,%u,%u,%u%c%c%c",x,y,x1,y1,color,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("line "));
+    cmdUint(x);
+    cmdChar(',');
+    cmdUint(y);
+    cmdChar(',');
+    cmdUint(x1);
+    cmdChar(',');
+    cmdUint(y1);
+    cmdChar(',');
+    cmdUint(color);
+    cmdEnd();
     return writeBuf();
 }
 
@@ -107,18 +126,17 @@ uint8_t NxtLcd::drawLine(uint16_t x, uint16_t y, uint16_t x1, uint16_t y1,uint16
  */
 uint8_t NxtLcd::drawCircle(uint16_t x, uint16_t y, uint16_t r, uint16_t color, uint8_t filled){
     if(initialized == 0) return notInit;
-    char    cmd[5];
-    bufReset(sendBuf);
-
-#ifdef ARDUINO_ARCH_AVR
-    if(filled > 0) strncpy_P(cmd,PSTR("cirs"),5);
-    else strncpy_P(cmd,PSTR("cir"),4);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s %u,%u,%u,%u%c%c%c"),cmd,x,y,r,color,NXT_MSG_END);
-#else    
-    if(filled > 0) strncpy(cmd,"cirs",5);
-    else strncpy(cmd,"cir",4);
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s %u,%u,%u,%u%c%c%c",cmd,x,y,r,color,NXT_MSG_END);
-#endif    
+    cmdStart();
+    if(filled > 0) cmdStrP(NXT_P("cirs "));
+    else cmdStrP(NXT_P("cir "));
+    cmdUint(x);
+    cmdChar(',');
+    cmdUint(y);
+    cmdChar(',');
+    cmdUint(r);
+    cmdChar(',');
+    cmdUint(color);
+    cmdEnd();
     return writeBuf();
 }
 
@@ -131,56 +149,47 @@ uint8_t NxtLcd::drawCircle(uint16_t x, uint16_t y, uint16_t r, uint16_t color, u
 uint8_t NxtLcd::addWavePoint(uint8_t waveId,uint8_t ch, uint8_t value){
     if(initialized == 0) return notInit;
     if(ch > 3) return invalidData;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("add %u,%u,%u%c%c%c"),waveId,ch,value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"add %u,%u,%u%c%c%c",waveId,ch,value,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("add "));
+    cmdUint(waveId);
+    cmdChar(',');
+    cmdUint(ch);
+    cmdChar(',');
+    cmdUint(value);
+    cmdEnd();
     return writeBuf();
 }
 
 
 /*
- * addWaveBytes() - add "len" bytes to wave object channel at once. In this case len can exceed the
- * NXT_BUF_SIZE limit, if so the transmission of data will be splitted in chunks that fits
- * into the buffer. 
+ * addWaveBytes() - add "len" bytes to wave object channel at once, using the transparent data mode.
+ * Data are sent in chunks of up to NXT_TD_CHUNK_SIZE bytes (sized on the display serial buffer, not
+ * on NXT_BUF_SIZE), written straight from "bytes": for each chunk we send the addt command, wait for
+ * the display to be ready (0xFE) and for the end of transfer (0xFD), returning as soon as these 
+ * arrive.
  */
-uint8_t NxtLcd::addWaveBytes(uint8_t waveId,uint8_t ch, uint8_t* bytes, uint16_t len){
+uint8_t NxtLcd::addWaveBytes(uint8_t waveId,uint8_t ch, const uint8_t* bytes, uint16_t len){
     if(initialized == 0) return notInit;
     if(ch > 3) return invalidData;
     uint8_t res = replyCmdFail;
-    uint16_t chkSize = len;
-    //uint8_t iter = (len / NXT_BUF_SIZE) + 1;//1;
-    uint8_t cnt = 0;
-    while(len > 0){
-        bufReset(sendBuf);
-        if(cnt > 0) delay(20); //after 1° run we need a little delay
-        chkSize = (len > NXT_BUF_SIZE) ? NXT_BUF_SIZE : len;
-#ifdef ARDUINO_ARCH_AVR
-        snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("addt %u,%u,%u%c%c%c"),waveId,ch,chkSize,NXT_MSG_END);
-#else    
-        snprintf((char *)sendBuf,NXT_BUF_SIZE,"addt %u,%u,%u%c%c%c",waveId,ch,chkSize,NXT_MSG_END);
-#endif    
-        //serialLogStr("addWaveBytes sendBuf",sendBuf);
-        //This seems critical for the timing
-        res = writeBuf(replyTDReady,100);
-        if(res != replyCmdOk){
-          //serialLogInt("addWaveBytes res",res);  
-          //serialLogInt("addWaveBytes iter",iter);
-          //serialLogInt("addWaveBytes cnt",cnt);
-          //serialLogInt("addWaveBytes len",len);
-          //serialLogInt("addWaveBytes chkSize",chkSize);
-          
-          return res;  
-        } 
-        bufReset(sendBuf);
-        memcpy(sendBuf,&bytes[cnt],chkSize);
-        res = writeBuf(replyTDEnd,20,chkSize);
+    uint16_t cnt = 0;
+    while(cnt < len){
+        uint16_t chkSize = (len - cnt > NXT_TD_CHUNK_SIZE) ? NXT_TD_CHUNK_SIZE : len - cnt;
+        cmdStart();
+        cmdStrP(NXT_P("addt "));
+        cmdUint(waveId);
+        cmdChar(',');
+        cmdUint(ch);
+        cmdChar(',');
+        cmdUint(chkSize);
+        cmdEnd();
+        res = writeBuf(replyTDReady,NXT_TD_WAIT);
+        if(res != replyCmdOk) return res;
+        if(serial.write((const unsigned char *)&bytes[cnt],chkSize) != chkSize) return replyCmdFail;
+        flowMark(replyTDEnd);
+        res = waitFor(replyTDEnd,NXT_TD_WAIT);
         if(res != replyCmdOk) return res;
         cnt += chkSize;
-        len -= chkSize;
-        //iter--;
     }
     return replyCmdOk;
 }
@@ -192,12 +201,12 @@ uint8_t NxtLcd::addWaveBytes(uint8_t waveId,uint8_t ch, uint8_t* bytes, uint16_t
 uint8_t NxtLcd::clearWaveCh(uint8_t waveId, uint8_t ch){
     if(initialized == 0) return notInit;
     if(ch > 3 && ch != 255) return invalidData;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("cle %u,%u%c%c%c"),waveId,ch,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"cle %u,%u%c%c%c",waveId,ch,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("cle "));
+    cmdUint(waveId);
+    cmdChar(',');
+    cmdUint(ch);
+    cmdEnd();
     return writeBuf();    
 }
 
@@ -208,17 +217,10 @@ uint8_t NxtLcd::clearWaveCh(uint8_t waveId, uint8_t ch){
 uint8_t NxtLcd::waveUpdtEn(uint8_t en){
     if(initialized == 0) return notInit;
     if(en > 1 ) return invalidData;
-    char cmd[9];
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    if(en == 1) strncpy_P(cmd,PSTR("ref_star"),9);
-    else strncpy_P(cmd,PSTR("ref_stop"),9);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s%c%c%c"),cmd,NXT_MSG_END);
-#else    
-    if(en == 1) strncpy(cmd,"ref_star",9);
-    else strncpy(cmd,"ref_stop",9);
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s%c%c%c",cmd,NXT_MSG_END);
-#endif    
+    cmdStart();
+    if(en == 1) cmdStrP(NXT_P("ref_star"));
+    else cmdStrP(NXT_P("ref_stop"));
+    cmdEnd();
     return writeBuf();    
 }
 
@@ -233,9 +235,29 @@ uint8_t NxtLcd::writeStr(const __FlashStringHelper* msg, uint16_t x,uint16_t y,u
 {
     if(initialized == 0) return notInit;
     if(strlen_P((char *)msg) + 42 > NXT_BUF_SIZE) return dataTooBig;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("xstr %u,%u,%u,%u,%u,%u,%u,%u,%u,1,\"%S\"%c%c%c"),x,y,w,h,
-             font,fCol,bCol,xCen,yCen,msg,NXT_MSG_END);
+    cmdStart();
+    cmdStrP(NXT_P("xstr "));
+    cmdUint(x);
+    cmdChar(',');
+    cmdUint(y);
+    cmdChar(',');
+    cmdUint(w);
+    cmdChar(',');
+    cmdUint(h);
+    cmdChar(',');
+    cmdUint(font);
+    cmdChar(',');
+    cmdUint(fCol);
+    cmdChar(',');
+    cmdUint(bCol);
+    cmdChar(',');
+    cmdUint(xCen);
+    cmdChar(',');
+    cmdUint(yCen);
+    cmdStrP(NXT_P(",1,\""));
+    cmdStr(msg);
+    cmdChar('"');
+    cmdEnd();
     //serialLogInt("xstr pgm, msg len",strlen_P((char *)msg));
     return writeBuf();
 }   
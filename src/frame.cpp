@@ -0,0 +1,153 @@
+/* frame.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the following class methods:
+ *
+ * public :
+ * - setFrameBuf()
+ * - beginFrame()
+ * - commitFrame()
+ *
+ * private:
+ * - frameAdd()
+ * - frameSend()
+ *
+ * Between beginFrame() and commitFrame() the commands that don't expect data back
+ * (set*, draw*, etc.) are not sent, but collected in the frame buffer; commitFrame()
+ * send them all with a single serial write. Optionally the frame is wrapped in
+ * ref_stop/ref_star, so the display repaint once.
+ * Commands that need a reply (get*) can still be used inside a frame, the commands
+ * collected so far are sent before them.
+ *
+ * uint8_t frame[256];
+ * lcd.setFrameBuf(frame,sizeof(frame));
+ * ...
+ * lcd.beginFrame(1);
+ * lcd.setNumeric(3,val1);
+ * lcd.setNumeric(4,val2);
+ * ...
+ * uint8_t res = lcd.commitFrame();
+ *
+*/
+
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+
+/*
+ * setFrameBuf() - set the buffer used to collect a frame. A frame larger than the buffer
+ * is sent in more than one write. Pass NULL to free the buffer.
+ */
+uint8_t NxtLcd::setFrameBuf(uint8_t* buf, uint16_t size){
+    if(frameEn > 0) return invalidData;
+    if(buf != NULL && size < NXT_BUF_SIZE) return invalidData;
+    frameBuf = buf;
+    frameSize = (buf != NULL) ? size : 0;
+    frameLen = 0;
+    frameCmds = 0;
+    return replyCmdOk;
+}
+
+
+/*
+ * beginFrame() - start collecting commands. If "refStop" is 1, the frame start with
+ * a ref_stop command and commitFrame() add a ref_star at the end.
+ */
+uint8_t NxtLcd::beginFrame(uint8_t refStop){
+    if(initialized == 0) return notInit;
+    if(frameBuf == NULL) return notSupported;
+    if(frameEn > 0 || refStop > 1) return invalidData;
+    frameEn = 1;
+    frameRef = refStop;
+    if(refStop > 0) return waveUpdtEn(0);
+    return replyCmdOk;
+}
+
+
+/*
+ * commitFrame() - send all the commands collected since beginFrame().
+ * In pipeline mode wait for a reply for each of them (see getPipeErr() to know which
+ * command failed); otherwise, with debug on, wait NXT_REPLY_WAIT ms for error codes.
+ * Return replyCmdOk, or the first error reported.
+ */
+uint8_t NxtLcd::commitFrame(void){
+    if(initialized == 0) return notInit;
+    if(frameEn == 0) return invalidData;
+    if(frameRef > 0) waveUpdtEn(1);
+    frameEn = 0;
+    frameRef = 0;
+    return frameSend();
+}
+
+
+/*
+ * frameAdd() - add the command in sendBuf to the frame buffer
+ */
+uint8_t NxtLcd::frameAdd(void){
+    if(cmdOvfl > 0) return dataTooBig;
+    if(sendLen == 0) return invalidData;
+    uint8_t res = replyCmdOk;
+    if(frameLen + sendLen > frameSize) res = frameSend();
+    memcpy(&frameBuf[frameLen],sendBuf,sendLen);
+    frameLen += sendLen;
+    cmdSeq++;
+    if(frameCmds == 0) frameSeq = cmdSeq;
+    frameCmds++;
+    return res;
+}
+
+
+/*
+ * frameSend() - write the frame buffer to the display and check the replies, waiting
+ * from the time it should be all sent (see txSent())
+ */
+uint8_t NxtLcd::frameSend(void){
+    if(frameLen == 0) return replyCmdOk;
+    rxSkipWait();
+    if(reqCnt > 0) reqDrain();
+    if(pipeCnt > 0) pipeFlush();
+    uint8_t ret = replyCmdOk;
+    uint16_t len = frameLen;
+    uint16_t cmds = frameCmds;
+    frameLen = 0;
+    frameCmds = 0;
+    if(serial.write((unsigned char *)frameBuf,len) != len){
+        shadowClear();
+        return replyCmdFail;
+    }
+    txSent(len);
+    flowMark(pipeEn,cmds);
+    if(pipeEn > 0 || debug > 0) serial.flushTx();
+    if(pipeEn > 0){
+        uint8_t prevErr = pipeErr;
+        frameAcks = cmds;
+        uint32_t start = millis() + txLeftMs();
+        while(frameAcks > 0){
+            uint16_t left = frameAcks;
+            readEvent();
+            if(frameAcks < left) start = millis() + txLeftMs();
+            else if((int32_t)(millis() - start) >= NXT_REPLY_WAIT) rxResync();
+        }
+        if(prevErr == replyCmdOk) ret = pipeErr;
+    }
+    else if(debug > 0){
+        uint32_t start = millis() + txLeftMs();      // the frame can still be in the port FIFO
+        while((int32_t)(millis() - start) < NXT_REPLY_WAIT){
+            uint8_t res = readBuf();
+            if(res == replyTouchEv || res == replySleepEv || res == replySendMe) readEvent(1);
+            else if(res != noReply && res != noComplete && res != replyCmdOk && ret == replyCmdOk) ret = res;
+        }
+        if(ret != replyCmdOk) shadowClear();
+    }
+    return ret;
+}
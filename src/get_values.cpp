@@ -36,12 +36,11 @@
  */
 uint8_t NxtLcd::getString(const char* page,const char* field,char* value, uint16_t size){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get %s.%s.txt%c%c%c"),page,field,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"get %s.%s.txt%c%c%c",page,field,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".txt"));
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetStr);
     if(ret == replyCmdOk ){
         memset(value,0,size);
@@ -52,12 +51,11 @@ uint8_t NxtLcd::getString(const char* page,const char* field,char* value, uint16
 
 uint8_t NxtLcd::getString(uint8_t page,uint8_t field,char* value,uint16_t size){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get p[%u].b[%u].txt%c%c%c"),page,field,NXT_MSG_END);
-#else
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"get p[%u].b[%u].txt%c%c%c",page,field,NXT_MSG_END);
-#endif
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".txt"));
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetStr);//readBuf();
     if(ret == replyCmdOk ){
         memset(value,0,size);
@@ -70,12 +68,11 @@ uint8_t NxtLcd::getString(uint8_t page,uint8_t field,char* value,uint16_t size){
 
 uint8_t NxtLcd::getString(const char* field,char* value,uint16_t size){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get %s.txt%c%c%c"),field,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"get %s.txt%c%c%c",field,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(field);
+    cmdStrP(NXT_P(".txt"));
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetStr);
     if(ret == replyCmdOk ){
         memset(value,0,size);
@@ -86,12 +83,11 @@ uint8_t NxtLcd::getString(const char* field,char* value,uint16_t size){
 
 uint8_t NxtLcd::getString(uint8_t field,char* value,uint16_t size){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get b[%u].txt%c%c%c"),field,NXT_MSG_END);
-#else
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"get b[%u].txt%c%c%c",field,NXT_MSG_END);
-#endif
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(field);
+    cmdStrP(NXT_P(".txt"));
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetStr);//readBuf();
     if(ret == replyCmdOk ){
         memset(value,0,size);
@@ -109,12 +105,11 @@ uint8_t NxtLcd::getString(uint8_t field,char* value,uint16_t size){
 uint8_t NxtLcd::getNumeric(const char* page,const char* field,void* value,uint8_t size){
     if(initialized == 0) return notInit;
     if(size > 4) return invalidData;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get %s.%s.val%c%c%c"),page,field,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"get %s.%s.val%c%c%c",page,field,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".val"));
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         memcpy(value,&recvBuf[1],size);
@@ -126,12 +121,11 @@ uint8_t NxtLcd::getNumeric(const char* page,const char* field,void* value,uint8_
 uint8_t NxtLcd::getNumeric(uint8_t page,uint8_t field,void* value,uint8_t size){
     if(initialized == 0) return notInit;
     if(size > 4) return invalidData;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get p[%u].b[%u].val%c%c%c"),page,field,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"get p[%u].b[%u].val%c%c%c",page,field,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".val"));
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         memcpy(value,&recvBuf[1],size);
@@ -142,12 +136,11 @@ uint8_t NxtLcd::getNumeric(uint8_t page,uint8_t field,void* value,uint8_t size){
 uint8_t NxtLcd::getNumeric(const char* field,void* value,uint8_t size){
     if(initialized == 0) return notInit;
     if(size > 4) return invalidData;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get %s.val%c%c%c"),field,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"get %s.val%c%c%c",field,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(field);
+    cmdStrP(NXT_P(".val"));
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         memcpy(value,&recvBuf[1],size);
@@ -159,12 +152,11 @@ uint8_t NxtLcd::getNumeric(const char* field,void* value,uint8_t size){
 uint8_t NxtLcd::getNumeric(uint8_t field,void* value,uint8_t size){
     if(initialized == 0) return notInit;
     if(size > 4) return invalidData;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get b[%u].val%c%c%c"),field,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"get b[%u].val%c%c%c",field,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(field);
+    cmdStrP(NXT_P(".val"));
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         memcpy(value,&recvBuf[1],size);
@@ -179,8 +171,11 @@ uint8_t NxtLcd::getNumeric(const __FlashStringHelper* page,const __FlashStringHe
                                void* value, uint8_t size){
     if(initialized == 0) return notInit;
     if(size > 4) return invalidData;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get %S.%S.val%c%c%c"),page,field,NXT_MSG_END);
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".val"));
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         //memcpy(value,&getNumber,sizeof(uint32_t));
@@ -193,8 +188,11 @@ uint8_t NxtLcd::getNumeric(const __FlashStringHelper* page,const __FlashStringHe
 uint8_t NxtLcd::getNumeric(const __FlashStringHelper* field,void* value, uint8_t size){
     if(initialized == 0) return notInit;
     if(size > 4) return invalidData;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get %S.val%c%c%c"),field,NXT_MSG_END);
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(field);
+    cmdStrP(NXT_P(".val"));
+    cmdEnd();
     //serialLogStr("getNumeric pgm sendBuf",sendBuf);
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
@@ -207,8 +205,11 @@ uint8_t NxtLcd::getNumeric(const __FlashStringHelper* field,void* value, uint8_t
 uint8_t NxtLcd::getString(const __FlashStringHelper* page,const __FlashStringHelper* field,
                               char* value,uint16_t size){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get %S.%S.txt%c%c%c"),page,field,NXT_MSG_END);
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".txt"));
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetStr);
     if(ret == replyCmdOk ){
         //strncpy(value,getStr,NXT_STR_SIZE);
@@ -220,8 +221,11 @@ uint8_t NxtLcd::getString(const __FlashStringHelper* page,const __FlashStringHel
 
 uint8_t NxtLcd::getString(const __FlashStringHelper* field,char* value,uint16_t size){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get %S.txt%c%c%c"),field,NXT_MSG_END);
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdObj(field);
+    cmdStrP(NXT_P(".txt"));
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetStr);
     if(ret == replyCmdOk ){
         //strncpy(value,getStr,NXT_STR_SIZE);
@@ -0,0 +1,244 @@
+/* handles.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the following class methods:
+ *
+ * NxtHandle :
+ * - NxtHandle()
+ * - setAttr()
+ * - setBackColor()
+ * - setForeColor()
+ * - cmdAddr()
+ * - setVal()
+ * - setTxt()
+ *
+ * NxtNumber, NxtText, NxtGauge :
+ * - set()
+ *
+ * NxtWave :
+ * - NxtWave()
+ * - add()
+ *
+ * A handle keep the address of a component ready to be copied in the command, so
+ * updating the same widgets again and again does not format page and object each
+ * time. Updates go through the shadow cache, the name resolver and the frame/pipeline
+ * modes as the NxtLcd set* functions.
+ *
+ * NxtNumber speed(lcd,0,3);            // p[0].b[3], encoded in RAM
+ * NxtText   status(lcd,F("main.t0"));  // name in program memory
+ * ...
+ * speed.set(rpm);
+ * status.set(F("running"));
+ *
+*/
+
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+
+// address storage
+#define NXT_H_IDS       0   //ids encoded in addr.buf
+#define NXT_H_NAME      1   //name in RAM, addr.name
+#define NXT_H_NAMEP     2   //name in program memory, addr.name
+
+
+/*
+ * nxtUtoa() - write "v" in decimal notation at "p", return the position after it
+ */
+static char* nxtUtoa(char* p, uint8_t v){
+    if(v >= 100) *p++ = '0' + v / 100;
+    if(v >= 10) *p++ = '0' + (v / 10) % 10;
+    *p++ = '0' + v % 10;
+    return p;
+}
+
+
+/*
+ * NxtHandle() - bind the handle to display "l" and to the component addressed by
+ * page and object id, by object id (on current page), or by name (in RAM or, with
+ * the F() macro, in program memory)
+ */
+NxtHandle::NxtHandle(NxtLcd& l, uint8_t page, uint8_t obj){
+    lcd = &l;
+    mode = NXT_H_IDS;
+    char* p = addr.buf;
+    *p++ = 'p';
+    *p++ = '[';
+    p = nxtUtoa(p,page);
+    memcpy(p,"].b[",4);
+    p = nxtUtoa(p + 4,obj);
+    *p++ = ']';
+    *p = '\0';
+}
+
+NxtHandle::NxtHandle(NxtLcd& l, uint8_t obj){
+    lcd = &l;
+    mode = NXT_H_IDS;
+    char* p = addr.buf;
+    *p++ = 'b';
+    *p++ = '[';
+    p = nxtUtoa(p,obj);
+    *p++ = ']';
+    *p = '\0';
+}
+
+NxtHandle::NxtHandle(NxtLcd& l, const char* name){
+    lcd = &l;
+    mode = NXT_H_NAME;
+    addr.name = name;
+}
+
+NxtHandle::NxtHandle(NxtLcd& l, const __FlashStringHelper* name){
+    lcd = &l;
+    mode = NXT_H_NAMEP;
+    addr.name = (const char *)name;
+}
+
+
+/*
+ * cmdAddr() - start a command with the component address; names go through cmdObj(),
+ * so they are resolved as in the NxtLcd functions (see resolver.cpp)
+ */
+void NxtHandle::cmdAddr(void){
+    lcd->cmdStart();
+#ifdef ARDUINO_ARCH_AVR
+    if(mode == NXT_H_NAMEP) lcd->cmdObj((const __FlashStringHelper *)addr.name);
+    else
+#endif
+    if(mode != NXT_H_IDS) lcd->cmdObj(addr.name);
+    else lcd->cmdStr(addr.buf);
+}
+
+
+/*
+ * setVal() - send <address><attr><value>, "attr" is in program memory (NXT_P())
+ */
+uint8_t NxtHandle::setVal(const char* attr, int32_t value){
+    if(lcd->initialized == 0) return notInit;
+    cmdAddr();
+    lcd->cmdStrP(attr);
+    lcd->cmdInt(value);
+    lcd->cmdEnd();
+    return lcd->writeCached();
+}
+
+
+/*
+ * setAttr() - set the numeric attribute "attr" of the component, as setObjAttr()
+ */
+uint8_t NxtHandle::setAttr(const char* attr, uint16_t value){
+    if(lcd->initialized == 0) return notInit;
+    cmdAddr();
+    lcd->cmdChar('.');
+    lcd->cmdStr(attr);
+    lcd->cmdChar('=');
+    lcd->cmdUint(value);
+    lcd->cmdEnd();
+    return lcd->writeCached();
+}
+
+uint8_t NxtHandle::setBackColor(uint16_t color){
+    return setVal(NXT_P(".bco="),color);
+}
+
+uint8_t NxtHandle::setForeColor(uint16_t color){
+    return setVal(NXT_P(".pco="),color);
+}
+
+
+/*
+ * NxtNumber::set() - set the 'val' property, as setNumeric()
+ */
+uint8_t NxtNumber::set(int32_t value){
+    return setVal(NXT_P(".val="),value);
+}
+
+
+/*
+ * NxtGauge::set() - set the gauge angle, range 0/360
+ */
+uint8_t NxtGauge::set(uint16_t angle){
+    if(angle > 360) return invalidData;
+    return setVal(NXT_P(".val="),angle);
+}
+
+
+/*
+ * NxtText::set() - set the 'txt' property, as setString()
+ */
+uint8_t NxtText::set(const char* value){
+    return setTxt(value);
+}
+
+#ifdef ARDUINO_ARCH_AVR
+uint8_t NxtText::set(const __FlashStringHelper* value){
+    return setTxt(value);
+}
+#endif
+
+
+/*
+ * setTxt() - send <address>.txt="<value>"
+ */
+uint8_t NxtHandle::setTxt(const char* value){
+    if(lcd->initialized == 0) return notInit;
+    cmdAddr();
+    lcd->cmdStrP(NXT_P(".txt=\""));
+    lcd->cmdStr(value);
+    lcd->cmdChar('"');
+    lcd->cmdEnd();
+    return lcd->writeCached();
+}
+
+#ifdef ARDUINO_ARCH_AVR
+uint8_t NxtHandle::setTxt(const __FlashStringHelper* value){
+    if(lcd->initialized == 0) return notInit;
+    cmdAddr();
+    lcd->cmdStrP(NXT_P(".txt=\""));
+    lcd->cmdStr(value);
+    lcd->cmdChar('"');
+    lcd->cmdEnd();
+    return lcd->writeCached();
+}
+#endif
+
+
+/*
+ * NxtWave() - bind the handle to the channel "channel" of wave object "id"
+ */
+NxtWave::NxtWave(NxtLcd& l, uint8_t id, uint8_t channel){
+    lcd = &l;
+    waveId = id;
+    ch = channel;
+    char* p = prefix;
+    memcpy(p,"add ",4);
+    p = nxtUtoa(p + 4,id);
+    *p++ = ',';
+    p = nxtUtoa(p,channel);
+    *p++ = ',';
+    *p = '\0';
+}
+
+
+/*
+ * NxtWave::add() - add a point to the channel, as addWavePoint()
+ */
+uint8_t NxtWave::add(uint8_t value){
+    if(lcd->initialized == 0) return notInit;
+    if(ch > 3) return invalidData;
+    lcd->cmdStart();
+    lcd->cmdStr(prefix);
+    lcd->cmdUint(value);
+    lcd->cmdEnd();
+    return lcd->writeBuf();
+}
@@ -0,0 +1,245 @@
+/* journal.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the following class methods:
+ *
+ * public :
+ * - setJournal()
+ * - journalClear()
+ * - replayJournal()
+ * - getJournalStats()
+ *
+ * private:
+ * - jrnAdd()
+ * - jrnRestart()
+ * - jrnLost()
+ * - jrnCheck()
+ * - jrnRecover()
+ *
+ * The journal keep the last command written to each component attribute by the same
+ * functions handled by the shadow cache (see shadow.cpp), together with the page that
+ * was current when it was sent. When the display restart by itself (power glitch,
+ * cable disconnected, watchdog) all those values are lost: as soon as the startup
+ * (0x00 0x00 0x00) and device ready (0x88) telegrams are parsed, poll() send again
+ * the commands of the current page (page 0 after a restart, or the one reported by
+ * sendme) all together, without waiting for replies (in pipeline mode the replies are
+ * matched as usual). replayJournal() can be called by the sketch too, es. after it
+ * changed page. devReset() clear the journal. Commands sent while the current page is
+ * not known (see getPage()) are not journaled.
+ * The display also forget the link setup: before the replay poll() set again the rate
+ * set with setBaud() (not persisted) and the pipeline mode (bkcmd=3). This is done even
+ * without a journal. When the runtime rate differs from the startup one, the restart
+ * telegrams can't be read: a command left without reply make poll() probe the link,
+ * and if the display answer at its startup rate the restart is handled as above.
+ * The pool is filled from the start, a new value of a component replace the old one,
+ * and when it's full the oldest entries are dropped. Each entry take 6 bytes plus the
+ * command, es. 21 bytes for "p[0].b[3].val=25".
+ *
+ * uint8_t journal[256];
+ * lcd.setJournal(journal,sizeof(journal));
+ * ...
+ * loop(){
+ *   lcd.poll();
+ *   ...
+ * }
+ *
+*/
+
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+
+#define NXT_JRN_HDR         6   //entry header: key (4), page (1), command length (1)
+
+// replay state
+#define NXT_JRN_IDLE        0
+#define NXT_JRN_START       1   //startup seen, waiting for device ready
+#define NXT_JRN_READY       2   //device ready, replay on next poll()
+#define NXT_JRN_LOST        3   //no reply at a runtime rate, probe the link on next poll()
+
+
+/*
+ * setJournal() - enable the journal, using the "pool" buffer of "size" bytes provided
+ * by user. Pass NULL to disable it.
+ */
+uint8_t NxtLcd::setJournal(uint8_t* pool, uint16_t size){
+    if(pool != NULL && size <= NXT_JRN_HDR) return invalidData;
+    jrnPool = pool;
+    jrnSize = (pool != NULL) ? size : 0;
+    jrnReplays = 0;
+    journalClear();
+    return replyCmdOk;
+}
+
+
+/*
+ * journalClear() - forget all the entries
+ */
+void NxtLcd::journalClear(void){
+    jrnLen = 0;
+    jrnState = NXT_JRN_IDLE;
+}
+
+
+/*
+ * replayJournal() - send again the journal entries of the current page, with a
+ * single burst
+ */
+uint8_t NxtLcd::replayJournal(void){
+    if(initialized == 0) return notInit;
+    if(jrnPool == NULL) return notSupported;
+    jrnState = NXT_JRN_IDLE;
+    if(reqCnt > 0) reqDrain();
+    if(pipeCnt > 0) pipeFlush();
+    uint8_t page = sysProp[nxt_dp];
+    uint16_t pos = 0;
+    while(pos < jrnLen){
+        uint8_t len = jrnPool[pos + 5];
+        if(jrnPool[pos + 4] == page){
+            if(pipeEn > 0){     // the replies are matched, not left to be discarded
+                memcpy(sendBuf,&jrnPool[pos + NXT_JRN_HDR],len);
+                sendLen = len;
+                cmdOvfl = 0;
+                if(pipeWrite() != replyCmdOk) return replyCmdFail;
+            }
+            else{
+                if(serial.write(&jrnPool[pos + NXT_JRN_HDR],len) != len) return replyCmdFail;
+                flowMark(0);
+            }
+            jrnReplays++;
+        }
+        pos += NXT_JRN_HDR + len;
+    }
+    return replyCmdOk;
+}
+
+
+/*
+ * getJournalStats() - return the bytes of the pool in use and the number of commands
+ * replayed since the journal was enabled
+ */
+uint8_t NxtLcd::getJournalStats(uint16_t* used, uint16_t* replays){
+    if(jrnPool == NULL) return notSupported;
+    (*used) = jrnLen;
+    (*replays) = jrnReplays;
+    return replyCmdOk;
+}
+
+
+/*
+ * jrnAdd() - store the command in sendBuf, whose address has hash "key"; called by
+ * writeCached() once the command was sent
+ */
+void NxtLcd::jrnAdd(uint32_t key){
+    if(sendLen > 255 || NXT_JRN_HDR + sendLen > jrnSize) return;
+    if((propValid & NXT_PROP_BIT(nxt_dp)) == 0) return;    // page unknown
+    uint8_t page = sysProp[nxt_dp];
+    uint16_t pos = 0;
+    while(pos < jrnLen){
+        uint16_t len = NXT_JRN_HDR + jrnPool[pos + 5];
+        if(memcmp(&jrnPool[pos],&key,sizeof(key)) == 0 && jrnPool[pos + 4] == page){
+            memmove(&jrnPool[pos],&jrnPool[pos + len],jrnLen - pos - len);
+            jrnLen -= len;
+            break;
+        }
+        pos += len;
+    }
+    while(jrnLen + NXT_JRN_HDR + sendLen > jrnSize){
+        uint16_t len = NXT_JRN_HDR + jrnPool[5];
+        memmove(jrnPool,&jrnPool[len],jrnLen - len);
+        jrnLen -= len;
+    }
+    uint8_t* entry = &jrnPool[jrnLen];
+    memcpy(entry,&key,sizeof(key));
+    entry[4] = page;
+    entry[5] = sendLen;
+    memcpy(&entry[NXT_JRN_HDR],sendBuf,sendLen);
+    jrnLen += NXT_JRN_HDR + sendLen;
+}
+
+
+/*
+ * jrnRestart() - called by readBuf() when the display report a startup (ready=0) or
+ * device ready (ready=1). Cached values and properties are no more valid, the display
+ * is on page 0, and the link is set up again and the journal replayed by poll() on
+ * device ready (or NXT_JRN_WAIT ms after startup, if device ready does not come).
+ */
+void NxtLcd::jrnRestart(uint8_t ready){
+    shadowClear();
+    propValid = 0;
+    propStore(nxt_dp,0);
+    if(ready) jrnState = NXT_JRN_READY;
+    else{
+        jrnState = NXT_JRN_START;
+        jrnAt = millis();
+    }
+}
+
+
+/*
+ * jrnLost() - called by rxResync() (lost=1) when a reply did not come: at a runtime
+ * rate it can be a display restart, with the restart telegrams sent at the startup
+ * rate, so poll() will probe the link. Called by linkProbe() (lost=0) once the link
+ * is checked.
+ */
+void NxtLcd::jrnLost(uint8_t lost){
+    if(lost){
+        if(jrnState == NXT_JRN_IDLE && baud != baudBoot) jrnState = NXT_JRN_LOST;
+    }
+    else if(jrnState == NXT_JRN_LOST) jrnState = NXT_JRN_IDLE;
+}
+
+
+/*
+ * jrnCheck() - called by poll(), set up the link again and replay the journal if a
+ * display restart was seen and no reply is awaited
+ */
+void NxtLcd::jrnCheck(void){
+    if(jrnState == NXT_JRN_IDLE) return;
+    if(frameEn > 0 || reqCnt > 0 || pipeCnt > 0 || frameAcks > 0) return;
+    if(jrnState == NXT_JRN_START && (uint32_t)(millis() - jrnAt) < NXT_JRN_WAIT) return;
+    uint32_t rate = baud;
+    uint8_t pipe = pipeEn;
+    if(jrnState == NXT_JRN_LOST){
+        jrnState = NXT_JRN_IDLE;
+        if(linkProbe(rate) == replyCmdOk) return;
+        if(linkProbe(baudBoot) != replyCmdOk){
+            linkProbe(rate);
+            jrnState = NXT_JRN_IDLE;    // the next missing reply will try again
+            return;
+        }
+        jrnRestart(1);
+    }
+    jrnState = NXT_JRN_IDLE;
+    jrnRecover(rate,pipe);
+    if(jrnLen > 0) replayJournal();
+}
+
+
+/*
+ * jrnRecover() - after a display restart (or devReset()), set again the link rate
+ * "rate" and the pipeline mode if "pipe", keeping the bkcmd value to restore when it
+ * will be disabled. Return the first error.
+ */
+uint8_t NxtLcd::jrnRecover(uint32_t rate, uint8_t pipe){
+    uint8_t res = replyCmdOk;
+    pipeEn = 0;
+    if(rate != baud) res = setBaud(rate);
+    if(pipe){
+        uint8_t bkcmd = pipeBkcmd;
+        uint8_t r = setPipeline(1);
+        pipeBkcmd = bkcmd;
+        if(res == replyCmdOk) res = r;
+    }
+    return res;
+}
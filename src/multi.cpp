@@ -0,0 +1,104 @@
+/* multi.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the NxtMulti class methods:
+ *
+ * public :
+ * - add()
+ * - poll()
+ * - setPipeline()
+ * - flush()
+ *
+ * NxtMulti drive up to NXT_MULTI_MAX displays, each one on its own serial port. As all the
+ * parser state is kept in the NxtLcd instances, they can run concurrently; with pipeline
+ * mode enabled the commands sent to a display don't wait for its replies, so the ports
+ * transmit in parallel and the replies of all the displays are collected by poll()/flush(),
+ * serving the displays in round robin.
+ *
+ * NxtLcd lcd1(&Serial1), lcd2(&Serial2);
+ * NxtMulti lcds;
+ * lcds.add(&lcd1);
+ * lcds.add(&lcd2);
+ * lcds.setPipeline(1);
+ * ...
+ * lcds[0]->setNumeric(3,val0);
+ * lcds[1]->setNumeric(3,val1);
+ * lcds.poll();
+ *
+*/
+
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+
+/*
+ * add() - add a display, already initialized with init(), to the driver.
+ */
+uint8_t NxtMulti::add(NxtLcd* lcd){
+    if(lcd == NULL) return invalidData;
+    if(lcdCnt == NXT_MULTI_MAX) return dataTooBig;
+    lcds[lcdCnt++] = lcd;
+    return replyCmdOk;
+}
+
+
+/*
+ * poll() - poll all the displays, without blocking. The starting display is rotated at
+ * each call, so none of them is always served last.
+ */
+uint8_t NxtMulti::poll(void){
+    for(uint8_t i = 0; i < lcdCnt; i++){
+        lcds[(next + i) % lcdCnt]->poll();
+    }
+    if(lcdCnt > 0) next = (next + 1) % lcdCnt;
+    return replyCmdOk;
+}
+
+
+/*
+ * setPipeline() - enable or disable pipeline mode on all displays, see NxtLcd::setPipeline()
+ * Return the first error found.
+ */
+uint8_t NxtMulti::setPipeline(uint8_t en){
+    uint8_t ret = replyCmdOk;
+    for(uint8_t i = 0; i < lcdCnt; i++){
+        uint8_t res = lcds[i]->setPipeline(en);
+        if(res != replyCmdOk && ret == replyCmdOk) ret = res;
+    }
+    return ret;
+}
+
+
+/*
+ * flush() - wait for the replies of the commands in flight on all displays. Displays are
+ * polled in turn, so waiting time overlap. After "wait" ms commands still without reply
+ * are recorded as errors by each display (see NxtLcd::pipeFlush()).
+ * Return the first error found.
+ */
+uint8_t NxtMulti::flush(uint16_t wait){
+    uint32_t start = millis();
+    uint8_t pending = 1;
+    while(pending > 0 && (uint32_t)(millis() - start) < wait){
+        pending = 0;
+        for(uint8_t i = 0; i < lcdCnt; i++){
+            lcds[i]->poll();
+            if(lcds[i]->getPipeCnt() > 0) pending = 1;
+        }
+    }
+    uint8_t ret = replyCmdOk;
+    for(uint8_t i = 0; i < lcdCnt; i++){
+        uint8_t res = lcds[i]->pipeFlush(0);
+        if(res != replyCmdOk && ret == replyCmdOk) ret = res;
+    }
+    return ret;
+}
@@ -0,0 +1,293 @@
+/* nxt_coro.h
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Optional C++20 coroutine front-end, usable only with a toolchain supporting
+ * coroutines (es. ESP32 with -std=gnu++20), otherwise this file is empty.
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * The awaitables wrap the async get functions (see async.cpp): the coroutine is
+ * suspended until the reply is parsed, meanwhile other coroutines (or the rest of
+ * loop()) keep running. A NxtCoSched, driven by run() called from loop(), poll the
+ * display and resume the coroutines whose reply arrived or whose delay expired.
+ * Coroutines are started calling them, and must return NxtCoTask.
+ *
+ * The display needs request slots (see setReqSlots()), one for each get in flight.
+ *
+ * NxtLcd lcd(&Serial2);
+ * NxtCoSched sched(&lcd);
+ * nxtReq_t slots[4];
+ *
+ * NxtCoTask speedFlow(void){
+ *   int32_t speed;
+ *   for(;;){
+ *     if(co_await nxtGetNumeric(sched,"n0",&speed) == replyCmdOk) lcd.setNumeric("n1",speed * 2);
+ *     co_await nxtDelay(sched,100);
+ *   }
+ * }
+ *
+ * setup(){ ... lcd.setReqSlots(slots,4); speedFlow(); }
+ * loop(){ sched.run(); }
+ *
+*/
+
+#ifndef __NXT_CORO_H__
+#define __NXT_CORO_H__
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+
+#include <coroutine>
+#include <stdlib.h>
+#include "nxt_lcd.h"
+
+#ifndef NXT_CO_MAX
+#define NXT_CO_MAX                8   //max coroutines suspended at the same time on a NxtCoSched
+#endif
+
+/*
+ * Every coroutine suspended on a NxtCoSched is in one state: waiting for a reply,
+ * sleeping or ready. An await is refused (co_await return dataTooBig at once) when
+ * NXT_CO_MAX are already suspended, so the ready list can always take them all and
+ * a coroutine is only resumed by run(), never from inside the reply parser.
+*/
+
+
+/*
+ * NxtCoTask - return type of the coroutines, started at once and destroyed at the end
+*/
+struct NxtCoTask {
+    struct promise_type {
+        NxtCoTask           get_return_object(void){return NxtCoTask();};
+        std::suspend_never  initial_suspend(void) noexcept {return {};};
+        std::suspend_never  final_suspend(void) noexcept {return {};};
+        void                return_void(void){};
+        void                unhandled_exception(void){abort();};
+    };
+};
+
+
+/*
+ * NxtCoSched - a single threaded scheduler for the coroutines using one display
+*/
+class NxtCoSched{
+private:
+    NxtLcd*                     lcd;
+    std::coroutine_handle<>     ready[NXT_CO_MAX];
+    uint8_t                     readyCnt = 0;
+    std::coroutine_handle<>     sleeping[NXT_CO_MAX];
+    uint32_t                    wakeAt[NXT_CO_MAX];
+    uint8_t                     sleepCnt = 0;
+    uint8_t                     waitCnt = 0;
+
+public:
+    NxtCoSched(NxtLcd* l){lcd = l;};
+    NxtLcd*     display(void){return lcd;};
+
+    /*
+     * post() - mark a coroutine (sleeping or waiting until now) as ready, it's resumed
+     * by next run()
+     */
+    uint8_t     post(std::coroutine_handle<> h){
+        if(readyCnt == NXT_CO_MAX) return 0;
+        ready[readyCnt++] = h;
+        return 1;
+    };
+
+    /*
+     * sleep() - resume the coroutine after "ms" milliseconds; 0 if too many are suspended
+     */
+    uint8_t     sleep(std::coroutine_handle<> h, uint32_t ms){
+        if(pending() >= NXT_CO_MAX) return 0;
+        sleeping[sleepCnt] = h;
+        wakeAt[sleepCnt] = millis() + ms;
+        sleepCnt++;
+        return 1;
+    };
+
+    /*
+     * run() - poll the display, then resume the coroutines whose reply arrived or whose
+     * delay expired. Call it from loop(). Return the number of coroutines resumed.
+     */
+    uint8_t     run(void){
+        lcd->poll();
+        uint8_t i = 0;
+        while(i < sleepCnt){
+            if((int32_t)(millis() - wakeAt[i]) >= 0){
+                post(sleeping[i]);
+                sleepCnt--;
+                sleeping[i] = sleeping[sleepCnt];
+                wakeAt[i] = wakeAt[sleepCnt];
+            }
+            else i++;
+        }
+        uint8_t cnt = readyCnt;
+        std::coroutine_handle<> run[NXT_CO_MAX];
+        for(i = 0; i < cnt; i++) run[i] = ready[i];
+        readyCnt = 0;
+        for(i = 0; i < cnt; i++) run[i].resume();
+        return cnt;
+    };
+
+    /*
+     * waitBegin()/waitEnd() - a coroutine is waiting for a reply, see NxtCoGet;
+     * waitBegin() return 0 if too many are suspended
+     */
+    uint8_t     waitBegin(void){
+        if(pending() >= NXT_CO_MAX) return 0;
+        waitCnt++;
+        return 1;
+    };
+    void        waitEnd(void){waitCnt--;};
+
+    /*
+     * pending() - number of coroutines suspended: ready, sleeping or waiting for a reply
+     */
+    uint8_t     pending(void){return readyCnt + sleepCnt + waitCnt;};
+};
+
+
+/*
+ * NxtCoGet - awaitable for an async get. co_await return the readCode_t result,
+ * the value is stored as with the blocking functions.
+*/
+class NxtCoGet{
+public:
+    typedef uint8_t (*issue_t)(NxtCoGet* g, uint8_t* handle);
+
+    NxtCoSched*                 sched;
+    std::coroutine_handle<>     coro;
+    issue_t                     issue;
+    uint8_t                     res = noReply;
+    uint8_t                     page;
+    uint8_t                     obj;
+    const char*                 name;
+    const char*                 attr;
+    void*                       value;
+    uint16_t                    size;
+
+    NxtCoGet(NxtCoSched& s, issue_t f){sched = &s; issue = f;};
+
+    static void     done(uint8_t handle, uint8_t r, void* ctx){
+        (void)handle;
+        NxtCoGet* g = (NxtCoGet*)ctx;
+        g->res = r;
+        g->sched->waitEnd();
+        g->sched->post(g->coro);    // always room, see above
+    };
+
+    bool            await_ready(void){return false;};
+    bool            await_suspend(std::coroutine_handle<> h){
+        coro = h;
+        uint8_t handle;
+        if(sched->waitBegin() == 0){
+            res = dataTooBig;
+            return false;
+        }
+        res = issue(this,&handle);
+        if(res == replyCmdOk) return true;
+        sched->waitEnd();           // on error we are not suspended
+        return false;
+    };
+    uint8_t         await_resume(void){return res;};
+};
+
+
+/*
+ * NxtCoDelay - awaitable to wait "ms" milliseconds without blocking the others.
+ * co_await return replyCmdOk, or dataTooBig if the delay was not done (too many
+ * coroutines suspended)
+*/
+class NxtCoDelay{
+public:
+    NxtCoSched*     sched;
+    uint32_t        ms;
+    uint8_t         res = replyCmdOk;
+
+    NxtCoDelay(NxtCoSched& s, uint32_t t){sched = &s; ms = t;};
+    bool            await_ready(void){return ms == 0;};
+    bool            await_suspend(std::coroutine_handle<> h){
+        if(sched->sleep(h,ms) == 1) return true;
+        res = dataTooBig;
+        return false;
+    };
+    uint8_t         await_resume(void){return res;};
+};
+
+
+/*
+ * awaitable factories, "field"/"obj" are addressed as in the blocking functions,
+ * name or id on current page, or page and object ids
+*/
+inline NxtCoGet nxtGetNumeric(NxtCoSched& s, const char* field, int32_t* value){
+    NxtCoGet g(s,[](NxtCoGet* g, uint8_t* h) -> uint8_t {
+        return g->sched->display()->getNumericAsync(g->name,g->value,g->size,h,NxtCoGet::done,g);
+    });
+    g.name = field;
+    g.value = value;
+    g.size = sizeof(int32_t);
+    return g;
+}
+
+inline NxtCoGet nxtGetNumeric(NxtCoSched& s, uint8_t page, uint8_t field, int32_t* value){
+    NxtCoGet g(s,[](NxtCoGet* g, uint8_t* h) -> uint8_t {
+        return g->sched->display()->getNumericAsync(g->page,g->obj,g->value,g->size,h,NxtCoGet::done,g);
+    });
+    g.page = page;
+    g.obj = field;
+    g.value = value;
+    g.size = sizeof(int32_t);
+    return g;
+}
+
+inline NxtCoGet nxtGetString(NxtCoSched& s, const char* field, char* value, uint16_t size){
+    NxtCoGet g(s,[](NxtCoGet* g, uint8_t* h) -> uint8_t {
+        return g->sched->display()->getStringAsync(g->name,(char *)g->value,g->size,h,NxtCoGet::done,g);
+    });
+    g.name = field;
+    g.value = value;
+    g.size = size;
+    return g;
+}
+
+inline NxtCoGet nxtGetString(NxtCoSched& s, uint8_t page, uint8_t field, char* value, uint16_t size){
+    NxtCoGet g(s,[](NxtCoGet* g, uint8_t* h) -> uint8_t {
+        return g->sched->display()->getStringAsync(g->page,g->obj,(char *)g->value,g->size,h,NxtCoGet::done,g);
+    });
+    g.page = page;
+    g.obj = field;
+    g.value = value;
+    g.size = size;
+    return g;
+}
+
+inline NxtCoGet nxtGetObjAttr(NxtCoSched& s, const char* obj, const char* attr, uint16_t* value){
+    NxtCoGet g(s,[](NxtCoGet* g, uint8_t* h) -> uint8_t {
+        return g->sched->display()->getObjAttrAsync(g->name,g->attr,(uint16_t *)g->value,h,NxtCoGet::done,g);
+    });
+    g.name = obj;
+    g.attr = attr;
+    g.value = value;
+    return g;
+}
+
+inline NxtCoGet nxtGetProperty(NxtCoSched& s, uint8_t prop, uint16_t* value){
+    NxtCoGet g(s,[](NxtCoGet* g, uint8_t* h) -> uint8_t {
+        return g->sched->display()->getPropertyAsync(g->obj,(uint16_t *)g->value,h,NxtCoGet::done,g);
+    });
+    g.obj = prop;
+    g.value = value;
+    return g;
+}
+
+inline NxtCoDelay nxtDelay(NxtCoSched& s, uint32_t ms){
+    return NxtCoDelay(s,ms);
+}
+
+
+#endif // __has_include(<coroutine>)
+#endif // __cpp_impl_coroutine
+
+#endif //__NXT_CORO_H__
@@ -41,8 +41,61 @@
 #endif
 
 
-//anyserial - a small wrapper to use indifferently hardware or software serial
-class anySerial{
+/*
+ * define NXT_STREAM_SERIAL (before including this file, or in the build flags) to be able
+ * to drive the display through any Stream object, es. a USB-serial bridge, a software
+ * emulator or a fake serial used for tests. The Stream must be already opened, init()
+ * will not change its baudrate. Without it, anySerial does not pay the extra check.
+*/
+#ifdef NXT_STREAM_SERIAL
+#define NXT_STREAM_FWD(call) if(stream) return stream->call;
+#define NXT_STREAM_RET(v)    if(stream) return v;
+#else
+#define NXT_STREAM_FWD(call)
+#define NXT_STREAM_RET(v)
+#endif
+
+#define NXT_TX_NOLIMIT       0x7FFF  //availableForWrite() of ports that just block on write
+
+
+/*
+ * define NXT_SERIAL_TYPE as the class of the port used (es. -DNXT_SERIAL_TYPE=HardwareSerial)
+ * when all the displays of the sketch are on the same kind of port: anySerial then holds
+ * only that pointer, and read()/write()/available() call the port without checks.
+ * The class must have begin(), end(), available(), read() and write(buf,len). If it
+ * keep the availableForWrite() of Print, that return 0 (es. SoftwareSerial), the port
+ * is taken as one that just block on write (NXT_TX_NOLIMIT), as the runtime anyPort do,
+ * otherwise it must return the real free room when the TX ring is used (see below).
+ * NxtLcd is not a template on the port type on purpose: the runtime choice cost a
+ * branch per call, a template would cost a copy of the whole driver for each kind of
+ * port used in the sketch, and all the code in the headers.
+*/
+#ifdef NXT_SERIAL_TYPE
+// nxtPortFifo<&T::availableForWrite type>::known - 0 if T does not override Print's one
+template<typename F> struct nxtPortFifo{static const uint8_t known = 1;};
+template<> struct nxtPortFifo<int (Print::*)(void)>{static const uint8_t known = 0;};
+
+class anyPort{
+private:
+    NXT_SERIAL_TYPE*    port;
+    
+public:
+    anyPort(void){};
+    void   init(NXT_SERIAL_TYPE* p){port=p;};
+    void   begin(uint32_t baud){port->begin(baud);};
+    void   end(void){port->end();};
+    int    available(void){return port->available();};
+    int    read(void){return port->read();};
+    size_t write(const unsigned char* b, size_t s){return port->write(b,s);};
+    int    availableForWrite(void){
+        if(nxtPortFifo<decltype(&NXT_SERIAL_TYPE::availableForWrite)>::known == 0) return NXT_TX_NOLIMIT;
+        return port->availableForWrite();
+    };
+};
+#else
+
+//anyPort - a small wrapper to use indifferently hardware or software serial
+class anyPort{
 private:
 #ifdef NXT_HAVE_SS
     SoftwareSerial*     swSerial;
@@ -58,9 +111,12 @@ private:
 #if defined(ARDUINO_ARCH_SAMD)
     Serial_*     hwSerial;    
 #endif
+#ifdef NXT_STREAM_SERIAL
+    Stream*             stream = NULL;
+#endif
     
 public:
-    anySerial(void){};
+    anyPort(void){};
 #ifdef NXT_HAVE_HS
     void   init(HardwareSerial* port){hwSerial=port;swSerial=NULL;};
 #endif
@@ -73,49 +129,190 @@ public:
 #ifdef NXT_HAVE_SS    
     void   init(SoftwareSerial* port){hwSerial=NULL;swSerial=port;};
 #endif
+#ifdef NXT_STREAM_SERIAL
+    void   init(Stream* port){hwSerial=NULL;swSerial=NULL;stream=port;};
+#endif
 #ifdef NXT_HAVE_SS        
-    void   begin(uint32_t baud){if(hwSerial) hwSerial->begin(baud);else swSerial->begin(baud);};
+    void   begin(uint32_t baud){NXT_STREAM_RET() if(hwSerial) hwSerial->begin(baud);else swSerial->begin(baud);};
 #else
-    void   begin(uint32_t baud){hwSerial->begin(baud);};
+    void   begin(uint32_t baud){NXT_STREAM_RET() hwSerial->begin(baud);};
 #endif
 #ifdef NXT_HAVE_SS
-    void   end(void){if(hwSerial) hwSerial->end();else swSerial->end();};
+    void   end(void){NXT_STREAM_RET() if(hwSerial) hwSerial->end();else swSerial->end();};
 #else
-    void   end(void){hwSerial->end();};
+    void   end(void){NXT_STREAM_RET() hwSerial->end();};
 #endif
 #ifdef NXT_HAVE_SS
-    int    available(void){if(hwSerial) return hwSerial->available();else return swSerial->available();};
+    int    available(void){NXT_STREAM_FWD(available()) if(hwSerial) return hwSerial->available();else return swSerial->available();};
 #else
-    int    available(void){return hwSerial->available();};
+    int    available(void){NXT_STREAM_FWD(available()) return hwSerial->available();};
 #endif
 #ifdef NXT_HAVE_SS
-    int    read(void){if(hwSerial) return hwSerial->read();else return swSerial->read();};
+    int    read(void){NXT_STREAM_FWD(read()) if(hwSerial) return hwSerial->read();else return swSerial->read();};
 #else
-    int    read(void){return hwSerial->read();};
+    int    read(void){NXT_STREAM_FWD(read()) return hwSerial->read();};
 #endif
 #ifdef NXT_HAVE_SS
-    size_t write(const unsigned char* b, size_t s){if(hwSerial) return hwSerial->write(b,s);else return swSerial->write(b,s);};
+    size_t write(const unsigned char* b, size_t s){NXT_STREAM_FWD(write(b,s)) if(hwSerial) return hwSerial->write(b,s);else return swSerial->write(b,s);};
 #else
-    size_t write(const unsigned char* b, size_t s){return hwSerial->write(b,s);};
+    size_t write(const unsigned char* b, size_t s){NXT_STREAM_FWD(write(b,s)) return hwSerial->write(b,s);};
+#endif
+#ifdef NXT_HAVE_SS
+    int    availableForWrite(void){NXT_STREAM_RET(NXT_TX_NOLIMIT) if(hwSerial) return hwSerial->availableForWrite();else return NXT_TX_NOLIMIT;};
+#else
+    int    availableForWrite(void){NXT_STREAM_RET(NXT_TX_NOLIMIT) return hwSerial->availableForWrite();};
+#endif
+};
+#endif //NXT_SERIAL_TYPE
+
+
+/*
+ * commands waiting for a reply tracked by the flow controller, see any_serial.cpp
+*/
+#ifndef NXT_FC_MARKS
+#define NXT_FC_MARKS              8
 #endif
+
+/*
+ * anySerial - the port, plus an optional transmit ring (see any_serial.cpp): when a
+ * buffer is given with setTxBuf(), write() only queue the bytes, service() move them to
+ * the port as long as its FIFO has room, without ever blocking.
+ * With setFlow() the bytes sent are also limited by the credits left in the display
+ * input buffer, as modelled by the flow controller.
+*/
+class anySerial : public anyPort{
+private:
+    uint8_t*    txBuf = NULL;
+    uint16_t    txSize = 0;
+    uint16_t    txHead = 0;
+    uint16_t    txCnt = 0;
+    uint16_t    fcLimit = 0;
+    uint16_t    fcUsed = 0;
+    uint16_t    fcRate = 0;
+    uint16_t    fcMax = 0;
+    uint16_t    fcOvfl = 0;
+    uint32_t    fcLast = 0;
+    uint32_t    fcHold = 0;
+    uint8_t     fcHolding = 0;
+    uint16_t    fcSent = 0;                     // bytes written to the port, wrapping
+    uint16_t    fcMarkPos[NXT_FC_MARKS];        // fcSent at the end of the command
+    uint16_t    fcMarkCnt[NXT_FC_MARKS];        // replies still expected for it
+    uint8_t     fcMarkHead = 0;
+    uint8_t     fcMarks = 0;
+    
+    uint16_t credit(void);
+    size_t   portWrite(const unsigned char* b, size_t s, uint8_t block);
+    
+public:
+    anySerial(void){};
+    void     setTxBuf(uint8_t* buf, uint16_t size);
+    size_t   write(const unsigned char* b, size_t s);
+    void     service(void);
+    void     flushTx(void);
+    uint16_t txPending(void){return txCnt;};
+    void     setFlow(uint16_t limit, uint32_t baud);
+    void     mark(uint16_t replies);
+    void     markClear(void){fcMarks = 0;};
+    void     ack(void);
+    void     overflow(void);
+    uint16_t flowLimit(void){return fcLimit;};
+    uint16_t flowUsed(void){return fcUsed;};
+    uint16_t flowOvfl(void){return fcOvfl;};
 };
 
 
 
 /*
- * a buffer is used for both writing and reading of display command/reply.
- * The size influence the weight in RAM memory of the NxtLcd instance.
+ * All the sizes below can be overridden defining them in the build flags, es.
+ * -DNXT_BUF_SIZE=64 for a small board with short commands.
+ *
+ * a buffer is used for writing display command, another one of the same size for 
+ * reading the replies. The size influence the weight in RAM memory of the NxtLcd instance.
 */
+#ifndef NXT_BUF_SIZE
 #define NXT_BUF_SIZE              128
+#endif
 
-#define NXT_EV_BUF_SIZE           10
+/*
+ * incoming bytes are stored in a ring before being parsed, see rxPush().
+ * Size must be a power of 2, max 256.
+*/
+#ifndef NXT_RX_RING_SIZE
+#define NXT_RX_RING_SIZE          64
+#endif
+
+/*
+ * number of events that can be queued before ckEvents() is called; events arriving
+ * when the queue is full are dropped (see getEvDropped())
+*/
+#ifndef NXT_EV_QUEUE_SIZE
+#define NXT_EV_QUEUE_SIZE         8
+#endif
 
-#define NXT_REPLY_WAIT            20  
+#ifndef NXT_REPLY_WAIT
+#define NXT_REPLY_WAIT            20  //max ms to wait for a reply, we return as soon as it arrive
+#endif
 
 #define NXT_MSG_END               0xFF,0xFF,0xFF
 
+/*
+ * string literal used to build commands, placed in program memory on AVR (see cmd_buf.cpp)
+*/
+#ifdef ARDUINO_ARCH_AVR
+#define NXT_P(s)                  PSTR(s)
+#else
+#define NXT_P(s)                  (s)
+#endif
+
 #define NXT_PROP_SIZE             7
 
+#ifndef NXT_DEV_BUF_SIZE
+#define NXT_DEV_BUF_SIZE          1024  //display serial input buffer
+#endif
+
+#ifndef NXT_FC_LIMIT
+#define NXT_FC_LIMIT              (NXT_DEV_BUF_SIZE - 64) //max bytes in the display buffer with flow control, see any_serial.cpp
+#endif
+
+/*
+ * transparent data (addWaveBytes()) chunk size, must fit in the display serial buffer;
+ * NXT_TD_WAIT is the max wait (ms) for the 0xFE and 0xFD replies
+*/
+#ifndef NXT_TD_CHUNK_SIZE
+#define NXT_TD_CHUNK_SIZE         (NXT_DEV_BUF_SIZE - 24)
+#endif
+#ifndef NXT_TD_WAIT
+#define NXT_TD_WAIT               100
+#endif
+
+#ifndef NXT_PIPE_DEPTH
+#define NXT_PIPE_DEPTH            8   //max commands in flight in pipeline mode, see setPipeline()
+#endif
+
+#ifndef NXT_REQ_SLOTS
+#define NXT_REQ_SLOTS             4   //request slots used by init() in nxt_propPipe mode, see async.cpp
+#endif
+
+#ifndef NXT_REQ_WAIT
+#define NXT_REQ_WAIT              100 //max ms to wait for the reply to an async request
+#endif
+
+#ifndef NXT_MULTI_MAX
+#define NXT_MULTI_MAX             4   //max displays handled by a NxtMulti instance
+#endif
+
+#ifndef NXT_BAUD_WAIT
+#define NXT_BAUD_WAIT             50  //ms given to the display to switch baudrate, see baud.cpp
+#endif
+
+#ifndef NXT_JRN_WAIT
+#define NXT_JRN_WAIT              500 //max ms to wait for device ready after a display startup, see journal.cpp
+#endif
+
+#ifndef NXT_NAME_MAX
+#define NXT_NAME_MAX              30  //max length of a name learned by the resolver (<page>.<object>), see resolver.cpp
+#endif
+
 
 /*
 void serialLogStr(const char *msg, const char *value = NULL);
@@ -213,6 +410,32 @@ typedef enum {
 #define nxtBasicEnd     nxt_usup
 #define nxtEnhancedEnd  nxt_rtc6
 
+/*
+ * define NXT_DISP_TYPE (0:basic; 1:ehnached; 2:professional, see dispType_t) in the build
+ * flags to fix the display type at compile time: the type checks are resolved by the
+ * compiler, only the properties of that display are stored, and functions not supported
+ * by it (setDate(), setTime() on basic displays) are not declared at all, so using them
+ * is a compile error. init() will then refuse a different "dispType".
+*/
+#if defined(NXT_DISP_TYPE) && NXT_DISP_TYPE == 0
+#define NXT_PROP_CNT    (nxtBasicEnd + 1)
+#elif defined(NXT_DISP_TYPE) && NXT_DISP_TYPE == 1
+#define NXT_PROP_CNT    (nxtEnhancedEnd + 1)
+#else
+#define NXT_PROP_CNT    sysPropLen
+#endif
+
+/*
+ * how init() read the system properties, see init() in basic_func.cpp
+*/
+typedef enum {
+    nxt_propEager,      //all read at once, one get after the other
+    nxt_propLazy,       //none read, each one is asked the first time getProperty(...,loc=1) need it
+    nxt_propPipe        //all read at once, sending the gets back to back (see async.cpp)
+} propMode_t;
+
+#define NXT_PROP_BIT(p)           ((uint32_t)1 << (p))  //bit of property "p" in propValid
+
 /*
  * code returned from display in reply of commands
  * see https://nextion.tech/instruction-set/#s7
@@ -302,7 +525,125 @@ typedef struct {
 } nxtEvent_t;
 
 
+/*
+ * nxtEvHandler_t - an event handler, called with the event and the user pointer "ctx"
+ * given when registering it. nxtHandler_t is an entry of the handler table, see
+ * setHandlers() and dispatch.cpp
+*/
+typedef void (*nxtEvHandler_t)(nxtEvent_t* ev, void* ctx);
+
+typedef struct {
+    uint32_t       key;
+    uint8_t        mask;
+    nxtEvHandler_t fn;
+    void*          ctx;
+} nxtHandler_t;
+
+#define NXT_EV_RELEASE            0x01  //handler mask: touch released (event=0)
+#define NXT_EV_PRESS              0x02  //handler mask: touch pressed (event=1)
+#define NXT_EV_BOTH               0x03
+#define NXT_EV_MOVE               0x04  //handler mask: touch moved (event=NXT_XY_MOVE)
+#define NXT_EV_ALL                0x07
+
+/*
+ * XY touch coalescing modes, see setXYMode() in touch.cpp
+*/
+typedef enum {
+    nxt_xyOff,          //every 0x67/0x68 telegram is an event
+    nxt_xyLatest,       //moves between two reads of the queue are merged in one
+    nxt_xyStroke        //as above, and all the points are stored in the stroke buffer
+} xyMode_t;
+
+#define NXT_XY_MOVE               2     //"event" of the merged move events
+#define NXT_STROKE_BREAK          0xFFFF //x of the point between two strokes in the stroke buffer
+
+/*
+ * nxtPoint_t - a point of the stroke buffer; a point with x=NXT_STROKE_BREAK separate
+ * two strokes
+*/
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+} nxtPoint_t;
+
+
+/*
+ * nxtShadow_t - an entry of the shadow cache, see setShadow()
+*/
+typedef struct {
+    uint32_t key;
+    uint32_t value;
+} nxtShadow_t;
+
+/*
+ * nxtName_t - an entry of the name resolver, see setResolver()
+*/
+typedef struct {
+    uint32_t key;
+    uint8_t  page;
+    uint8_t  id;
+} nxtName_t;
+
+/*
+ * nxtNameLearn_t - the name waiting for its ids to be asked, see setResolver()
+*/
+typedef struct {
+    char     name[NXT_NAME_MAX];
+    uint8_t  len;                   //0 if none
+    uint8_t  page;
+    uint8_t  rel;                   //it's an <object_name>
+    uint32_t key;
+} nxtNameLearn_t;
+
+#define NXT_HASH_INIT   2166136261UL    //FNV-1a offset basis
+uint32_t nxtHash(const uint8_t* buf, uint16_t len, uint32_t h = NXT_HASH_INIT);
+
+/*
+ * nxtSnap_t - snapshot of the system properties, saved and loaded by the user callback
+ * nxtSnapIo_t (save=1 to store it, 0 to read it back; return 1 on success), see snapshot.cpp
+*/
+typedef struct {
+    uint32_t sum;                   //nxtHash of the fields below
+    uint32_t valid;                 //propValid
+    uint16_t tag;                   //value written in the check property
+    uint8_t  dispType;
+    uint8_t  propCnt;
+    uint16_t prop[NXT_PROP_CNT];    //current page included (nxt_dp)
+} nxtSnap_t;
+
+typedef uint8_t (*nxtSnapIo_t)(uint8_t save, nxtSnap_t* snap, void* ctx);
+
+
+/*
+ * nxtReqCb_t - callback called when an async get request complete, with the handle
+ * returned by the get*Async() function, the readCode_t result and the user pointer
+ * "ctx" passed to it. See async.cpp
+*/
+typedef void (*nxtReqCb_t)(uint8_t handle, uint8_t res, void* ctx);
+
+/*
+ * nxtReq_t - an async get request slot
+*/
+typedef struct {
+    void*       dest;
+    uint16_t    size;
+    uint8_t     type;
+    uint8_t     prop;
+    uint8_t     state;
+    uint8_t     res;
+    nxtReqCb_t  cb;
+    void*       ctx;
+    uint8_t     fifo;       //slot in flight at this position, see reqSend()
+    uint8_t     cbFifo;     //slot to call at this position, see reqDone()
+} nxtReq_t;
+
+
 class NxtLcd{
+    friend class NxtHandle;
+    friend class NxtWave;
+#ifdef NXT_HOST_EMU
+    friend class NxtHostAccess;     // host tests and benchmarks, see extras/host/nxt_access.h
+#endif
 private:
 //#ifdef NXT_HAVE_SS    
     anySerial           serial;
@@ -311,23 +652,164 @@ private:
 //#endif
     uint8_t             initialized;
     uint8_t             debug;
+    uint32_t            baud = 0;
+    uint32_t            baudBoot = 0;
     uint8_t             sendBuf[NXT_BUF_SIZE];
-    uint8_t             evtBuf[NXT_EV_BUF_SIZE];
-    uint8_t*            recvBuf=sendBuf;
+    uint16_t            sendLen = 0;
+    uint8_t             cmdOvfl = 0;
+    uint32_t            txEnd = 0;          //us, when the port should end sending, see txSent()
+    uint32_t            cmdKeyHash = 0;     //hash of sendBuf with the name replaced by nameUse(), see cmdKey()
+    uint16_t            cmdKeyEnd = 0;      //end of the id form that replaced it, 0 if none
+    uint8_t             recvBuf[NXT_BUF_SIZE];
+    volatile uint8_t    rxRing[NXT_RX_RING_SIZE];
+    volatile uint8_t    rxHead = 0;
+    volatile uint8_t    rxTail = 0;
+    uint16_t            rxDropped = 0;
+    uint16_t            rxCnt = 0;
+    uint8_t             rxExpLen = 3;
+    uint8_t             rxSkip = 0;
+    uint32_t            rxSkipAt = 0;
     uint8_t             lastTouchCode;
+#ifdef NXT_DISP_TYPE
+    static const uint8_t dispType = NXT_DISP_TYPE;
+#else
     uint8_t             dispType;
+#endif
     uint8_t             wrongIdCode;
-    uint8_t             haveEvent;
     uint16_t            getStrLen;
-    uint16_t            sysProp[sysPropLen];
-    nxtEvent_t          lastEvent;
+    uint16_t            sysProp[NXT_PROP_CNT] = {};
+    uint32_t            propValid = 0;
+    uint16_t            initMs[2] = {};
+    nxtSnapIo_t         snapIo = NULL;
+    void*               snapCtx = NULL;
+    uint8_t             snapCheck = nxt_sys2;
+    uint8_t             snapDirty = 0;
+    uint8_t             warmBoot = 0;
+    uint8_t*            jrnPool = NULL;
+    uint16_t            jrnSize = 0;
+    uint16_t            jrnLen = 0;
+    uint8_t             jrnState = 0;
+    uint32_t            jrnAt = 0;
+    uint16_t            jrnReplays = 0;
+    nxtEvent_t          evQueue[NXT_EV_QUEUE_SIZE];
+    uint8_t             evHead = 0;
+    uint8_t             evCnt = 0;
+    uint16_t            evDropped = 0;
+    uint8_t             evHnd[NXT_EV_QUEUE_SIZE];
+    nxtHandler_t*       hndTbl = NULL;
+    uint8_t             hndSize = 0;
+    uint8_t             hndCnt = 0;
+    uint8_t             hndFilter = 0;
+    uint16_t            evFiltered = 0;
+    uint8_t             xyMode = nxt_xyOff;
+    uint8_t             touchDown = 0;
+    uint16_t            xyMerged = 0;
+    nxtPoint_t*         strokeBuf = NULL;
+    uint16_t            strokeSize = 0;
+    uint16_t            strokeLen = 0;
+    uint16_t            strokeDrawn = 0;
+    uint8_t             strokeMinDist = 0;
+    uint8_t             strokeGen = 0;          // changed when stored points move or are dropped
+    uint16_t            strokeLost = 0;
+    uint16_t            cmdSeq = 0;
+    uint8_t             pipeEn = 0;
+    uint8_t             pipeBkcmd = 2;
+    uint8_t             pipeHead = 0;
+    uint8_t             pipeCnt = 0;
+    uint8_t             pipeErr = replyCmdOk;
+    uint8_t             pipeErrId = 0;
+    uint16_t            pipeErrSeq = 0;
+    uint16_t            pipeSeq[NXT_PIPE_DEPTH];
+    nxtShadow_t*        shadowTbl = NULL;
+    uint8_t             shadowSize = 0;
+    uint8_t             shadowNext = 0;
+    uint32_t            shadowHits = 0;
+    uint32_t            shadowMisses = 0;
+    uint8_t*            frameBuf = NULL;
+    uint16_t            frameSize = 0;
+    uint16_t            frameLen = 0;
+    uint16_t            frameCmds = 0;
+    uint16_t            frameAcks = 0;
+    uint16_t            frameSeq = 0;
+    uint8_t             frameEn = 0;
+    uint8_t             frameRef = 0;
+    nxtReq_t*           reqSlot = NULL;
+    uint8_t             reqSize = 0;
+    uint8_t             reqHead = 0;
+    uint8_t             reqCnt = 0;
+    uint32_t            reqStart = 0;
+    uint8_t             reqCbHead = 0;
+    uint8_t             reqCbCnt = 0;
+    nxtName_t*          nameTbl = NULL;
+    uint8_t             nameSize = 0;
+    uint8_t             nameNext = 0;
+    nxtNameLearn_t*     nameNew = NULL;
+    uint8_t             pageSure = 0;       //sysProp[nxt_dp] is the current page, see resolver.cpp
+    uint32_t            nameSaved = 0;
     
     uint8_t             getPropCnt(void);
     uint8_t             chkProperty(const char* prop);
     uint8_t             chkProperty(uint8_t prop);
-    void                bufReset(uint8_t* buf){memset(buf,0,NXT_BUF_SIZE);};
-    uint8_t             readEvent(uint8_t* buf=NULL);
-    uint8_t             readBuf(uint8_t ckevt = 0);
+    void                propStore(uint8_t propNdx, uint16_t value);
+    void                cmdStart(void);
+    void                cmdStr(const char* s);
+    void                cmdStrP(const char* s);
+    void                cmdChar(char c);
+    void                cmdUint(uint32_t value);
+    void                cmdInt(int32_t value);
+    void                cmdObj(const char* page, const char* obj);
+    void                cmdObj(uint8_t page, uint8_t obj);
+    void                cmdObj(const char* obj);
+    void                cmdObj(uint8_t obj);
+#ifdef ARDUINO_ARCH_AVR
+    void                cmdStr(const __FlashStringHelper* s);
+    void                cmdObj(const __FlashStringHelper* page, const __FlashStringHelper* obj);
+    void                cmdObj(const __FlashStringHelper* obj);
+#endif
+    void                cmdEnd(void);
+    void                rxFill(void);
+    uint8_t             readEvent(uint8_t parsed = 0);
+    void                rxPoll(void);
+    uint8_t             readBuf(void);
+    void                rxResync(void);
+    void                rxSkipWait(void);
+    uint8_t             waitReply(uint16_t wait);
+    void                txSent(uint16_t len);
+    uint16_t            txLeftMs(void);
+    uint8_t             waitFor(uint8_t expReply, uint16_t wait);
+    uint8_t             pipeWrite(void);
+    uint8_t             pipeService(uint16_t wait);
+    void                pipeAck(uint8_t res);
+    uint8_t             writeCached(void);
+    uint32_t            cmdKey(uint16_t end);
+    uint8_t             frameAdd(void);
+    uint8_t             frameSend(void);
+    uint8_t             reqSend(uint8_t type, void* dest, uint16_t size, uint8_t* handle,
+                                nxtReqCb_t cb, void* ctx, uint8_t prop = 0);
+    void                reqWait(uint16_t wait);
+    void                reqDrain(void);
+    void                reqDone(uint8_t res);
+    void                reqCall(void);
+    void                reqCheck(void);
+    nxtName_t*          nameFind(uint32_t key);
+    void                nameStore(uint32_t key, uint8_t page, uint8_t id);
+    void                nameUse(uint16_t start, uint16_t dot);
+    void                nameLearn(void);
+    uint8_t             hndFind(uint32_t key);
+    uint8_t             hndMatch(nxtEvent_t* ev);
+    uint8_t             hndSet(uint32_t key, uint8_t mask, nxtEvHandler_t fn, void* ctx);
+    uint8_t             xyCoalesce(nxtEvent_t* ev);
+    void                strokeAdd(nxtEvent_t* ev);
+    void                strokeStart(void);
+    uint8_t             snapLoad(void);
+    void                jrnAdd(uint32_t key);
+    void                jrnRestart(uint8_t ready);
+    void                jrnCheck(void);
+    void                jrnLost(uint8_t lost);
+    uint8_t             jrnRecover(uint32_t rate, uint8_t pipe);
+    void                flowAck(uint8_t res);
+    void                flowMark(uint8_t expReply, uint16_t cmds = 1);
+    uint8_t             linkProbe(uint32_t rate);
     uint8_t             writeBuf(uint8_t expReply = 0, 
                                  uint16_t wait = NXT_REPLY_WAIT,
                                  uint16_t size = 0
@@ -338,6 +820,9 @@ public:
      * Please note : all functions return a readCode_t value, that must to be
      * checked by user, at least if you want to know if command is succesful or not.
     */
+#ifdef NXT_SERIAL_TYPE
+    NxtLcd(NXT_SERIAL_TYPE* port);
+#else
 #ifdef NXT_HAVE_HS    
     NxtLcd(HardwareSerial* port);
 #endif
@@ -350,8 +835,14 @@ public:
 #ifdef NXT_HAVE_SS        
     NxtLcd(SoftwareSerial* port);
 #endif
+#ifdef NXT_STREAM_SERIAL
+    NxtLcd(Stream* port);
+#endif
+#endif //NXT_SERIAL_TYPE
     
-    uint8_t     init(uint32_t baudrate = 9600, uint8_t dispType = 1, uint8_t reset = 1, uint8_t dbg = 1);
+    uint8_t     init(uint32_t baudrate = 9600, uint8_t dispType = 1, uint8_t reset = 1, uint8_t dbg = 1,
+                     uint8_t propMode = nxt_propEager);
+    uint8_t     getInitTimes(uint16_t* resetMs, uint16_t* propMs);
 
     uint8_t     devReset(void);
     
@@ -447,7 +938,7 @@ public:
     
     uint8_t     addWavePoint(uint8_t waveId,uint8_t ch, uint8_t value);
     
-    uint8_t     addWaveBytes(uint8_t waveId,uint8_t ch, uint8_t* bytes, uint16_t len);
+    uint8_t     addWaveBytes(uint8_t waveId,uint8_t ch, const uint8_t* bytes, uint16_t len);
     
     uint8_t     clearWaveCh(uint8_t waveId, uint8_t ch = 255);
     
@@ -473,9 +964,11 @@ public:
     
     uint8_t     getWrongId(void){return wrongIdCode;};
     
+#if !defined(NXT_DISP_TYPE) || NXT_DISP_TYPE > 0
     uint8_t     setDate(uint8_t day,uint8_t month,uint16_t year);
     
     uint8_t     setTime(uint8_t hour,uint8_t minute,uint8_t second=0);
+#endif
     
     uint8_t     getPage(uint8_t* page);
     
@@ -485,6 +978,96 @@ public:
 
     uint8_t     ckEvents(nxtEvent_t* lastEvt);
     
+    uint8_t     poll(void);
+    
+    uint8_t     rxPush(uint8_t b);
+    uint16_t    getRxDropped(void){return rxDropped;};
+    uint16_t    getEvDropped(void){return evDropped;};
+    
+    uint8_t     setHandlers(nxtHandler_t* table, uint8_t size, uint8_t filter = 1);
+    uint8_t     onTouch(uint8_t page, uint8_t comp, uint8_t mask, nxtEvHandler_t fn, void* ctx = NULL);
+    uint8_t     onEvent(uint8_t evCode, nxtEvHandler_t fn, void* ctx = NULL);
+    uint8_t     dispatch(void);
+    uint16_t    getEvFiltered(void){return evFiltered;};
+    
+    uint8_t     setXYMode(uint8_t mode, nxtPoint_t* buf = NULL, uint16_t size = 0);
+    nxtPoint_t* getStroke(void){return strokeBuf;};
+    uint16_t    getStrokeLen(void){return strokeLen;};
+    void        strokeClear(void){strokeLen = 0;strokeDrawn = 0;strokeGen++;};
+    void        setStrokeMinDist(uint8_t dist){strokeMinDist = dist;};
+    uint8_t     drawStroke(uint16_t color);
+    uint16_t    getXYMerged(void){return xyMerged;};
+    uint16_t    getStrokeLost(void){return strokeLost;};
+    
+    uint8_t     setTxBuf(uint8_t* buf, uint16_t size);
+    uint16_t    getTxPending(void){return serial.txPending();};
+    uint8_t     setFlowControl(uint8_t en);
+    uint8_t     getFlowStats(uint16_t* used, uint16_t* overflows);
+    
+    uint8_t     setBaud(uint32_t rate, uint8_t persist = 0);
+    uint8_t     findBaud(uint32_t* rate);
+    uint32_t    getBaud(void){return baud;};
+    
+    uint8_t     setPipeline(uint8_t en);
+    uint8_t     pipeFlush(uint16_t wait = NXT_REPLY_WAIT);
+    uint8_t     getPipeErr(uint16_t* seq);
+    uint16_t    getCmdSeq(void){return cmdSeq;};
+    uint8_t     getPipeCnt(void){return pipeCnt;};
+    
+    uint8_t     setShadow(nxtShadow_t* table, uint8_t size);
+    void        shadowClear(void);
+    uint8_t     getShadowStats(uint32_t* hits, uint32_t* misses);
+    
+    uint8_t     setJournal(uint8_t* pool, uint16_t size);
+    void        journalClear(void);
+    uint8_t     replayJournal(void);
+    uint8_t     getJournalStats(uint16_t* used, uint16_t* replays);
+    
+    uint8_t     setFrameBuf(uint8_t* buf, uint16_t size);
+    uint8_t     beginFrame(uint8_t refStop = 0);
+    uint8_t     commitFrame(void);
+    
+    uint8_t     getNumericAsync(const char* page, const char* field, void* value, uint8_t size,
+                                uint8_t* handle, nxtReqCb_t cb = NULL, void* ctx = NULL);
+    uint8_t     getNumericAsync(uint8_t page, uint8_t field, void* value, uint8_t size,
+                                uint8_t* handle, nxtReqCb_t cb = NULL, void* ctx = NULL);
+    uint8_t     getNumericAsync(const char* field, void* value, uint8_t size,
+                                uint8_t* handle, nxtReqCb_t cb = NULL, void* ctx = NULL);
+    uint8_t     getNumericAsync(uint8_t field, void* value, uint8_t size,
+                                uint8_t* handle, nxtReqCb_t cb = NULL, void* ctx = NULL);
+    uint8_t     getStringAsync(const char* page, const char* field, char* value, uint16_t size,
+                               uint8_t* handle, nxtReqCb_t cb = NULL, void* ctx = NULL);
+    uint8_t     getStringAsync(uint8_t page, uint8_t field, char* value, uint16_t size,
+                               uint8_t* handle, nxtReqCb_t cb = NULL, void* ctx = NULL);
+    uint8_t     getStringAsync(const char* field, char* value, uint16_t size,
+                               uint8_t* handle, nxtReqCb_t cb = NULL, void* ctx = NULL);
+    uint8_t     getStringAsync(uint8_t field, char* value, uint16_t size,
+                               uint8_t* handle, nxtReqCb_t cb = NULL, void* ctx = NULL);
+    uint8_t     getObjAttrAsync(const char* page, const char* obj, const char* attr, uint16_t* value,
+                                uint8_t* handle, nxtReqCb_t cb = NULL, void* ctx = NULL);
+    uint8_t     getObjAttrAsync(uint8_t page, uint8_t obj, const char* attr, uint16_t* value,
+                                uint8_t* handle, nxtReqCb_t cb = NULL, void* ctx = NULL);
+    uint8_t     getObjAttrAsync(const char* obj, const char* attr, uint16_t* value,
+                                uint8_t* handle, nxtReqCb_t cb = NULL, void* ctx = NULL);
+    uint8_t     getObjAttrAsync(uint8_t obj, const char* attr, uint16_t* value,
+                                uint8_t* handle, nxtReqCb_t cb = NULL, void* ctx = NULL);
+    uint8_t     getPropertyAsync(const char* prop, uint16_t* value,
+                                 uint8_t* handle, nxtReqCb_t cb = NULL, void* ctx = NULL);
+    uint8_t     getPropertyAsync(uint8_t prop, uint16_t* value,
+                                 uint8_t* handle, nxtReqCb_t cb = NULL, void* ctx = NULL);
+    uint8_t     setReqSlots(nxtReq_t* table, uint8_t size);
+    uint8_t     reqStatus(uint8_t handle);
+    uint8_t     reqFlush(uint16_t wait = NXT_REQ_WAIT);
+    uint8_t     getReqCnt(void){return reqCnt;};
+    
+    uint8_t     setResolver(nxtName_t* table, uint8_t size, nxtNameLearn_t* learn);
+    uint8_t     addPageId(const char* page, uint8_t id);
+    uint32_t    getNameSaved(void){return nameSaved;};
+    
+    uint8_t     setSnapshot(nxtSnapIo_t io, void* ctx = NULL, uint8_t checkProp = nxt_sys2);
+    uint8_t     saveSnapshot(uint8_t force = 0);
+    uint8_t     getWarmBoot(void){return warmBoot;};
+    
    
     
     
@@ -561,4 +1144,144 @@ public:
     
 };
 
+
+/*
+ * Component handles - bound to a display and a component, they encode the component
+ * address once, at construction, so updates just append the value. See handles.cpp
+ * The address can be given as page and object ids (encoded in RAM, es. "p[0].b[3]"),
+ * or as a name string, that is not copied: use the F() macro to keep it in program
+ * memory, es. NxtNumber speed(lcd,F("main.n0"));
+*/
+#define NXT_HANDLE_ADDR           14  //size of "p[255].b[255]"
+
+class NxtHandle{
+protected:
+    NxtLcd*         lcd;
+    uint8_t         mode;
+    union {
+        char        buf[NXT_HANDLE_ADDR];
+        const char* name;
+    } addr;
+    
+    void            cmdAddr(void);
+    uint8_t         setVal(const char* attr, int32_t value);
+    uint8_t         setTxt(const char* value);
+#ifdef ARDUINO_ARCH_AVR
+    uint8_t         setTxt(const __FlashStringHelper* value);
+#endif
+    
+public:
+    NxtHandle(NxtLcd& l, uint8_t page, uint8_t obj);
+    NxtHandle(NxtLcd& l, uint8_t obj);
+    NxtHandle(NxtLcd& l, const char* name);
+    NxtHandle(NxtLcd& l, const __FlashStringHelper* name);
+    
+    uint8_t         setAttr(const char* attr, uint16_t value);
+    uint8_t         setBackColor(uint16_t color);
+    uint8_t         setForeColor(uint16_t color);
+};
+
+class NxtNumber : public NxtHandle{
+public:
+    using NxtHandle::NxtHandle;
+    uint8_t         set(int32_t value);
+};
+
+class NxtText : public NxtHandle{
+public:
+    using NxtHandle::NxtHandle;
+    uint8_t         set(const char* value);
+#ifdef ARDUINO_ARCH_AVR
+    uint8_t         set(const __FlashStringHelper* value);
+#endif
+};
+
+class NxtGauge : public NxtHandle{
+public:
+    using NxtHandle::NxtHandle;
+    uint8_t         set(uint16_t angle);
+};
+
+class NxtWave{
+private:
+    NxtLcd*         lcd;
+    uint8_t         waveId;
+    uint8_t         ch;
+    char            prefix[14];         //"add 255,255,"
+    
+public:
+    NxtWave(NxtLcd& l, uint8_t id, uint8_t channel);
+    uint8_t         add(uint8_t value);
+    uint8_t         addBytes(const uint8_t* bytes, uint16_t len){return lcd->addWaveBytes(waveId,ch,bytes,len);};
+    uint8_t         clear(void){return lcd->clearWaveCh(waveId,ch);};
+};
+
+
+/*
+ * NxtWaveDec - reduce a raw sample stream to one (average) or two (min and max) points
+ * for each group of samples, scaled on the wave object, see wave_dec.cpp
+*/
+#define NXT_DEC_AVG               0
+#define NXT_DEC_MINMAX            1
+
+class NxtWaveDec{
+private:
+    NxtLcd*         lcd;
+    uint8_t         waveId;
+    uint8_t         ch;
+    uint8_t*        outBuf;
+    uint16_t        outSize;
+    uint16_t        outLen = 0;
+    uint8_t         mode = NXT_DEC_AVG;
+    uint8_t         flip = 0;
+    uint16_t        ratio = 1;
+    uint16_t        winCnt = 0;
+    uint32_t        winMin = 0xFFFFFFFFUL;
+    uint32_t        winMax = 0;
+    uint32_t        winSum = 0;
+    int16_t         iLo = 0;
+    int16_t         iHi = 255;
+    int32_t         iK = 0;
+    float           fLo = 0;
+    float           fHi = 255;
+    float           fK = 0;
+    uint32_t        samples = 0;
+    
+    uint8_t         emit(void);
+    
+public:
+    NxtWaveDec(NxtLcd& l, uint8_t id, uint8_t channel, uint8_t* buf, uint16_t size);
+    uint8_t         setScale(float lo, float hi, uint16_t height, uint16_t dis = 100);
+    uint8_t         setDecimation(uint16_t samples, uint8_t decMode = NXT_DEC_AVG);
+    uint8_t         add(const int16_t* s, uint16_t n);
+    uint8_t         add(const float* s, uint16_t n);
+    uint8_t         flush(void);
+    uint8_t         clear(void);
+    uint32_t        getSamples(void){return samples;};
+};
+
+
+/*
+ * NxtMulti - drive several displays (each one with its own NxtLcd instance and serial port)
+ * from one controller, polling them in round robin. See multi.cpp
+*/
+class NxtMulti{
+private:
+    NxtLcd*             lcds[NXT_MULTI_MAX];
+    uint8_t             lcdCnt = 0;
+    uint8_t             next = 0;
+public:
+    uint8_t     add(NxtLcd* lcd);
+    
+    uint8_t     count(void){return lcdCnt;};
+    
+    NxtLcd*     operator[](uint8_t ndx){return (ndx < lcdCnt) ? lcds[ndx] : NULL;};
+    
+    uint8_t     poll(void);
+    
+    uint8_t     setPipeline(uint8_t en);
+    
+    uint8_t     flush(uint16_t wait = NXT_REPLY_WAIT);
+};
+
 #endif // __NXT_LCD_H__
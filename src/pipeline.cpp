@@ -0,0 +1,166 @@
+/* pipeline.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the following class methods:
+ *
+ * public :
+ * - setPipeline()
+ * - pipeFlush()
+ * - getPipeErr()
+ *
+ * private:
+ * - pipeWrite()
+ * - pipeService()
+ * - pipeAck()
+ *
+ * In pipeline mode the commands that don't expect data back (all the set*, draw*, etc.)
+ * are sent back-to-back without waiting for the display answer. Up to NXT_PIPE_DEPTH
+ * commands can be "in flight"; the display, with bkcmd=3, answer each of them with
+ * exactly one code (0x01 on success, 0x00/0x02../0x1A on failure) in the same order,
+ * so replies are matched to commands in FIFO order. A missing reply would shift all the
+ * next ones, so after a timeout the matching stop until the line is quiet again.
+ * Every command sent get a sequence number (see getCmdSeq()), errors are recorded with
+ * the sequence number of the command that caused them and can be read with getPipeErr().
+ *
+*/
+
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+
+/*
+ * setPipeline() - enable (en=1) or disable (en=0) the pipeline mode. Enabling it set
+ * bkcmd to 3 (always reply), disabling wait for all pending replies and restore the
+ * previous bkcmd value.
+ */
+uint8_t NxtLcd::setPipeline(uint8_t en){
+    if(initialized == 0) return notInit;
+    if(en > 1) return invalidData;
+    if(en == pipeEn) return replyCmdOk;
+    uint8_t res;
+    if(en == 1){
+        uint16_t bkcmd;
+        res = getProperty(nxt_bkcmd,&bkcmd,1);
+        if(res != replyCmdOk) return res;
+        pipeBkcmd = bkcmd;
+        res = setBkcmd(3);
+        if(res == replyCmdOk && debug == 0) res = waitFor(replyCmdOk,NXT_REPLY_WAIT); // its own ack
+        if(res != replyCmdOk) return res;
+        pipeErr = replyCmdOk;
+        pipeEn = 1;
+    }
+    else{
+        pipeFlush();
+        pipeEn = 0;
+        res = setBkcmd(pipeBkcmd);
+    }
+    return res;
+}
+
+
+/*
+ * pipeFlush() - wait for the replies of all the commands in flight. "wait" is the max
+ * time (ms) to wait for each reply; if one does not arrive in time, it and all the
+ * commands still in flight are recorded as noReply errors, and the late replies are
+ * discarded (see rxResync()).
+ * Return replyCmdOk if all the commands sent since last getPipeErr() succeeded, the
+ * first error code otherwise.
+ */
+uint8_t NxtLcd::pipeFlush(uint16_t wait){
+    if(initialized == 0) return notInit;
+    while(pipeCnt > 0){
+        if(pipeService(wait) == 0) rxResync();
+    }
+    return pipeErr;
+}
+
+
+/*
+ * getPipeErr() - return the first error recorded in pipeline mode, and the sequence
+ * number of the command that caused it in "seq". getWrongId() will return the code
+ * related to that command. Error is cleared after reading.
+ */
+uint8_t NxtLcd::getPipeErr(uint16_t* seq){
+    uint8_t res = pipeErr;
+    if(res != replyCmdOk){
+        (*seq) = pipeErrSeq;
+        wrongIdCode = pipeErrId;
+    }
+    pipeErr = replyCmdOk;
+    return res;
+}
+
+
+/*
+ * pipeWrite() - send the command in sendBuf and queue it in the in flight list.
+ * If the list is full, we wait for the oldest reply, so there is always room
+ * for the next command.
+ */
+uint8_t NxtLcd::pipeWrite(void){
+    if(cmdOvfl > 0) return dataTooBig;
+    if(sendLen == 0) return invalidData;
+    if(serial.write((unsigned char *)sendBuf,sendLen) != sendLen) return replyCmdFail;
+    cmdSeq++;
+    flowMark(1);
+    pipeSeq[(pipeHead + pipeCnt) % NXT_PIPE_DEPTH] = cmdSeq;
+    pipeCnt++;
+    if(pipeCnt == NXT_PIPE_DEPTH){
+        if(pipeService(NXT_REPLY_WAIT) == 0) rxResync();
+    }
+    return replyCmdOk;
+}
+
+
+/*
+ * pipeService() - read incoming telegrams until a reply to an in flight command
+ * is found, or "wait" ms are elapsed. Events found meanwhile are handled as usual.
+ * Replies are read in recvBuf, so sendBuf is left untouched.
+ * Return the number of replies consumed (0 or 1)
+ */
+uint8_t NxtLcd::pipeService(uint16_t wait){
+    serial.flushTx();
+    uint32_t start = millis();
+    uint8_t cnt = pipeCnt;
+    while(pipeCnt == cnt && cnt > 0){
+        readEvent();
+        if((uint32_t)(millis() - start) >= wait) break;
+    }
+    return cnt - pipeCnt;
+}
+
+
+/*
+ * pipeAck() - match reply "res" to the oldest command in flight, or to the next
+ * command of a frame just committed (see frame.cpp).
+ * Only the first error is kept, see getPipeErr().
+ */
+void NxtLcd::pipeAck(uint8_t res){
+    uint16_t seq;
+    if(pipeCnt > 0){
+        seq = pipeSeq[pipeHead];
+        pipeHead = (pipeHead + 1) % NXT_PIPE_DEPTH;
+        pipeCnt--;
+    }
+    else if(frameAcks > 0){
+        seq = frameSeq++;
+        frameAcks--;
+    }
+    else return;
+    // the shadow cache took the value as written when it was queued
+    if(res != replyCmdOk) shadowClear();
+    if(res != replyCmdOk && pipeErr == replyCmdOk){
+        pipeErr = res;
+        pipeErrSeq = seq;
+        pipeErrId = wrongIdCode;
+    }
+}
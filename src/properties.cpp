@@ -25,6 +25,9 @@
  * - setDate()
  * - setTime()
  * 
+ * Private:
+ * - propStore()
+ * 
  * All this functions deal with display system variables, see sysPropNames and 
  * sysPropNdx_t in nxt_lcd.h for the usable properties. Complete list can be found
  * at https://nextion.tech/instruction-set/#s6
@@ -157,6 +160,7 @@ uint8_t NxtLcd::setWakeUpPage(uint8_t page){
 }
 
 
+#if !defined(NXT_DISP_TYPE) || NXT_DISP_TYPE > 0
 /*
  * setDate() - set the internal RTC date.
  * "day" is the day of the month, range 0/31
@@ -220,6 +224,7 @@ uint8_t NxtLcd::setTime(uint8_t hour,uint8_t minute,uint8_t second){
     sysProp[nxt_rtc5] = second;
     return replyCmdOk;
 }
+#endif
 
 
 
@@ -237,15 +242,15 @@ uint8_t NxtLcd::setProperty(const char* prop, uint16_t value){
     uint8_t propNdx = chkProperty(prop);
     if(propNdx == 255) return invalidData;
     uint8_t res;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s=%u%c%c%c"),prop,value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s=%u%c%c%c",prop,value,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStr(prop);
+    cmdChar('=');
+    cmdUint(value);
+    cmdEnd();
+    if(propNdx == nxt_dp) shadowClear();
     res = writeBuf();
     if(res == replyCmdOk){
-        sysProp[propNdx] = value;
+        propStore(propNdx,value);
         return res;
     }
     return replyCmdFail;
@@ -256,15 +261,15 @@ uint8_t NxtLcd::setProperty(uint8_t prop, uint16_t value){
     uint8_t propNdx = chkProperty(prop);
     if(propNdx == 255) return invalidData;
     uint8_t res;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s=%u%c%c%c"),sysPropNames[propNdx],value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s=%u%c%c%c",sysPropNames[propNdx],value,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(sysPropNames[propNdx]);
+    cmdChar('=');
+    cmdUint(value);
+    cmdEnd();
+    if(propNdx == nxt_dp) shadowClear();
     res = writeBuf();
     if(res == replyCmdOk){
-        sysProp[propNdx] = value;
+        propStore(propNdx,value);
         return res;
     }
     return replyCmdFail;
@@ -276,6 +281,8 @@ uint8_t NxtLcd::setProperty(uint8_t prop, uint16_t value){
 /*
  * getProperty() - get the display system variable indicate in "prop" to "value"
  * "prop" can be a char* or an int, check sysPropNames array and sysPropNdx_t enum in nxt_lcd.h
+ * With loc=1 the local copy is returned, if the property was already read or set, otherwise
+ * the display is asked (es. after init() with nxt_propLazy)
  * Complete list of properties that can be setted can be found here :
  *  - https://nextion.tech/instruction-set/#s6
  * 
@@ -284,20 +291,18 @@ uint8_t NxtLcd::getProperty(const char* prop, uint16_t* value, uint8_t loc){
     if(initialized == 0) return notInit;
     uint8_t propNdx = chkProperty(prop);
     if(propNdx == 255) return invalidData;
-    if(loc > 0){
+    if(loc > 0 && (propValid & NXT_PROP_BIT(propNdx))){
         (*value) = sysProp[propNdx];
         return replyCmdOk;
     }
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get %s%c%c%c"),prop,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"get %s%c%c%c",prop,NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdStr(prop);
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         memcpy(value,&recvBuf[1],2);
-        sysProp[propNdx] = (*value);
+        propStore(propNdx,*value);
     }
     return ret;
 }
@@ -307,22 +312,33 @@ uint8_t NxtLcd::getProperty(uint8_t prop, uint16_t* value, uint8_t loc){
     if(initialized == 0) return notInit;
     uint8_t propNdx = chkProperty(prop);
     if(propNdx == 255) return invalidData;
-    if(loc > 0){
+    if(loc > 0 && (propValid & NXT_PROP_BIT(propNdx))){
         (*value) = sysProp[propNdx];
         return replyCmdOk;
     }
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("get %S%c%c%c"),sysPropNames[propNdx],NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"get %s%c%c%c",sysPropNames[propNdx],NXT_MSG_END);
-#endif    
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    cmdStrP(sysPropNames[propNdx]);
+    cmdEnd();
     uint8_t ret = writeBuf(replyGetNum);//readBuf();
     if(ret == replyCmdOk ){
         memcpy(value,&recvBuf[1],2);
-        sysProp[propNdx] = (*value);
+        propStore(propNdx,*value);
     }
     return ret;
 }
 
 
+/*
+ * propStore() - update the local copy of property "propNdx", marking the snapshot
+ * as changed (see snapshot.cpp). The page is set, read or reported by the display, so
+ * it's the current one (pageSure, see resolver.cpp).
+ */
+void NxtLcd::propStore(uint8_t propNdx, uint16_t value){
+    if((propValid & NXT_PROP_BIT(propNdx)) == 0 || sysProp[propNdx] != value){
+        if(propNdx != snapCheck) snapDirty = 1;
+    }
+    sysProp[propNdx] = value;
+    propValid |= NXT_PROP_BIT(propNdx);
+    if(propNdx == nxt_dp) pageSure = 1;
+}
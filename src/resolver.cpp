@@ -0,0 +1,211 @@
+/* resolver.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the following class methods:
+ *
+ * public :
+ * - setResolver()
+ * - addPageId()
+ *
+ * private:
+ * - nameFind()
+ * - nameStore()
+ * - nameUse()
+ * - nameLearn()
+ *
+ * The resolver learn the page and component ids of the names used by the functions
+ * accepting <page_name>,<object_name> or <object_name>, and then send the shorter id form
+ * instead, es. "mainPage.temperatureBox.val=25" become "p[0].b[5].val=25" (30 -> 17 bytes,
+ * about 13 ms less at 9600 baud; extras/bench/bench_resolver.cpp measure it with the
+ * emulator). getNameSaved() return the bytes saved so far.
+ * - component ids are asked to the display ("get <name>.id") once, by poll() after the
+ *   first use of a name (when no reply is awaited); the command using it is sent with
+ *   the name form. A name the display does not know is remembered too, and not asked
+ *   again. Names longer than NXT_NAME_MAX are not resolved.
+ * - page ids are learned by setPageS(), or can be given with addPageId(); until a page
+ *   id is known, <page_name>,<object_name> addresses are sent as they are.
+ * - <object_name> addresses are relative to the current page, and "b[<id>]" would write
+ *   silently to another component on a different page, while the name fail. So they are
+ *   resolved only while the page known by the class is sure to be the current one: set
+ *   by setPage*(), read by getPage() or reported by sendme (es. in the page init events),
+ *   with no touch or sleep event since. Pages changed by the display alone (es. by a
+ *   timer) are not seen: on such HMIs use <page_name>.<object_name>, that resolve to
+ *   "p[<page_id>].b[<id>]" and stay right on any page.
+ * Names in program memory (F() macro) are resolved as well, once copied in sendBuf.
+ *
+ * nxtName_t names[24];
+ * nxtNameLearn_t learn;
+ * lcd.setResolver(names,24,&learn);
+ *
+*/
+
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+
+#define NXT_NAME_PAGE       0xFF    //id of the entries holding a page name
+#define NXT_NAME_GLOBAL     0xFE    //"page" used to key <page_name>.<object_name> entries
+#define NXT_NAME_NONE       0xFF    //id of the names unknown to the display
+
+
+/*
+ * nxtNameKey() - key of a name: its hash, mixed with the page it belongs to, or with
+ * one of the markers above
+ */
+static uint32_t nxtNameKey(const uint8_t* name, uint16_t len, uint8_t page){
+    uint32_t h = nxtHash(name,len);
+    h ^= page;
+    h *= 16777619UL;
+    return (h == 0) ? 1 : h;   // 0 mark an empty entry
+}
+
+
+/*
+ * nxtDigits() - number of decimal digits of "v"
+ */
+static uint8_t nxtDigits(uint8_t v){
+    if(v >= 100) return 3;
+    if(v >= 10) return 2;
+    return 1;
+}
+
+
+/*
+ * setResolver() - enable the name resolver, using the "table" array of "size" entries
+ * provided by user, one for each page and each component name used, and "learn" to
+ * hold the name whose id is still to be asked. When the table is full the oldest
+ * entries are replaced. Pass NULL to disable it.
+ */
+uint8_t NxtLcd::setResolver(nxtName_t* table, uint8_t size, nxtNameLearn_t* learn){
+    if(table != NULL && (size == 0 || learn == NULL)) return invalidData;
+    nameTbl = table;
+    nameSize = (table != NULL) ? size : 0;
+    nameNext = 0;
+    nameNew = (table != NULL) ? learn : NULL;
+    nameSaved = 0;
+    if(table != NULL){
+        memset(table,0,size * sizeof(nxtName_t));
+        learn->len = 0;
+    }
+    return replyCmdOk;
+}
+
+
+/*
+ * addPageId() - tell the resolver the id of page "page"
+ */
+uint8_t NxtLcd::addPageId(const char* page, uint8_t id){
+    if(nameTbl == NULL) return notSupported;
+    nameStore(nxtNameKey((const uint8_t *)page,strlen(page),NXT_NAME_PAGE),id,NXT_NAME_PAGE);
+    return replyCmdOk;
+}
+
+
+/*
+ * nameFind() - return the entry with key "key", NULL if not found
+ */
+nxtName_t* NxtLcd::nameFind(uint32_t key){
+    for(uint8_t i = 0; i < nameSize; i++){
+        if(nameTbl[i].key == key) return &nameTbl[i];
+    }
+    return NULL;
+}
+
+
+/*
+ * nameStore() - add (or update) an entry
+ */
+void NxtLcd::nameStore(uint32_t key, uint8_t page, uint8_t id){
+    nxtName_t* entry = nameFind(key);
+    if(entry == NULL){
+        entry = &nameTbl[nameNext];
+        nameNext = (nameNext + 1) % nameSize;
+    }
+    entry->key = key;
+    entry->page = page;
+    entry->id = id;
+}
+
+
+/*
+ * nameUse() - called by cmdObj() after a name address was added to sendBuf from
+ * "start"; "dot" is the position of the '.' in <page_name>.<object_name>, or "start"
+ * for <object_name>. If the ids are known the address is replaced by the id form
+ * (when shorter), otherwise the name is copied to be learned by nameLearn().
+ */
+void NxtLcd::nameUse(uint16_t start, uint16_t dot){
+    uint16_t len = sendLen - start;
+    uint8_t page;
+    uint32_t key;
+    if(dot > start){
+        nxtName_t* pg = nameFind(nxtNameKey(&sendBuf[start],dot - start,NXT_NAME_PAGE));
+        if(pg == NULL) return;
+        page = pg->page;
+        key = nxtNameKey(&sendBuf[start],len,NXT_NAME_GLOBAL);
+    }
+    else{
+        if((propValid & NXT_PROP_BIT(nxt_dp)) == 0 || pageSure == 0) return;    // page not sure, keep the name
+        page = sysProp[nxt_dp];
+        key = nxtNameKey(&sendBuf[start],len,page);
+    }
+    nxtName_t* entry = nameFind(key);
+    if(entry == NULL){
+        if(nameNew->len == 0 && len <= NXT_NAME_MAX){
+            memcpy(nameNew->name,&sendBuf[start],len);
+            nameNew->len = len;
+            nameNew->key = key;
+            nameNew->page = page;
+            nameNew->rel = (dot == start);
+        }
+        return;
+    }
+    if(entry->id == NXT_NAME_NONE) return;
+    uint16_t idLen = 3 + nxtDigits(entry->id);
+    if(dot > start) idLen += 4 + nxtDigits(entry->page);
+    if(idLen >= len) return;
+    cmdKeyHash = nxtHash(&sendBuf[start],len,cmdKey(start));     // the shadow cache key the name form
+    sendLen = start;
+    if(dot > start) cmdObj(entry->page,entry->id);
+    else cmdObj(entry->id);
+    cmdKeyEnd = sendLen;
+    nameSaved += len - idLen;
+}
+
+
+/*
+ * nameLearn() - called by poll(), ask the display the id of the name copied by
+ * nameUse(). Nothing is done while replies are awaited (frame, pipeline, async
+ * requests), so the get reply can't be taken for another one. If the display does
+ * not know the name it's stored as such; on no reply it will be asked again on its
+ * next use.
+ */
+void NxtLcd::nameLearn(void){
+    if(nameNew == NULL || nameNew->len == 0) return;
+    if(frameEn > 0 || frameLen > 0 || frameAcks > 0 || pipeCnt > 0 || reqCnt > 0 || rxSkip > 0) return;
+    uint8_t len = nameNew->len;
+    uint8_t rel = nameNew->rel;
+    uint8_t page = nameNew->page;
+    uint32_t key = nameNew->key;
+    nameNew->len = 0;
+    if(rel && (pageSure == 0 || sysProp[nxt_dp] != page)) return;    // page changed since its use
+    cmdStart();
+    cmdStrP(NXT_P("get "));
+    memcpy(&sendBuf[sendLen],nameNew->name,len);
+    sendLen += len;
+    cmdStrP(NXT_P(".id"));
+    cmdEnd();
+    uint8_t res = writeBuf(replyGetNum);
+    if(rel && pageSure == 0) return;      // a touch parsed meanwhile, the reply may be of another page
+    if(res == replyCmdOk) nameStore(key,page,recvBuf[1]);
+    else if(res != noReply) nameStore(key,page,NXT_NAME_NONE);
+}
@@ -57,50 +57,50 @@
 uint8_t NxtLcd::setString(const char* page,const char* field,const char* value){
     if(initialized == 0) return notInit;
     if(strlen(page)+strlen(field)+strlen(value)+11 > NXT_BUF_SIZE) return dataTooBig;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s.%s.txt=\"%s\"%c%c%c"),page,field,value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s.%s.txt=\"%s\"%c%c%c",page,field,value,NXT_MSG_END);
-#endif
-    return writeBuf();
+    cmdStart();
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".txt=\""));
+    cmdStr(value);
+    cmdChar('"');
+    cmdEnd();
+    return writeCached();
 }
 
 
 uint8_t NxtLcd::setString(uint8_t page,uint8_t field,const char* value){
     if(initialized == 0) return notInit;
     if(strlen(value)+21 > NXT_BUF_SIZE) return dataTooBig;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("p[%u].b[%u].txt=\"%s\"%c%c%c"),page,field,value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"p[%u].b[%u].txt=\"%s\"%c%c%c",page,field,value,NXT_MSG_END);
-#endif    
-    return writeBuf();
+    cmdStart();
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".txt=\""));
+    cmdStr(value);
+    cmdChar('"');
+    cmdEnd();
+    return writeCached();
 }
 
 uint8_t NxtLcd::setString(const char* field,const char* value){
     if(initialized == 0) return notInit;
     if(strlen(field)+strlen(value)+10 > NXT_BUF_SIZE) return dataTooBig;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s.txt=\"%s\"%c%c%c"),field,value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s.txt=\"%s\"%c%c%c",field,value,NXT_MSG_END);
-#endif
-    return writeBuf();
+    cmdStart();
+    cmdObj(field);
+    cmdStrP(NXT_P(".txt=\""));
+    cmdStr(value);
+    cmdChar('"');
+    cmdEnd();
+    return writeCached();
 }
 
 uint8_t NxtLcd::setString(uint8_t field,const char* value){
     if(initialized == 0) return notInit;
     if(strlen(value)+15 > NXT_BUF_SIZE) return dataTooBig;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("b[%u].txt=\"%s\"%c%c%c"),field,value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"b[%u].txt=\"%s\"%c%c%c",field,value,NXT_MSG_END);
-#endif    
-    return writeBuf();    
+    cmdStart();
+    cmdObj(field);
+    cmdStrP(NXT_P(".txt=\""));
+    cmdStr(value);
+    cmdChar('"');
+    cmdEnd();
+    return writeCached();    
 }
 
 
@@ -120,48 +120,44 @@ uint8_t NxtLcd::setString(uint8_t field,const char* value){
  */
 uint8_t NxtLcd::setNumeric(const char* page,const char* field,long value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s.%s.val=%lu%c%c%c"),page,field,value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s.%s.val=%lu%c%c%c",page,field,value,NXT_MSG_END);
-#endif    
-    return writeBuf();
+    cmdStart();
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".val="));
+    cmdInt(value);
+    cmdEnd();
+    return writeCached();
 }
 
 
 uint8_t NxtLcd::setNumeric(uint8_t page,uint8_t field,long value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("p[%u].b[%u].val=%lu%c%c%c"),page,field,value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"p[%u].b[%u].val=%lu%c%c%c",page,field,value,NXT_MSG_END);
-#endif    
-    return writeBuf();
+    cmdStart();
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".val="));
+    cmdInt(value);
+    cmdEnd();
+    return writeCached();
 }
 
 uint8_t NxtLcd::setNumeric(const char* field,long value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s.val=%lu%c%c%c"),field,value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s.val=%lu%c%c%c",field,value,NXT_MSG_END);
-#endif    
-    return writeBuf();
+    cmdStart();
+    cmdObj(field);
+    cmdStrP(NXT_P(".val="));
+    cmdInt(value);
+    cmdEnd();
+    return writeCached();
 }
 
 
 uint8_t NxtLcd::setNumeric(uint8_t field,long value){
     if(initialized == 0) return notInit;
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("b[%u].val=%lu%c%c%c"),field,value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"b[%u].val=%lu%c%c%c",field,value,NXT_MSG_END);
-#endif    
-    return writeBuf();
+    cmdStart();
+    cmdObj(field);
+    cmdStrP(NXT_P(".val="));
+    cmdInt(value);
+    cmdEnd();
+    return writeCached();
 }
 
 
@@ -182,34 +178,29 @@ uint8_t NxtLcd::setFloat(const char* page, const char* field,
     if(initialized == 0) return notInit;
     uint8_t res = replyCmdFail;
     if(intSize > 0){
-        bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-        snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s.%s.vvs0=%u%c%c%c"),page,field,intSize,NXT_MSG_END);
-#else    
-        snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s.%s.vvs0=%u%c%c%c",page,field,intSize,NXT_MSG_END);
-#endif    
-        res = writeBuf();
+        cmdStart();
+        cmdObj(page,field);
+        cmdStrP(NXT_P(".vvs0="));
+        cmdUint(intSize);
+        cmdEnd();
+        res = writeCached();
         if(res != replyCmdOk) return res;
     }
     if(frctSize > 0){
-        bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-        snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s.%s.vvs1=%u%c%c%c"),page,field,frctSize,NXT_MSG_END);
-#else    
-        snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s.%s.vvs1=%u%c%c%c",page,field,frctSize,NXT_MSG_END);
-#endif    
-        res = writeBuf();
+        cmdStart();
+        cmdObj(page,field);
+        cmdStrP(NXT_P(".vvs1="));
+        cmdUint(frctSize);
+        cmdEnd();
+        res = writeCached();
         if(res != replyCmdOk) return res;//replyCmdFail;
     }
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s.%s.val=%ld%c%c%c"),page,field,
-             value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s.%s.val=%ld%c%c%c",page,field,
-             value,NXT_MSG_END);
-#endif    
-    res = writeBuf();
+    cmdStart();
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".val="));
+    cmdInt(value);
+    cmdEnd();
+    res = writeCached();
     if(res != replyCmdOk) return res;//replyCmdFail;    
     return replyCmdOk;
 }
@@ -220,34 +211,29 @@ uint8_t NxtLcd::setFloat(uint8_t page, uint8_t field,
     if(initialized == 0) return notInit;
     uint8_t res = replyCmdFail;
     if(intSize > 0){
-        bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-        snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("p[%u].b[%u].vvs0=%u%c%c%c"),page,field,intSize,NXT_MSG_END);
-#else    
-        snprintf((char *)sendBuf,NXT_BUF_SIZE,"p[%u].b[%u].vvs0=%u%c%c%c",page,field,intSize,NXT_MSG_END);
-#endif    
-        res = writeBuf();
+        cmdStart();
+        cmdObj(page,field);
+        cmdStrP(NXT_P(".vvs0="));
+        cmdUint(intSize);
+        cmdEnd();
+        res = writeCached();
         if(res != replyCmdOk) return res;//replyCmdFail;
     }
     if(frctSize > 0){
-        bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-        snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("p[%u].b[%u].vvs1=%u%c%c%c"),page,field,frctSize,NXT_MSG_END);
-#else    
-        snprintf((char *)sendBuf,NXT_BUF_SIZE,"p[%u].b[%u].vvs1=%u%c%c%c",page,field,frctSize,NXT_MSG_END);
-#endif    
-        res = writeBuf();
+        cmdStart();
+        cmdObj(page,field);
+        cmdStrP(NXT_P(".vvs1="));
+        cmdUint(frctSize);
+        cmdEnd();
+        res = writeCached();
         if(res != replyCmdOk) return res;//replyCmdFail;
     }
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("p[%u].b[%u].val=%ld%c%c%c"),page,field,
-             value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"p[%u].b[%u].val=%ld%c%c%c",page,field,
-             value,NXT_MSG_END);
-#endif    
-    res = writeBuf();
+    cmdStart();
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".val="));
+    cmdInt(value);
+    cmdEnd();
+    res = writeCached();
     if(res != replyCmdOk) return res;//replyCmdFail;    
     return replyCmdOk;
 }
@@ -257,34 +243,29 @@ uint8_t NxtLcd::setFloat(const char* field,
     if(initialized == 0) return notInit;
     uint8_t res = replyCmdFail;
     if(intSize > 0){
-        bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-        snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s.vvs0=%u%c%c%c"),field,intSize,NXT_MSG_END);
-#else    
-        snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s.vvs0=%u%c%c%c",field,intSize,NXT_MSG_END);
-#endif    
-        res = writeBuf();
+        cmdStart();
+        cmdObj(field);
+        cmdStrP(NXT_P(".vvs0="));
+        cmdUint(intSize);
+        cmdEnd();
+        res = writeCached();
         if(res != replyCmdOk) return res;//replyCmdFail;
     }
     if(frctSize > 0){
-        bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-        snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s.vvs1=%u%c%c%c"),field,frctSize,NXT_MSG_END);
-#else    
-        snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s.vvs1=%u%c%c%c",field,frctSize,NXT_MSG_END);
-#endif    
-        res = writeBuf();
+        cmdStart();
+        cmdObj(field);
+        cmdStrP(NXT_P(".vvs1="));
+        cmdUint(frctSize);
+        cmdEnd();
+        res = writeCached();
         if(res != replyCmdOk) return res;//replyCmdFail;
     }
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%s.val=%ld%c%c%c"),field,
-             value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"%s.val=%ld%c%c%c",field,
-             value,NXT_MSG_END);
-#endif    
-    res = writeBuf();
+    cmdStart();
+    cmdObj(field);
+    cmdStrP(NXT_P(".val="));
+    cmdInt(value);
+    cmdEnd();
+    res = writeCached();
     if(res != replyCmdOk) return res;//replyCmdFail;    
     return replyCmdOk;
 }
@@ -295,34 +276,29 @@ uint8_t NxtLcd::setFloat(uint8_t field,
     if(initialized == 0) return notInit;
     uint8_t res = replyCmdFail;
     if(intSize > 0){
-        bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-        snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("b[%u].vvs0=%u%c%c%c"),field,intSize,NXT_MSG_END);
-#else    
-        snprintf((char *)sendBuf,NXT_BUF_SIZE,"b[%u].vvs0=%u%c%c%c",field,intSize,NXT_MSG_END);
-#endif    
-        res = writeBuf();
+        cmdStart();
+        cmdObj(field);
+        cmdStrP(NXT_P(".vvs0="));
+        cmdUint(intSize);
+        cmdEnd();
+        res = writeCached();
         if(res != replyCmdOk) return res;//replyCmdFail;
     }
     if(frctSize > 0){
-        bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-        snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("b[%u].vvs1=%u%c%c%c"),field,frctSize,NXT_MSG_END);
-#else    
-        snprintf((char *)sendBuf,NXT_BUF_SIZE,"b[%u].vvs1=%u%c%c%c",field,frctSize,NXT_MSG_END);
-#endif    
-        res = writeBuf();
+        cmdStart();
+        cmdObj(field);
+        cmdStrP(NXT_P(".vvs1="));
+        cmdUint(frctSize);
+        cmdEnd();
+        res = writeCached();
         if(res != replyCmdOk) return res;//replyCmdFail;
     }
-    bufReset(sendBuf);
-#ifdef ARDUINO_ARCH_AVR
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("b[%u].val=%ld%c%c%c"),field,
-             value,NXT_MSG_END);
-#else    
-    snprintf((char *)sendBuf,NXT_BUF_SIZE,"b[%u].val=%ld%c%c%c",field,
-             value,NXT_MSG_END);
-#endif    
-    res = writeBuf();
+    cmdStart();
+    cmdObj(field);
+    cmdStrP(NXT_P(".val="));
+    cmdInt(value);
+    cmdEnd();
+    res = writeCached();
     if(res != replyCmdOk) return res;//replyCmdFail;    
     return replyCmdOk;
 }
@@ -335,50 +311,72 @@ uint8_t NxtLcd::setString(const __FlashStringHelper* page,
 {
     if(initialized == 0) return notInit;
     if(strlen_P((char *)page)+strlen_P((char *)field)+strlen_P((char *)value)+11 > NXT_BUF_SIZE) return dataTooBig;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%S.%S.txt=\"%S\"%c%c%c"),page,field,value,NXT_MSG_END);
-    return writeBuf();
+    cmdStart();
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".txt=\""));
+    cmdStr(value);
+    cmdChar('"');
+    cmdEnd();
+    return writeCached();
 }
 
 uint8_t NxtLcd::setString(uint8_t page,uint8_t field,const __FlashStringHelper* value){
     if(initialized == 0) return notInit;
     if(strlen_P((char *)value)+21 > NXT_BUF_SIZE) return dataTooBig;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("p[%u].b[%u].txt=\"%S\"%c%c%c"),page,field,value,NXT_MSG_END);
-    return writeBuf();
+    cmdStart();
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".txt=\""));
+    cmdStr(value);
+    cmdChar('"');
+    cmdEnd();
+    return writeCached();
 }
 
 uint8_t NxtLcd::setString(const __FlashStringHelper* field,const __FlashStringHelper* value)
 {
     if(initialized == 0) return notInit;
     if(strlen_P((char *)field)+strlen_P((char *)value)+10 > NXT_BUF_SIZE) return dataTooBig;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%S.txt=\"%S\"%c%c%c"),field,value,NXT_MSG_END);
-    return writeBuf();
+    cmdStart();
+    cmdObj(field);
+    cmdStrP(NXT_P(".txt=\""));
+    cmdStr(value);
+    cmdChar('"');
+    cmdEnd();
+    return writeCached();
 }
 
 uint8_t NxtLcd::setString(uint8_t field,const __FlashStringHelper* value){
     if(initialized == 0) return notInit;
     if(strlen_P((char *)value)+15 > NXT_BUF_SIZE) return dataTooBig;
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("b[%u].txt=\"%S\"%c%c%c"),field,value,NXT_MSG_END);
-    return writeBuf();
+    cmdStart();
+    cmdObj(field);
+    cmdStrP(NXT_P(".txt=\""));
+    cmdStr(value);
+    cmdChar('"');
+    cmdEnd();
+    return writeCached();
 }
 
 
 uint8_t NxtLcd::setNumeric(const __FlashStringHelper* page,
                          const __FlashStringHelper* field,long value)
 {
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%S.%S.val=%lu%c%c%c"),page,field,value,NXT_MSG_END);
-    return writeBuf();    
+    cmdStart();
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".val="));
+    cmdInt(value);
+    cmdEnd();
+    return writeCached();    
 }
 
 uint8_t NxtLcd::setNumeric(const __FlashStringHelper* field,long value)
 {
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%S.val=%lu%c%c%c"),field,value,NXT_MSG_END);
-    return writeBuf();    
+    cmdStart();
+    cmdObj(field);
+    cmdStrP(NXT_P(".val="));
+    cmdInt(value);
+    cmdEnd();
+    return writeCached();    
 }
 
 uint8_t NxtLcd::setFloat(const __FlashStringHelper* page, const __FlashStringHelper* field,
@@ -386,21 +384,29 @@ uint8_t NxtLcd::setFloat(const __FlashStringHelper* page, const __FlashStringHel
     if(initialized == 0) return notInit;
     uint8_t res = replyCmdFail;
     if(intSize > 0){
-        bufReset(sendBuf);
-        snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%S.%S.vvs0=%u%c%c%c"),page,field,intSize,NXT_MSG_END);
-        res = writeBuf();
+        cmdStart();
+        cmdObj(page,field);
+        cmdStrP(NXT_P(".vvs0="));
+        cmdUint(intSize);
+        cmdEnd();
+        res = writeCached();
         if(res != replyCmdOk) return res;//replyCmdFail;
     }
     if(frctSize > 0){
-        bufReset(sendBuf);
-        snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%S.%S.vvs1=%u%c%c%c"),page,field,frctSize,NXT_MSG_END);
-        res = writeBuf();
+        cmdStart();
+        cmdObj(page,field);
+        cmdStrP(NXT_P(".vvs1="));
+        cmdUint(frctSize);
+        cmdEnd();
+        res = writeCached();
         if(res != replyCmdOk) return res;//replyCmdFail;
     }
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%S.%S.val=%ld%c%c%c"),page,field,
-             value,NXT_MSG_END);
-    res = writeBuf();
+    cmdStart();
+    cmdObj(page,field);
+    cmdStrP(NXT_P(".val="));
+    cmdInt(value);
+    cmdEnd();
+    res = writeCached();
     if(res != replyCmdOk) return res;//replyCmdFail;    
     return replyCmdOk;
 }
@@ -411,21 +417,29 @@ uint8_t NxtLcd::setFloat(const __FlashStringHelper* field,
     if(initialized == 0) return notInit;
     uint8_t res = replyCmdFail;
     if(intSize > 0){
-        bufReset(sendBuf);
-        snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%S.vvs0=%u%c%c%c"),field,intSize,NXT_MSG_END);
-        res = writeBuf();
+        cmdStart();
+        cmdObj(field);
+        cmdStrP(NXT_P(".vvs0="));
+        cmdUint(intSize);
+        cmdEnd();
+        res = writeCached();
         if(res != replyCmdOk) return res;//replyCmdFail;
     }
     if(frctSize > 0){
-        bufReset(sendBuf);
-        snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%S.vvs1=%u%c%c%c"),field,frctSize,NXT_MSG_END);
-        res = writeBuf();
+        cmdStart();
+        cmdObj(field);
+        cmdStrP(NXT_P(".vvs1="));
+        cmdUint(frctSize);
+        cmdEnd();
+        res = writeCached();
         if(res != replyCmdOk) return res;//replyCmdFail;
     }
-    bufReset(sendBuf);
-    snprintf_P((char *)sendBuf,NXT_BUF_SIZE,PSTR("%S.val=%ld%c%c%c"),field,
-             value,NXT_MSG_END);
-    res = writeBuf();
+    cmdStart();
+    cmdObj(field);
+    cmdStrP(NXT_P(".val="));
+    cmdInt(value);
+    cmdEnd();
+    res = writeCached();
     if(res != replyCmdOk) return res;//replyCmdFail;    
     return replyCmdOk;
 }
@@ -0,0 +1,150 @@
+/* shadow.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the following class methods:
+ *
+ * public :
+ * - setShadow()
+ * - shadowClear()
+ * - getShadowStats()
+ *
+ * private:
+ * - writeCached()
+ * - cmdKey()
+ *
+ * The shadow cache remember the last value written to component attributes by
+ * setString(), setNumeric(), setFloat(), setObjAttr() (and so setBackColor(),
+ * setForeColor(), formatNumb()), and skip the write if the same value is written
+ * again. Entries are keyed by the address part of the command (page, object and
+ * attribute as sent, es. "p[0].b[3].val"), so always use the same addressing form
+ * for a given component. Names replaced by their ids (see resolver.cpp) are keyed
+ * as names, so the key does not change when a name is learned or forgotten.
+ * The cache is cleared on page change (setPageN(), setPageS(), sendme reply) and on
+ * devReset(). In frame and pipeline mode a write is cached when it's queued, before
+ * its reply: the cache is cleared when one of them fails (see pipeAck(), frameSend()).
+ * Values changed by the display itself (es. a slider moved by the user) are not seen
+ * by the cache, don't use it for such components, or call shadowClear().
+ *
+*/
+
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+
+/*
+ * nxtHash() - FNV-1a hash of "len" bytes, used by the shadow cache and the name resolver;
+ * pass the hash of the bytes before as "h" to go on with it
+ */
+uint32_t nxtHash(const uint8_t* buf, uint16_t len, uint32_t h){
+    for(uint16_t i = 0; i < len; i++){
+        h ^= buf[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+
+/*
+ * setShadow() - enable the shadow cache, using the "table" array of "size" entries
+ * provided by user; size is the number of components whose value is remembered.
+ * Pass NULL to disable the cache.
+ * es.
+ * nxtShadow_t shadow[16];
+ * lcd.setShadow(shadow,16);
+ */
+uint8_t NxtLcd::setShadow(nxtShadow_t* table, uint8_t size){
+    if(table != NULL && size == 0) return invalidData;
+    shadowTbl = table;
+    shadowSize = (table != NULL) ? size : 0;
+    shadowHits = 0;
+    shadowMisses = 0;
+    shadowClear();
+    return replyCmdOk;
+}
+
+
+/*
+ * shadowClear() - forget all cached values, next writes will be sent to display
+ */
+void NxtLcd::shadowClear(void){
+    if(shadowTbl == NULL) return;
+    memset(shadowTbl,0,shadowSize * sizeof(nxtShadow_t));
+    shadowNext = 0;
+}
+
+
+/*
+ * getShadowStats() - return the number of writes skipped ("hits") and sent ("misses")
+ * since the cache was enabled
+ */
+uint8_t NxtLcd::getShadowStats(uint32_t* hits, uint32_t* misses){
+    if(shadowTbl == NULL) return notSupported;
+    (*hits) = shadowHits;
+    (*misses) = shadowMisses;
+    return replyCmdOk;
+}
+
+
+/*
+ * writeCached() - as writeBuf(), but for the "<address>=<value>" commands: the write
+ * is skipped if the last value written to the same address was the same. Sent commands
+ * are added to the journal too (see journal.cpp).
+ */
+uint8_t NxtLcd::writeCached(void){
+    if((shadowTbl == NULL && jrnPool == NULL) || cmdOvfl > 0) return writeBuf();
+    uint16_t eq = 0;
+    while(eq < sendLen && sendBuf[eq] != '=') eq++;
+    if(eq == sendLen) return writeBuf();
+    uint32_t key = cmdKey(eq);
+    if(key == 0) key = 1; // 0 mark an empty entry
+    if(shadowTbl == NULL){
+        uint8_t res = writeBuf();
+        if(res == replyCmdOk) jrnAdd(key);
+        return res;
+    }
+    uint32_t value = nxtHash(&sendBuf[eq],sendLen - eq);
+    nxtShadow_t* entry = NULL;
+    for(uint8_t i = 0; i < shadowSize; i++){
+        if(shadowTbl[i].key == key){
+            entry = &shadowTbl[i];
+            break;
+        }
+    }
+    if(entry != NULL && entry->value == value){
+        shadowHits++;
+        return replyCmdOk;
+    }
+    shadowMisses++;
+    uint8_t res = writeBuf();
+    if(res == replyCmdOk){
+        if(jrnPool != NULL) jrnAdd(key);
+        if(entry == NULL){
+            entry = &shadowTbl[shadowNext];
+            shadowNext = (shadowNext + 1) % shadowSize;
+        }
+        entry->key = key;
+        entry->value = value;
+    }
+    else if(entry != NULL) entry->key = 0;
+    return res;
+}
+
+
+/*
+ * cmdKey() - hash of the first "end" bytes of sendBuf, as they were before nameUse()
+ * replaced a name with its ids
+ */
+uint32_t NxtLcd::cmdKey(uint16_t end){
+    if(cmdKeyEnd > 0 && cmdKeyEnd <= end) return nxtHash(&sendBuf[cmdKeyEnd],end - cmdKeyEnd,cmdKeyHash);
+    return nxtHash(sendBuf,end);
+}
@@ -0,0 +1,129 @@
+/* snapshot.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the following class methods:
+ *
+ * public :
+ * - setSnapshot()
+ * - saveSnapshot()
+ *
+ * private:
+ * - snapLoad()
+ *
+ * When the MCU restart but the display does not (brown-out, watchdog, new sketch), the
+ * display properties are still the ones known before, so reading them again is a waste
+ * of time. With a snapshot set, init() (without reset) load the snapshot through the user
+ * callback and ask the display only the check property (sys2 by default): if it hold the
+ * tag written by saveSnapshot() the display was not restarted meanwhile, and the local
+ * copy of the properties is taken from the snapshot (see getWarmBoot()). The current
+ * page and the sleep state are read again: the display change them by itself (touch,
+ * page/sleep in the HMI), so the saved ones may be stale. Otherwise, or with reset, the
+ * properties are read as usual and a new snapshot is saved.
+ * Properties changed by the sketch are not saved at once (EEPROM/flash wear out), call
+ * saveSnapshot() when convenient: it does nothing if nothing changed. Until then a warm
+ * boot restore the old values. The check property must not be used by the HMI.
+ *
+ * uint8_t snapIo(uint8_t save, nxtSnap_t* snap, void* ctx){
+ *   if(save) EEPROM.put(0,*snap);
+ *   else EEPROM.get(0,*snap);
+ *   return 1;
+ * }
+ * ...
+ * lcd.setSnapshot(snapIo);
+ * lcd.init(115200,1,0);
+ *
+*/
+
+
+#include <Arduino.h>
+#include <stddef.h>
+#include "nxt_lcd.h"
+
+
+/*
+ * nxtSnapSum() - checksum of the snapshot content
+ */
+static uint32_t nxtSnapSum(nxtSnap_t* snap){
+    return nxtHash((const uint8_t *)&snap->valid,offsetof(nxtSnap_t,prop) - offsetof(nxtSnap_t,valid)
+                   + snap->propCnt * sizeof(uint16_t));
+}
+
+
+/*
+ * setSnapshot() - use the "io" callback to save and load the properties snapshot,
+ * "ctx" is passed to it. "checkProp" is the property used to validate the snapshot,
+ * one of nxt_sys0, nxt_sys1 or nxt_sys2. Pass NULL to disable it.
+ */
+uint8_t NxtLcd::setSnapshot(nxtSnapIo_t io, void* ctx, uint8_t checkProp){
+    if(checkProp < nxt_sys0 || checkProp > nxt_sys2) return invalidData;
+    snapIo = io;
+    snapCtx = ctx;
+    snapCheck = checkProp;
+    snapDirty = 1;
+    return replyCmdOk;
+}
+
+
+/*
+ * saveSnapshot() - write a new tag in the check property and save the local copy of
+ * the properties. Nothing is done if no property changed since the last save, unless
+ * "force" is set.
+ */
+uint8_t NxtLcd::saveSnapshot(uint8_t force){
+    if(initialized == 0) return notInit;
+    if(snapIo == NULL) return notSupported;
+    if(snapDirty == 0 && force == 0) return replyCmdOk;
+    nxtSnap_t snap;
+    memset(&snap,0,sizeof(snap));
+    snap.propCnt = getPropCnt();
+    uint32_t h = nxtHash((const uint8_t *)sysProp,snap.propCnt * sizeof(uint16_t)) ^ millis();
+    snap.tag = (uint16_t)(h ^ (h >> 16));
+    if(snap.tag == 0) snap.tag = 1;    // 0 is the value after a display restart
+    uint8_t res = setProperty(snapCheck,snap.tag);
+    if(res != replyCmdOk) return res;
+    snap.valid = propValid;
+    snap.dispType = dispType;
+    memcpy(snap.prop,sysProp,snap.propCnt * sizeof(uint16_t));
+    snap.sum = nxtSnapSum(&snap);
+    if(snapIo(1,&snap,snapCtx) == 0) return replyCmdFail;
+    snapDirty = 0;
+    return replyCmdOk;
+}
+
+
+/*
+ * snapLoad() - load the snapshot and, if the display still hold its tag, use it as
+ * local copy of the properties, current page and sleep state excepted: those are asked
+ * again. Called by init().
+ */
+uint8_t NxtLcd::snapLoad(void){
+    nxtSnap_t snap;
+    if(snapIo(0,&snap,snapCtx) == 0) return replyCmdFail;
+    if(snap.propCnt != getPropCnt() || snap.dispType != dispType) return invalidData;
+    if(snap.tag == 0 || snap.sum != nxtSnapSum(&snap)) return invalidData;
+    uint16_t tag;
+    uint8_t res = getProperty(snapCheck,&tag);
+    if(res != replyCmdOk) return res;
+    if(tag != snap.tag) return invalidData;
+    memcpy(sysProp,snap.prop,snap.propCnt * sizeof(uint16_t));
+    propValid = snap.valid | NXT_PROP_BIT(snapCheck);
+    propValid &= ~(NXT_PROP_BIT(nxt_dp) | NXT_PROP_BIT(nxt_sleep));    //changed by the display itself
+    uint16_t v;
+    res = getProperty(nxt_dp,&v);
+    if(res == replyCmdOk) res = getProperty(nxt_sleep,&v);
+    if(res != replyCmdOk){
+        propValid = 0;
+        return res;
+    }
+    snapDirty = 0;
+    return replyCmdOk;
+}
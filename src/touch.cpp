@@ -0,0 +1,198 @@
+/* touch.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the following class methods:
+ *
+ * public :
+ * - setXYMode()
+ * - drawStroke()
+ *
+ * private:
+ * - xyCoalesce()
+ * - strokeAdd()
+ * - strokeStart()
+ *
+ * With sendxy=1 the display send a 0x67 (0x68 in sleep) telegram for the press, one for
+ * each sample while the finger is dragged, and one for the release. Handling all of them
+ * one by one the sketch easily fall behind, so moves can be coalesced:
+ * - nxt_xyLatest : press and release are queued as usual; the samples between them are
+ *   reported as events with event=NXT_XY_MOVE, and a new sample replace the coordinates
+ *   of the move event still in queue, instead of adding another one. The sketch get at
+ *   most one move for each read of the queue, always with the latest position.
+ * - nxt_xyStroke : as above, and all the points, press and release included, are also
+ *   stored in the stroke buffer provided by user (getStroke(), getStrokeLen()). On a
+ *   press the points already drawn are dropped; the ones not yet drawn are kept, with a
+ *   NXT_STROKE_BREAK point before the new stroke, so several strokes can wait for
+ *   drawStroke(). When it's full the points already drawn are dropped, but the last of
+ *   them so the stroke stay connected; if none has been drawn the last point is
+ *   replaced, so the stroke always end where the finger is. Points not drawn and lost
+ *   so (or on a press, if there is no room to keep them) are counted by getStrokeLost().
+ *   With setStrokeMinDist(), moves closer than that (in pixels, on both axes) to the
+ *   previous point are not stored.
+ *
+ * drawStroke() draw on the display the part of the stroke not yet drawn, so calling it
+ * from loop() is enough for finger painting or signature capture: all the new segments
+ * are sent with one write, using the frame buffer if one is set (see frame.cpp).
+ *
+ * nxtPoint_t stroke[64];
+ * uint8_t frame[256];
+ * lcd.setFrameBuf(frame,sizeof(frame));
+ * lcd.setProperty(nxt_sendxy,1);
+ * lcd.setXYMode(nxt_xyStroke,stroke,64);
+ * lcd.setStrokeMinDist(3);
+ * ...
+ * loop(){
+ *   lcd.poll();
+ *   lcd.drawStroke(BLUE);
+ * }
+ *
+*/
+
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+
+/*
+ * setXYMode() - set the XY touch coalescing mode, see xyMode_t. nxt_xyStroke need the
+ * "buf" array of "size" points.
+ */
+uint8_t NxtLcd::setXYMode(uint8_t mode, nxtPoint_t* buf, uint16_t size){
+    if(mode > nxt_xyStroke) return invalidData;
+    if(mode == nxt_xyStroke && (buf == NULL || size < 2)) return invalidData;
+    xyMode = mode;
+    touchDown = 0;
+    strokeBuf = (mode == nxt_xyStroke) ? buf : NULL;
+    strokeSize = (mode == nxt_xyStroke) ? size : 0;
+    strokeLen = 0;
+    return replyCmdOk;
+}
+
+
+/*
+ * xyCoalesce() - called by readEvent() for each XY touch event "ev", not yet queued.
+ * Return 1 if the event has been merged with the move event already in queue (so it
+ * must not be queued), 0 otherwise.
+ */
+uint8_t NxtLcd::xyCoalesce(nxtEvent_t* ev){
+    if(ev->event == 0){
+        touchDown = 0;
+        strokeAdd(ev);
+        return 0;
+    }
+    if(touchDown == 0){
+        touchDown = 1;
+        strokeStart();
+        strokeAdd(ev);
+        return 0;
+    }
+    ev->event = NXT_XY_MOVE;
+    strokeAdd(ev);
+    if(evCnt > 0){
+        nxtEvent_t* last = &evQueue[(evHead + evCnt - 1) % NXT_EV_QUEUE_SIZE];
+        if(last->evCode == ev->evCode && last->event == NXT_XY_MOVE){
+            last->page_X = ev->page_X;
+            last->compId_Y = ev->compId_Y;
+            xyMerged++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * strokeAdd() - add the point of "ev" to the stroke buffer
+ */
+void NxtLcd::strokeAdd(nxtEvent_t* ev){
+    if(strokeBuf == NULL) return;
+    if(strokeMinDist > 0 && ev->event == NXT_XY_MOVE && strokeLen > 0){
+        nxtPoint_t* prev = &strokeBuf[strokeLen - 1];
+        uint16_t dx = (ev->page_X > prev->x) ? ev->page_X - prev->x : prev->x - ev->page_X;
+        uint16_t dy = (ev->compId_Y > prev->y) ? ev->compId_Y - prev->y : prev->y - ev->compId_Y;
+        if(dx < strokeMinDist && dy < strokeMinDist) return;
+    }
+    if(strokeLen == strokeSize){
+        if(strokeDrawn > 0){
+            strokeLen -= strokeDrawn;
+            memmove(strokeBuf,&strokeBuf[strokeDrawn],strokeLen * sizeof(nxtPoint_t));
+            strokeDrawn = 0;
+        }
+        else{
+            strokeLen--;
+            strokeLost++;
+        }
+        strokeGen++;
+    }
+    strokeBuf[strokeLen].x = ev->page_X;
+    strokeBuf[strokeLen].y = ev->compId_Y;
+    strokeLen++;
+}
+
+
+/*
+ * strokeStart() - make room for a new stroke: the points already drawn are dropped,
+ * the ones not yet drawn are kept followed by a NXT_STROKE_BREAK point, if there is
+ * room for them and for the new stroke (at least 2 points)
+ */
+void NxtLcd::strokeStart(void){
+    if(strokeBuf == NULL) return;
+    uint16_t keep = (strokeDrawn + 1 < strokeLen) ? strokeLen - strokeDrawn : 0;
+    if(keep > 0 && keep + 3 > strokeSize){
+        strokeLost += keep - 1;
+        keep = 0;
+    }
+    if(keep > 0){
+        memmove(strokeBuf,&strokeBuf[strokeDrawn],keep * sizeof(nxtPoint_t));
+        strokeBuf[keep].x = NXT_STROKE_BREAK;
+        strokeBuf[keep].y = 0;
+        keep++;
+    }
+    strokeLen = keep;
+    strokeDrawn = 0;
+    strokeGen++;
+}
+
+
+/*
+ * drawStroke() - draw with "color" the segments of the strokes not yet drawn. If a frame
+ * buffer is set (and no frame is open) they are sent all together as one frame.
+ * Sending may poll the port, and the points received meanwhile can restart or shift
+ * the buffer (strokeGen changes): then drawing stops, the rest is left to next call.
+ */
+uint8_t NxtLcd::drawStroke(uint16_t color){
+    if(initialized == 0) return notInit;
+    if(strokeBuf == NULL) return notSupported;
+    if(strokeDrawn + 1 >= strokeLen) return replyCmdOk;
+    uint8_t frame = (frameBuf != NULL && frameEn == 0);
+    if(frame) beginFrame();
+    uint8_t res = replyCmdOk;
+    uint8_t gen = strokeGen;
+    uint16_t end = strokeLen;
+    for(uint16_t i = strokeDrawn; i + 1 < end; i++){
+        nxtPoint_t from = strokeBuf[i];
+        nxtPoint_t to = strokeBuf[i + 1];
+        strokeDrawn = i + 1;                // sent, if the port is polled meanwhile
+        if(from.x == NXT_STROKE_BREAK || to.x == NXT_STROKE_BREAK) continue;
+        res = drawLine(from.x,from.y,to.x,to.y,color);
+        if(gen != strokeGen) break;
+        if(res != replyCmdOk){
+            strokeDrawn = i;
+            break;
+        }
+    }
+    if(frame){
+        uint8_t ret = commitFrame();
+        if(res == replyCmdOk) res = ret;
+    }
+    return res;
+}
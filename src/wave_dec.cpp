@@ -0,0 +1,239 @@
+/* wave_dec.cpp
+ *
+ * Arduino platform library for Itead Nextion displays
+ * Instruction set : https://nextion.tech/instruction-set/
+ *
+ * Library implements almost of the basic and ehnached display function
+ * but none (yet) of the professional ones.
+ *
+ * Please read nxt_lcd.h for some more info
+ *
+ * (c) Guarguaglini Alessandro - ilguargua@gmail.com
+ *
+ * This file include the following class methods:
+ *
+ * NxtWaveDec :
+ * - NxtWaveDec()
+ * - setScale()
+ * - setDecimation()
+ * - add()
+ * - flush()
+ * - clear()
+ * - emit()
+ *
+ * A wave object is only a few hundred pixels wide, while an ADC can give thousands of
+ * samples per second. NxtWaveDec take the raw samples (int16_t or float), map the
+ * range lo/hi given with setScale() on the widget height (taking into account its
+ * 'dis' scaling, so use the same value set in the HMI), and for each group of
+ * "samples" (setDecimation()) keep:
+ * - NXT_DEC_AVG    : one point, the average
+ * - NXT_DEC_MINMAX : two points, the min and the max (in alternate order, so the line
+ *   drawn by the wave follow the envelope of the signal and short spikes are not lost)
+ * The points are collected in the buffer provided by user and sent with addWaveBytes()
+ * (transparent data) when it's full, or when flush() is called; call it from loop()
+ * as often as the wave has to be updated.
+ * The per sample loops have no branches and no division, so they are vectorized by
+ * the compiler where the target allows it; the samples processed so far are counted
+ * by getSamples(), to measure the throughput.
+ *
+ * uint8_t points[64];
+ * NxtWaveDec adc(lcd,1,0,points,sizeof(points));   // wave id 1, channel 0
+ * adc.setScale(0,4095,200);                        // 12 bit ADC, wave 200 pixel high
+ * adc.setDecimation(50,NXT_DEC_MINMAX);
+ * ...
+ * adc.add(block,blockLen);
+ * adc.flush();
+ *
+*/
+
+
+#include <Arduino.h>
+#include "nxt_lcd.h"
+
+
+/*
+ * nxtDecI16() - scale "n" samples to 1/256 of point and update min, max and sum
+ */
+static void nxtDecI16(const int16_t* s, uint16_t n, int32_t lo, int32_t hi, int32_t k,
+                      uint32_t* mn, uint32_t* mx, uint32_t* sum){
+    uint32_t a = *mn;
+    uint32_t b = *mx;
+    uint32_t t = *sum;
+    for(uint16_t i = 0; i < n; i++){
+        int32_t v = s[i];
+        v = (v < lo) ? lo : v;
+        v = (v > hi) ? hi : v;
+        uint32_t p = (uint32_t)((v - lo) * k) >> 8;
+        a = (p < a) ? p : a;
+        b = (p > b) ? p : b;
+        t += p;
+    }
+    *mn = a;
+    *mx = b;
+    *sum = t;
+}
+
+
+/*
+ * nxtDecF() - as nxtDecI16(), for float samples
+ */
+static void nxtDecF(const float* s, uint16_t n, float lo, float hi, float k,
+                    uint32_t* mn, uint32_t* mx, uint32_t* sum){
+    uint32_t a = *mn;
+    uint32_t b = *mx;
+    uint32_t t = *sum;
+    for(uint16_t i = 0; i < n; i++){
+        float v = s[i];
+        v = (v > lo) ? v : lo;     // NaN become lo
+        v = (v < hi) ? v : hi;
+        int32_t q = (int32_t)((v - lo) * k);
+        uint32_t p = q;
+        a = (p < a) ? p : a;
+        b = (p > b) ? p : b;
+        t += p;
+    }
+    *mn = a;
+    *mx = b;
+    *sum = t;
+}
+
+
+/*
+ * NxtWaveDec() - bind the decimator to the channel "channel" of wave object "id"; the
+ * reduced points are collected in "buf", of "size" bytes (at least 1, 2 for
+ * NXT_DEC_MINMAX). With no buffer add() return invalidData.
+ */
+NxtWaveDec::NxtWaveDec(NxtLcd& l, uint8_t id, uint8_t channel, uint8_t* buf, uint16_t size){
+    lcd = &l;
+    waveId = id;
+    ch = channel;
+    outBuf = buf;
+    outSize = (buf != NULL) ? size : 0;
+    setScale(0,255,256);
+}
+
+
+/*
+ * setScale() - samples from "lo" to "hi" are drawn from the bottom to the top of a wave
+ * "height" pixels high, whose 'dis' attribute is "dis" (10-1000, 100 means no scaling).
+ * Points are bytes, so with a large height (or a small dis) the top is cut at 255.
+ * Samples out of range are clipped.
+ */
+uint8_t NxtWaveDec::setScale(float lo, float hi, uint16_t height, uint16_t dis){
+    if(hi <= lo || height < 2 || dis < 10 || dis > 1000) return invalidData;
+    uint32_t top = (uint32_t)(height - 1) * 100 / dis;
+    if(top > 255) top = 255;
+    fLo = lo;
+    fHi = hi;
+    fK = (float)top * 256 / (hi - lo);
+    iLo = (lo < -32768) ? -32768 : (int16_t)lo;
+    iHi = (hi > 32767) ? 32767 : (int16_t)hi;
+    if(iHi <= iLo) iHi = iLo + 1;
+    iK = (int32_t)(top << 16) / (iHi - iLo);   // (iHi - iLo) * iK stay under 2^24
+    return replyCmdOk;
+}
+
+
+/*
+ * setDecimation() - reduce each group of "samples" samples as "decMode" (NXT_DEC_AVG or
+ * NXT_DEC_MINMAX). A partial group is dropped.
+ */
+uint8_t NxtWaveDec::setDecimation(uint16_t samples, uint8_t decMode){
+    if(samples == 0 || decMode > NXT_DEC_MINMAX) return invalidData;
+    if(decMode == NXT_DEC_MINMAX && outSize < 2) return invalidData;
+    ratio = samples;
+    mode = decMode;
+    winCnt = 0;
+    winMin = 0xFFFFFFFFUL;
+    winMax = 0;
+    winSum = 0;
+    return replyCmdOk;
+}
+
+
+/*
+ * add() - process "n" samples. Return the result of the flush when the buffer got full,
+ * if it failed the points are lost, not sent again.
+ */
+uint8_t NxtWaveDec::add(const int16_t* s, uint16_t n){
+    if(outSize == 0) return invalidData;
+    uint8_t res = replyCmdOk;
+    samples += n;
+    while(n > 0){
+        uint16_t m = ratio - winCnt;
+        if(m > n) m = n;
+        nxtDecI16(s,m,iLo,iHi,iK,&winMin,&winMax,&winSum);
+        winCnt += m;
+        s += m;
+        n -= m;
+        if(winCnt == ratio){
+            uint8_t ret = emit();
+            if(res == replyCmdOk) res = ret;
+        }
+    }
+    return res;
+}
+
+uint8_t NxtWaveDec::add(const float* s, uint16_t n){
+    if(outSize == 0) return invalidData;
+    uint8_t res = replyCmdOk;
+    samples += n;
+    while(n > 0){
+        uint16_t m = ratio - winCnt;
+        if(m > n) m = n;
+        nxtDecF(s,m,fLo,fHi,fK,&winMin,&winMax,&winSum);
+        winCnt += m;
+        s += m;
+        n -= m;
+        if(winCnt == ratio){
+            uint8_t ret = emit();
+            if(res == replyCmdOk) res = ret;
+        }
+    }
+    return res;
+}
+
+
+/*
+ * emit() - store the point(s) of the group just completed, flushing the buffer first
+ * if there is no room
+ */
+uint8_t NxtWaveDec::emit(void){
+    uint8_t res = replyCmdOk;
+    uint8_t need = (mode == NXT_DEC_MINMAX) ? 2 : 1;
+    if(outLen + need > outSize) res = flush();
+    if(mode == NXT_DEC_MINMAX){
+        uint8_t lo = (winMin + 128) >> 8;
+        uint8_t hi = (winMax + 128) >> 8;
+        outBuf[outLen++] = flip ? hi : lo;
+        outBuf[outLen++] = flip ? lo : hi;
+        flip ^= 1;
+    }
+    else outBuf[outLen++] = (winSum / ratio + 128) >> 8;
+    winCnt = 0;
+    winMin = 0xFFFFFFFFUL;
+    winMax = 0;
+    winSum = 0;
+    return res;
+}
+
+
+/*
+ * flush() - send the points collected so far
+ */
+uint8_t NxtWaveDec::flush(void){
+    if(outLen == 0) return replyCmdOk;
+    uint16_t len = outLen;
+    outLen = 0;
+    return lcd->addWaveBytes(waveId,ch,outBuf,len);
+}
+
+
+/*
+ * clear() - drop the points not yet sent and the current group, and clear the channel
+ */
+uint8_t NxtWaveDec::clear(void){
+    outLen = 0;
+    setDecimation(ratio,mode);
+    return lcd->clearWaveCh(waveId,ch);
+}